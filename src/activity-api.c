@@ -100,6 +100,8 @@ flickcurl_activity_userComments(flickcurl* fc, int per_page, int page)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     activities = NULL;
 
@@ -171,6 +173,8 @@ flickcurl_activity_userPhotos(flickcurl* fc, const char* timeframe,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     activities = NULL;
 
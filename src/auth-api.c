@@ -90,6 +90,7 @@ flickcurl_auth_checkToken(flickcurl* fc, const char* token)
   }
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return perms;
 }
@@ -133,6 +134,7 @@ flickcurl_auth_getFrob(flickcurl* fc)
   }
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return frob;
 }
@@ -181,6 +183,7 @@ flickcurl_auth_getFullToken(flickcurl* fc, const char* frob)
   }
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return auth_token;
 }
@@ -229,6 +232,7 @@ flickcurl_auth_getToken(flickcurl* fc, const char* frob)
   }
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return auth_token;
 }
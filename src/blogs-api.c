@@ -82,6 +82,7 @@ flickcurl_blogs_getList(flickcurl* fc)
                               (const xmlChar*)"/rsp/blogs/blog", NULL);
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     blogs = NULL;
 
@@ -132,6 +133,8 @@ flickcurl_blogs_getServices(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     services = NULL;
 
@@ -201,5 +204,7 @@ flickcurl_blogs_postPhoto(flickcurl* fc, const char* blog_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   return fc->failed;
 }
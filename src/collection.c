@@ -167,6 +167,27 @@ static struct {
 };
 
 
+/*
+ * flickcurl_collection_register_xpaths:
+ *
+ * INTERNAL - compile the collection field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_collection_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; collection_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(collection_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
 flickcurl_collection**
 flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
                             const xmlChar* xpathExpr, int* collection_count_p)
@@ -176,6 +197,7 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   int collection_count;
   xmlXPathObjectPtr xpathObj = NULL;
   xmlNodeSetPtr nodes;
+  xmlXPathContextPtr xpathNodeCtx = NULL;
   xmlChar full_xpath[512];
   size_t xpathExpr_len;
   int i;
@@ -183,7 +205,7 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   xpathExpr_len = strlen((const char*)xpathExpr);
   strncpy((char*)full_xpath, (const char*)xpathExpr, xpathExpr_len+1);
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -196,11 +218,18 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   nodes_count = xmlXPathNodeSetGetLength(nodes);
   collections = (flickcurl_collection**)calloc(sizeof(flickcurl_collection*), nodes_count+1);
 
+  /* one XPath context is moved to each node in turn */
+  xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
+  if(!xpathNodeCtx) {
+    flickcurl_error(fc, "Failed to create XPath context for document");
+    fc->failed = 1;
+    goto tidy;
+  }
+
   for(i = 0, collection_count = 0; i < nodes_count; i++) {
     xmlNodePtr node = nodes->nodeTab[i];
     flickcurl_collection* collection;
     int expri;
-    xmlXPathContextPtr xpathNodeCtx = NULL;
     
     if(node->type != XML_ELEMENT_NODE) {
       flickcurl_error(fc, "Got unexpected node type %d", node->type);
@@ -210,8 +239,6 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     
     collection = (flickcurl_collection*)calloc(sizeof(flickcurl_collection), 1);
 
-    /* set up a new XPath context relative to the current node */
-    xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
     xpathNodeCtx->node = node;
 
     for(expri = 0; collection_fields_table[expri].xpath; expri++) {
@@ -221,6 +248,7 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
       char *string_value;
       int int_value= -1;
       time_t unix_time;
+      char isotime[FLICKCURL_ISOTIME_SIZE];
 
       if(datatype == VALUE_TYPE_ICON_PHOTOS) {
         collection->photos = flickcurl_build_photos(fc, xpathNodeCtx,
@@ -237,16 +265,14 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
         case VALUE_TYPE_UNIXTIME:
         case VALUE_TYPE_DATETIME:
           
-          if(datatype == VALUE_TYPE_UNIXTIME)
-            unix_time = atoi(string_value);
-          else
-            unix_time = curl_getdate((const char*)string_value, NULL);
+          unix_time = flickcurl_date_to_isotime(fc, string_value,
+                                                (datatype == VALUE_TYPE_UNIXTIME),
+                                                isotime);
           
           if(unix_time >= 0) {
 #if FLICKCURL_DEBUG > 1
-            char* new_value = flickcurl_unixtime_to_isotime(unix_time);
             fprintf(stderr, "  date from: '%s' unix time %ld to '%s'\n",
-                    value, (long)unix_time, new_value);
+                    string_value, (long)unix_time, isotime);
 #endif
             int_value = (int)unix_time;
           } else {
@@ -341,6 +367,8 @@ flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     *collection_count_p = collection_count;
 
  tidy:
+  if(xpathNodeCtx)
+    xmlXPathFreeContext(xpathNodeCtx);
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
   
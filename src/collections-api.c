@@ -89,6 +89,8 @@ flickcurl_collections_getInfo(flickcurl* fc, const char* collection_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     collection = NULL;
 
@@ -151,6 +153,8 @@ flickcurl_collections_getTree(flickcurl* fc, const char* collection_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     collection = NULL;
 
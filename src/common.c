@@ -62,6 +62,13 @@
 #include <flickcurl_internal.h>
 
 #include <libxml/xmlsave.h>
+#include <libxml/SAX2.h>
+
+
+/* Most names kept in the reused XML parser dictionary; Flickr responses
+ * only use a few hundred
+ */
+#define FLICKCURL_XML_DICT_MAX_SIZE 65536
 
 const char* const flickcurl_short_copyright_string = "Copyright 2007-2010 David Beckett.";
 
@@ -108,7 +115,51 @@ flickcurl_error(flickcurl* fc, const char *message, ...)
   va_end(arguments);
 }
 
-  
+
+/*
+ * SAX2 element handlers building the DOM as usual that also stop the
+ * parser for flickcurl_set_partial_response()
+ */
+static void
+flickcurl_sax_start_element(void* ctx, const xmlChar* localname,
+                            const xmlChar* prefix, const xmlChar* URI,
+                            int nb_namespaces, const xmlChar** namespaces,
+                            int nb_attributes, int nb_defaulted,
+                            const xmlChar** attributes)
+{
+  xmlParserCtxtPtr xc = (xmlParserCtxtPtr)ctx;
+  flickcurl* fc = (flickcurl*)xc->_private;
+
+  xmlSAX2StartElementNs(ctx, localname, prefix, URI,
+                        nb_namespaces, namespaces,
+                        nb_attributes, nb_defaulted, attributes);
+
+  if(fc->partial_element && !fc->partial_count && !fc->partial_done &&
+     !strcmp((const char*)localname, fc->partial_element)) {
+    fc->partial_done = 1;
+    xmlStopParser(xc);
+  }
+}
+
+
+static void
+flickcurl_sax_end_element(void* ctx, const xmlChar* localname,
+                          const xmlChar* prefix, const xmlChar* URI)
+{
+  xmlParserCtxtPtr xc = (xmlParserCtxtPtr)ctx;
+  flickcurl* fc = (flickcurl*)xc->_private;
+
+  xmlSAX2EndElementNs(ctx, localname, prefix, URI);
+
+  if(fc->partial_element && fc->partial_count && !fc->partial_done &&
+     !strcmp((const char*)localname, fc->partial_element) &&
+     ++fc->partial_seen == fc->partial_count) {
+    fc->partial_done = 1;
+    xmlStopParser(xc);
+  }
+}
+
+
 static size_t
 flickcurl_write_callback(void *ptr, size_t size, size_t nmemb, 
                          void *userdata) 
@@ -148,7 +199,19 @@ flickcurl_write_callback(void *ptr, size_t size, size_t nmemb,
   }
   
   if(fc->xml_parse_content) {
-    if(!fc->xc) {
+    struct timeval parse_start;
+
+    gettimeofday(&parse_start, NULL);
+    if(fc->xc && fc->xc_reset) {
+      /* start the new document reusing the parser and dictionary */
+      fc->xc_reset = 0;
+      rc = xmlCtxtResetPush(fc->xc, (const char*)ptr, len,
+                            (const char*)fc->uri, NULL);
+      if(!rc) {
+        fc->xc->replaceEntities = 1;
+        fc->xc->loadsubset = 1;
+      }
+    } else if(!fc->xc) {
       xmlParserCtxtPtr xc;
 
       xc = xmlCreatePushParserCtxt(NULL, NULL,
@@ -159,16 +222,25 @@ flickcurl_write_callback(void *ptr, size_t size, size_t nmemb,
       else {
         xc->replaceEntities = 1;
         xc->loadsubset = 1;
+        xc->_private = fc;
+        xc->sax->startElementNs = flickcurl_sax_start_element;
+        xc->sax->endElementNs = flickcurl_sax_end_element;
       }
       fc->xc = xc;
     } else
       rc = xmlParseChunk(fc->xc, (const char*)ptr, len, 0);
 
+    /* the first chunk is only buffered when the parser is (re)started */
+    if(!rc && fc->partial_element && !fc->partial_done)
+      rc = xmlParseChunk(fc->xc, NULL, 0, 0);
+
+    fc->timing.parse_usec += flickcurl_timing_elapsed(&parse_start);
+
 #if FLICKCURL_DEBUG > 2
     fprintf(stderr, "Got >>%s<< (%d bytes)\n", (const char*)ptr, len);
 #endif
 
-    if(rc)
+    if(rc && !fc->partial_done)
       flickcurl_error(fc, "XML Parsing failed");
   }
 
@@ -176,6 +248,11 @@ flickcurl_write_callback(void *ptr, size_t size, size_t nmemb,
   if(fc->fh)
     fwrite(ptr, size, nmemb, fc->fh);
 #endif
+
+  /* abandon the rest of a partial response */
+  if(fc->partial_done)
+    return 0;
+
   return len;
 }
 
@@ -239,6 +316,9 @@ flickcurl_new_with_handle(void* curl_handle)
 
   curl_easy_setopt(fc->curl_handle, CURLOPT_ERRORBUFFER, fc->error_buffer);
 
+  /* DEFAULT accept every content encoding curl can decode */
+  fc->accept_encoding = strdup("");
+
   return fc;
 }
 
@@ -266,6 +346,8 @@ flickcurl_new(void)
 void
 flickcurl_free(flickcurl *fc)
 {
+  flickcurl_timing_flush(fc);
+
   if(fc->xc) {
     if(fc->xc->myDoc) {
       xmlFreeDoc(fc->xc->myDoc);
@@ -339,9 +421,27 @@ flickcurl_free(flickcurl *fc)
   if(fc->user_agent)
     free(fc->user_agent);
 
+  if(fc->accept_encoding)
+    free(fc->accept_encoding);
+
   if(fc->uri)
     free(fc->uri);
 
+  if(fc->date_cache)
+    free(fc->date_cache);
+
+  if(fc->partial_element)
+    free(fc->partial_element);
+
+  /* objects holding interned strings keep the table alive */
+  flickcurl_intern_table_release(fc->intern_table);
+
+  if(fc->photo_fields_extras)
+    free(fc->photo_fields_extras);
+
+  flickcurl_free_method_latencies(fc);
+  flickcurl_reset_metrics(fc);
+
   free(fc);
 }
 
@@ -359,6 +459,8 @@ flickcurl_init(void)
   curl_global_init(CURL_GLOBAL_ALL);
   xmlInitParser();
   flickcurl_serializer_init();
+  if(flickcurl_xpath_init())
+    return 1;
   return 0;
 }
 
@@ -372,6 +474,7 @@ void
 flickcurl_finish(void)
 {
   flickcurl_serializer_terminate();
+  flickcurl_xpath_terminate();
   xmlCleanupParser();
   curl_global_cleanup();
 }
@@ -482,6 +585,80 @@ flickcurl_set_http_accept(flickcurl* fc, const char *value)
 }
 
 
+/**
+ * flickcurl_set_accept_encoding:
+ * @fc: flickcurl object
+ * @encodings: comma-separated content encodings such as "gzip, deflate", "" for all supported or NULL for none
+ *
+ * Set the compressed content encodings requested for responses
+ *
+ * By default every encoding supported by libcurl is requested.
+ * Compressed responses are decoded as they arrive and streamed into
+ * the XML parser; see flickcurl_get_transfer_stats() for the effect.
+ */
+void
+flickcurl_set_accept_encoding(flickcurl* fc, const char *encodings)
+{
+  char *encodings_copy = NULL;
+
+  if(encodings) {
+    encodings_copy = strdup(encodings);
+    if(!encodings_copy)
+      return;
+  }
+
+  if(fc->accept_encoding)
+    free(fc->accept_encoding);
+  fc->accept_encoding = encodings_copy;
+}
+
+
+/**
+ * flickcurl_get_transfer_stats:
+ * @fc: flickcurl object
+ * @wire_bytes_p: pointer to store response body bytes received (or NULL)
+ * @decoded_bytes_p: pointer to store response body bytes after decoding (or NULL)
+ *
+ * Get the response body sizes of all requests made so far
+ *
+ * The ratio of the two shows the saving from compressed transfers.
+ */
+void
+flickcurl_get_transfer_stats(flickcurl* fc, double* wire_bytes_p,
+                             double* decoded_bytes_p)
+{
+  if(wire_bytes_p)
+    *wire_bytes_p = fc->wire_bytes;
+  if(decoded_bytes_p)
+    *decoded_bytes_p = fc->decoded_bytes;
+}
+
+
+/*
+ * flickcurl_get_handle_wire_bytes:
+ * @handle: curl handle after a transfer
+ *
+ * INTERNAL - get the response body bytes received before decoding
+ *
+ * Return value: bytes
+ */
+double
+flickcurl_get_handle_wire_bytes(CURL* handle)
+{
+#if LIBCURL_VERSION_NUM >= 0x073700
+  curl_off_t size = 0;
+
+  curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &size);
+  return (double)size;
+#else
+  double size = 0.0;
+
+  curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &size);
+  return size;
+#endif
+}
+
+
 /**
  * flickcurl_set_service_uri:
  * @fc: flickcurl object
@@ -671,6 +848,52 @@ flickcurl_set_sign(flickcurl *fc)
 }
 
 
+/**
+ * flickcurl_set_partial_response:
+ * @fc: flickcurl object
+ * @element: local name of the response element to stop at (or NULL)
+ * @count: number of @element elements to read or 0 to stop as soon as the first starts
+ *
+ * Stop reading the response of the next request once it has been seen
+ *
+ * For callers that only need the start of a large response, such as
+ * the first photo of a search to check it has results or the totals
+ * on a list before any photos.  Parsing stops at the end of the
+ * @count th @element or at the start tag of the first one when @count
+ * is 0, when its attributes are known, and the rest of the transfer
+ * is abandoned.  The document returned holds only what was read up to
+ * that point.  Stopping closes the HTTP connection so it is only worth
+ * doing when much of the response would be skipped.
+ *
+ * A response without enough matching elements is read in full.  Like
+ * flickcurl_set_sign(), this applies to the next request only.
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_set_partial_response(flickcurl *fc, const char* element, int count)
+{
+  if(fc->partial_element) {
+    free(fc->partial_element);
+    fc->partial_element = NULL;
+  }
+  fc->partial_count = 0;
+
+  if(!element)
+    return 0;
+
+  if(count < 0)
+    return 1;
+
+  fc->partial_element = strdup(element);
+  if(!fc->partial_element)
+    return 1;
+  fc->partial_count = count;
+
+  return 0;
+}
+
+
 /**
  * flickcurl_set_request_delay:
  * @fc: flickcurl object
@@ -686,17 +909,28 @@ flickcurl_set_request_delay(flickcurl *fc, long delay_msec)
 }
 
 
-static int
-compare_args(const void *a, const void *b) 
-{
-  return strcmp(*(char**)a, *(char**)b);
-}
-
-
+/*
+ * Insertion sort: API calls made by utils/codegen add their parameters
+ * in name order so only the method, api_key and auth_token appended by
+ * flickcurl_prepare_common() have to be moved into place.
+ */
 static void
 flickcurl_sort_args(flickcurl *fc, const char *parameters[][2], int count)
 {
-  qsort((void*)parameters, count, sizeof(char*[2]), compare_args);
+  int i;
+
+  for(i = 1; i < count; i++) {
+    const char* name = parameters[i][0];
+    const char* value = parameters[i][1];
+    int j;
+
+    for(j = i; j > 0 && strcmp(parameters[j - 1][0], name) > 0; j--) {
+      parameters[j][0] = parameters[j - 1][0];
+      parameters[j][1] = parameters[j - 1][1];
+    }
+    parameters[j][0] = name;
+    parameters[j][1] = value;
+  }
 }
 
 
@@ -720,8 +954,11 @@ flickcurl_prepare_common(flickcurl *fc,
   if((upload_field || upload_value) && (!upload_field || !upload_value))
     return 1;
   
+  flickcurl_timing_flush(fc);
+
   fc->failed = 0;
   fc->error_code = 0;
+  fc->status_code = 0;
   if(fc->error_msg) {
     free(fc->error_msg);
     fc->error_msg = NULL;
@@ -1177,6 +1414,14 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
   struct curl_slist *slist = NULL;
   xmlDocPtr doc = NULL;
   struct timeval now;
+  struct timeval done;
+  long latency_usec = -1;
+  int perform_failed;
+  int hedged = 0;
+  long hedged_status = 0;
+  char* hedged_content = NULL;
+  size_t hedged_content_len = 0;
+  double wire_bytes = fc->wire_bytes;
 #if defined(OFFLINE) || defined(CAPTURE)
   char filename[200];
 #endif
@@ -1224,6 +1469,10 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
     fc->save_content = 1;
   else
     fc->xml_parse_content = 1;
+
+  flickcurl_timing_flush(fc);
+  memset(&fc->timing, '\0', sizeof(fc->timing));
+  fc->timing.method = fc->method;
   
   gettimeofday(&now, NULL);
 #ifndef OFFLINE
@@ -1266,6 +1515,7 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
         nwait.tv_sec--;
         nwait.tv_nsec+= 1000000000;
       }
+      fc->timing.delay_usec = nwait.tv_sec * 1000000L + nwait.tv_nsec / 1000;
       
       /* Wait until timeval 'wait' happens */
 #if FLICKCURL_DEBUG > 1
@@ -1303,8 +1553,15 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
       xmlFreeDoc(fc->xc->myDoc);
       fc->xc->myDoc = NULL;
     }
-    xmlFreeParserCtxt(fc->xc); 
-    fc->xc = NULL;
+    /* Keep the parser so the names interned in its dictionary are
+     * shared by every response; start over if the dictionary has
+     * grown with unusual content.
+     */
+    if(xmlDictSize(fc->xc->dict) > FLICKCURL_XML_DICT_MAX_SIZE) {
+      xmlFreeParserCtxt(fc->xc); 
+      fc->xc = NULL;
+    } else
+      fc->xc_reset = 1;
   }
 
   if(fc->proxy)
@@ -1313,6 +1570,14 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
   if(fc->user_agent)
     curl_easy_setopt(fc->curl_handle, CURLOPT_USERAGENT, fc->user_agent);
 
+#ifndef CURLOPT_ACCEPT_ENCODING
+#define CURLOPT_ACCEPT_ENCODING CURLOPT_ENCODING
+#endif
+
+  /* NULL turns off compressed responses */
+  curl_easy_setopt(fc->curl_handle, CURLOPT_ACCEPT_ENCODING,
+                   fc->accept_encoding);
+
   /* Insert HTTP Accept: header */
   if(fc->http_accept)
     slist = curl_slist_append(slist, (const char*)fc->http_accept);
@@ -1321,6 +1586,8 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
   curl_easy_setopt(fc->curl_handle, CURLOPT_URL, fc->uri);
 
   fc->total_bytes = 0;
+  fc->partial_seen = 0;
+  fc->partial_done = 0;
 
   /* default: read with no data: GET */
   curl_easy_setopt(fc->curl_handle, CURLOPT_NOBODY, 1);
@@ -1384,19 +1651,55 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
           fc->uri, ((fc->is_write || fc->upload_field) ? "POST" : "GET"));
 #endif
   
-  if(curl_easy_perform(fc->curl_handle)) {
+  gettimeofday(&now, NULL);
+  /* only idempotent reads may be sent twice */
+  if(fc->hedge_percentile && fc->method && !fc->is_write && !fc->data &&
+     !fc->upload_field) {
+    hedged = 1;
+    perform_failed = flickcurl_hedged_perform(fc, &hedged_status,
+                                              &hedged_content,
+                                              &hedged_content_len);
+    /* restore the write callback replaced while hedging */
+    curl_easy_setopt(fc->curl_handle, CURLOPT_WRITEFUNCTION, 
+                     flickcurl_write_callback);
+    curl_easy_setopt(fc->curl_handle, CURLOPT_WRITEDATA, fc);
+  } else {
+    CURLcode res = curl_easy_perform(fc->curl_handle);
+
+    /* a partial response stops the transfer from the write callback */
+    perform_failed = (res != CURLE_OK &&
+                      !(res == CURLE_WRITE_ERROR && fc->partial_done));
+  }
+
+  if(perform_failed) {
     /* failed */
     fc->failed = 1;
     flickcurl_error(fc, fc->error_buffer);
   } else {
-    long lstatus;
+    long lstatus = hedged_status;
+
+    gettimeofday(&done, NULL);
+    latency_usec = (done.tv_sec - now.tv_sec) * 1000000L +
+                   (done.tv_usec - now.tv_usec);
+
+    if(hedged_content) {
+      flickcurl_write_callback(hedged_content, 1, hedged_content_len, fc);
+      free(hedged_content);
+    }
+
+    if(!hedged) {
+      fc->wire_bytes += flickcurl_get_handle_wire_bytes(fc->curl_handle);
+      flickcurl_timing_set_transfer(fc, fc->curl_handle);
+    } else
+      fc->timing.transfer_usec = latency_usec;
+    fc->decoded_bytes += fc->total_bytes;
 
 #ifndef CURLINFO_RESPONSE_CODE
 #define CURLINFO_RESPONSE_CODE CURLINFO_HTTP_CODE
 #endif
 
     /* Requires pointer to a long */
-    if(CURLE_OK == 
+    if(hedged || CURLE_OK == 
        curl_easy_getinfo(fc->curl_handle, CURLINFO_RESPONSE_CODE, &lstatus) ) {
       fc->status_code = lstatus;
       if(fc->status_code != 200) {
@@ -1475,14 +1778,16 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
     xmlAttr* attr;
     int failed = 0;
     
-    xmlParseChunk(fc->xc, NULL, 0, 1);
+    /* no content means the parser was never (re)started */
+    if(fc->xc && !fc->xc_reset && !fc->partial_done)
+      xmlParseChunk(fc->xc, NULL, 0, 1);
 
 #ifdef FLICKCURL_DEBUG
     fprintf(stderr, "Got %d bytes content from URI '%s'\n",
             fc->total_bytes, fc->uri);
 #endif
 
-    doc = fc->xc->myDoc;
+    doc = (fc->xc && !fc->xc_reset) ? fc->xc->myDoc : NULL;
     if(!doc) {
       flickcurl_error(fc, "Failed to create XML DOM for document");
       fc->failed = 1;
@@ -1535,6 +1840,17 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
   tidy:
   if(fc->failed)
     rc = 1;
+
+  /* parsing left after the response ended */
+  if(latency_usec >= 0)
+    fc->timing.parse_usec += flickcurl_timing_elapsed(&done);
+  fc->timing.total_usec = fc->timing.delay_usec +
+                          flickcurl_timing_elapsed(&now);
+  fc->timing_pending = 1;
+  gettimeofday(&fc->timing_build_start, NULL);
+
+  flickcurl_pacing_update(fc, latency_usec);
+  flickcurl_metrics_update(fc, latency_usec, fc->wire_bytes - wire_bytes);
   
 #ifdef CAPTURE
   if(1) {
@@ -1545,6 +1861,8 @@ flickcurl_invoke_common(flickcurl *fc, char** content_p, size_t* size_p,
 
   /* reset special flags */
   fc->sign = 0;
+  if(fc->partial_element)
+    flickcurl_set_partial_response(fc, NULL, 0);
   
   return rc;
 }
@@ -1573,19 +1891,17 @@ flickcurl_invoke_get_content(flickcurl *fc, size_t* size_p)
 char*
 flickcurl_unixtime_to_isotime(time_t unix_time)
 {
-  struct tm* structured_time;
-#define ISO_DATE_FORMAT "%Y-%m-%dT%H:%M:%SZ"
-#define ISO_DATE_LEN 20
-  static char date_buffer[ISO_DATE_LEN + 1];
+  char date_buffer[FLICKCURL_ISOTIME_SIZE];
   size_t len;
   char *value = NULL;
   
-  structured_time = (struct tm*)gmtime(&unix_time);
-  len = ISO_DATE_LEN;
-  strftime(date_buffer, len+1, ISO_DATE_FORMAT, structured_time);
+  len = flickcurl_format_isotime(unix_time, date_buffer, sizeof(date_buffer));
+  if(!len)
+    return NULL;
   
   value = (char*)malloc(len + 1);
-  strncpy((char*)value, date_buffer, len+1);
+  if(value)
+    memcpy(value, date_buffer, len + 1);
   return value;
 }
 
@@ -1593,19 +1909,18 @@ flickcurl_unixtime_to_isotime(time_t unix_time)
 char*
 flickcurl_unixtime_to_sqltimestamp(time_t unix_time)
 {
-  struct tm* structured_time;
-#define SQL_DATETIME_FORMAT "%Y %m %d %H:%M:%S"
-#define SQL_DATETIME_LEN 19
-  static char date_buffer[SQL_DATETIME_LEN + 1];
+  char date_buffer[FLICKCURL_SQLTIMESTAMP_SIZE];
   size_t len;
   char *value = NULL;
   
-  structured_time = (struct tm*)gmtime(&unix_time);
-  len = ISO_DATE_LEN;
-  strftime(date_buffer, len+1, SQL_DATETIME_FORMAT, structured_time);
+  len = flickcurl_format_sqltimestamp(unix_time, date_buffer,
+                                      sizeof(date_buffer));
+  if(!len)
+    return NULL;
   
   value = (char*)malloc(len + 1);
-  strncpy((char*)value, date_buffer, len+1);
+  if(value)
+    memcpy(value, date_buffer, len + 1);
   return value;
 }
 
@@ -1642,7 +1957,7 @@ flickcurl_xpath_eval(flickcurl *fc, xmlXPathContextPtr xpathCtx,
   int i;
   char* value = NULL;
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -1689,7 +2004,7 @@ flickcurl_xpath_eval_to_tree_string(flickcurl* fc,
   size_t value_len = 0;
   xmlNodeSetPtr nodes;
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathNodeCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathNodeCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -1865,6 +2180,7 @@ flickcurl_call_get_one_string_field(flickcurl* fc,
   xmlXPathFreeContext(xpathCtx);
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return result;
 }
@@ -2147,17 +2463,25 @@ flickcurl_get_feed_format_info(int feed_format,
 
 /*
  * flickcurl_append_photos_list_params:
- * @list_params: in parameter - photos list paramater
+ * @fc: flickcurl context
+ * @list_params: in parameter - photos list paramater (or NULL)
  * @parameters: in/out parameter - array of name/value parameters
  * @count_p: in/out parameter - updated as new parameters added
  * @format_p: out parameter - result format requested or NULL
  *
  * INTERNAL - append #flickcurl_photos_list_params to parameter list for API call
  *
+ * If JSON mode is set with flickcurl_set_json_mode() and no result
+ * format is requested, the JSON format is asked for and decoded by
+ * flickcurl_invoke_photos_list() so *@format_p stays NULL.  Likewise
+ * without extras in @list_params, those needed by the photo fields
+ * set with flickcurl_set_photo_fields() are asked for.
+ *
  * Return value: number of parameters added
  */
 int
-flickcurl_append_photos_list_params(flickcurl_photos_list_params* list_params,
+flickcurl_append_photos_list_params(flickcurl* fc,
+                                    flickcurl_photos_list_params* list_params,
                                     const char* parameters[][2], int* count_p,
                                     const char** format_p)
 {
@@ -2170,15 +2494,28 @@ flickcurl_append_photos_list_params(flickcurl_photos_list_params* list_params,
   if(format_p)
     *format_p = NULL;
 
-  if(!list_params)
-    return 0;
-  
-  if(list_params->extras) {
+  if(fc->json_mode && (!list_params || !list_params->format)) {
+    parameters[*count_p][0]  = "format";
+    parameters[*count_p][1]= "json";
+    (*count_p)++;
+    this_count++;
+  }
+
+  if(list_params && list_params->extras) {
     parameters[*count_p][0]  = "extras";
     parameters[*count_p][1]= list_params->extras;
     (*count_p)++;
     this_count++;
+  } else if(fc->photo_fields_extras) {
+    parameters[*count_p][0]  = "extras";
+    parameters[*count_p][1]= fc->photo_fields_extras;
+    (*count_p)++;
+    this_count++;
   }
+
+  if(!list_params)
+    return this_count;
+  
   if(list_params->per_page) {
     if(list_params->per_page >= 0 && list_params->per_page <= 999) {
       sprintf(per_page_s, "%d", list_params->per_page);
@@ -89,6 +89,8 @@ flickcurl_commons_getInstitutions(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     institutions = NULL;
 
@@ -114,6 +114,8 @@ flickcurl_contacts_getList(flickcurl* fc, const char* filter,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     contacts = NULL;
 
@@ -186,6 +188,8 @@ flickcurl_contacts_getListRecentlyUploaded(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     contacts = NULL;
 
@@ -265,6 +269,8 @@ flickcurl_contacts_getPublicList(flickcurl* fc, const char* user_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     contacts = NULL;
 
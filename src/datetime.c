@@ -0,0 +1,425 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * datetime.c - Flickcurl reentrant date formatting and parsing
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#include <time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * The conversions below work on the proleptic Gregorian calendar in
+ * UTC without gmtime(), timegm() or any static buffer so that they
+ * can be used from any number of threads.
+ */
+
+#define SECONDS_PER_DAY 86400L
+
+
+/* days since 1970-01-01 of a date; @month is 1-12 */
+static long
+flickcurl_days_from_civil(long year, int month, int day)
+{
+  long era;
+  long year_of_era;
+  long day_of_year;
+  long day_of_era;
+
+  /* count years from March so the leap day is last */
+  if(month <= 2)
+    year--;
+  era = (year >= 0 ? year : year - 399) / 400;
+  year_of_era = year - era * 400;
+  day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 +
+               day_of_year;
+
+  return era * 146097 + day_of_era - 719468;
+}
+
+
+/* inverse of flickcurl_days_from_civil() */
+static void
+flickcurl_civil_from_days(long days, long* year_p, int* month_p, int* day_p)
+{
+  long era;
+  long day_of_era;
+  long year_of_era;
+  long day_of_year;
+  long mp;
+
+  days += 719468;
+  era = (days >= 0 ? days : days - 146096) / 146097;
+  day_of_era = days - era * 146097;
+  year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+                 day_of_era / 146096) / 365;
+  day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 -
+                              year_of_era / 100);
+  mp = (5 * day_of_year + 2) / 153;
+
+  *day_p = (int)(day_of_year - (153 * mp + 2) / 5 + 1);
+  *month_p = (int)(mp < 10 ? mp + 3 : mp - 9);
+  *year_p = year_of_era + era * 400 + (*month_p <= 2);
+}
+
+
+static void
+flickcurl_put_digits(char* buffer, long value, int width)
+{
+  while(width--) {
+    buffer[width] = (char)('0' + value % 10);
+    value /= 10;
+  }
+}
+
+
+/*
+ * flickcurl_format_time:
+ * @unix_time: time
+ * @buffer: buffer to write to
+ * @size: size of @buffer
+ * @date_sep: separator of the date fields
+ * @time_sep: separator between date and time
+ * @zulu: non-0 to end with 'Z'
+ *
+ * INTERNAL - format a time as "YYYY?MM?DD?HH:MM:SS" and an optional Z
+ *
+ * Return value: length written or 0 if @buffer is too small or the year is not 0-9999
+ */
+static size_t
+flickcurl_format_time(time_t unix_time, char* buffer, size_t size,
+                      char date_sep, char time_sep, int zulu)
+{
+  long days;
+  long seconds;
+  long year;
+  int month;
+  int day;
+  size_t len = zulu ? 20 : 19;
+
+  if(!buffer || size < len + 1)
+    return 0;
+
+  days = (long)(unix_time / SECONDS_PER_DAY);
+  seconds = (long)(unix_time % SECONDS_PER_DAY);
+  if(seconds < 0) {
+    seconds += SECONDS_PER_DAY;
+    days--;
+  }
+
+  flickcurl_civil_from_days(days, &year, &month, &day);
+  if(year < 0 || year > 9999)
+    return 0;
+
+  flickcurl_put_digits(buffer, year, 4);
+  buffer[4] = date_sep;
+  flickcurl_put_digits(buffer + 5, month, 2);
+  buffer[7] = date_sep;
+  flickcurl_put_digits(buffer + 8, day, 2);
+  buffer[10] = time_sep;
+  flickcurl_put_digits(buffer + 11, seconds / 3600, 2);
+  buffer[13] = ':';
+  flickcurl_put_digits(buffer + 14, (seconds / 60) % 60, 2);
+  buffer[16] = ':';
+  flickcurl_put_digits(buffer + 17, seconds % 60, 2);
+  if(zulu)
+    buffer[19] = 'Z';
+  buffer[len] = '\0';
+
+  return len;
+}
+
+
+/**
+ * flickcurl_format_isotime:
+ * @unix_time: time
+ * @buffer: buffer to write to
+ * @size: size of @buffer; at least FLICKCURL_ISOTIME_SIZE
+ *
+ * Format a time as an ISO 8601 UTC dateTime "YYYY-MM-DDTHH:MM:SSZ"
+ *
+ * This function is reentrant.
+ *
+ * Return value: length of the string written or 0 on failure
+ **/
+size_t
+flickcurl_format_isotime(time_t unix_time, char* buffer, size_t size)
+{
+  return flickcurl_format_time(unix_time, buffer, size, '-', 'T', 1);
+}
+
+
+/**
+ * flickcurl_format_sqltimestamp:
+ * @unix_time: time
+ * @buffer: buffer to write to
+ * @size: size of @buffer; at least FLICKCURL_SQLTIMESTAMP_SIZE
+ *
+ * Format a time as an SQL UTC timestamp "YYYY MM DD HH:MM:SS"
+ *
+ * This is the form used for taken date arguments of the web service.
+ * This function is reentrant.
+ *
+ * Return value: length of the string written or 0 on failure
+ **/
+size_t
+flickcurl_format_sqltimestamp(time_t unix_time, char* buffer, size_t size)
+{
+  return flickcurl_format_time(unix_time, buffer, size, ' ', ' ', 0);
+}
+
+
+/* read exactly @width digits */
+static int
+flickcurl_get_digits(const char** p, int width, long* value_p)
+{
+  long value = 0;
+
+  while(width--) {
+    if(**p < '0' || **p > '9')
+      return 1;
+    value = value * 10 + (*(*p)++ - '0');
+  }
+
+  *value_p = value;
+  return 0;
+}
+
+
+static int
+flickcurl_days_in_month(long year, int month)
+{
+  static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+  if(month == 2 && !(year % 4) && ((year % 100) || !(year % 400)))
+    return 29;
+  return days[month - 1];
+}
+
+
+/*
+ * flickcurl_parse_iso_datetime:
+ * @string: date string
+ * @zoned_p: pointer to set to non-0 if @string has a zone (or NULL)
+ *
+ * INTERNAL - parse the ISO 8601 and SQL date forms used by Flickr
+ *
+ * Accepts "YYYY-MM-DD" with '-' or ' ' separators, optionally
+ * followed by 'T' or ' ' and "HH:MM" or "HH:MM:SS" with optional
+ * fraction, then optionally 'Z' or a "+HH:MM" style offset.  Times
+ * without an offset are returned as if they were UTC.
+ *
+ * Return value: time or -1 if @string is not in this form
+ */
+static time_t
+flickcurl_parse_iso_datetime(const char* string, int* zoned_p)
+{
+  const char* p = string;
+  long year;
+  long month;
+  long day;
+  long hour = 0;
+  long minute = 0;
+  long second = 0;
+  long offset = 0;
+  int zoned = 0;
+  char date_sep;
+
+  if(flickcurl_get_digits(&p, 4, &year))
+    return -1;
+  date_sep = *p++;
+  if(date_sep != '-' && date_sep != ' ')
+    return -1;
+  if(flickcurl_get_digits(&p, 2, &month) || *p++ != date_sep ||
+     flickcurl_get_digits(&p, 2, &day))
+    return -1;
+  if(month < 1 || month > 12 || day < 1 ||
+     day > flickcurl_days_in_month(year, (int)month))
+    return -1;
+
+  if((*p == 'T' || *p == ' ') && p[1] >= '0' && p[1] <= '9') {
+    p++;
+    if(flickcurl_get_digits(&p, 2, &hour) || *p++ != ':' ||
+       flickcurl_get_digits(&p, 2, &minute))
+      return -1;
+    if(*p == ':') {
+      p++;
+      if(flickcurl_get_digits(&p, 2, &second))
+        return -1;
+      if(*p == '.')
+        for(p++; *p >= '0' && *p <= '9'; p++)
+          ;
+    }
+    /* allow a leap second */
+    if(hour > 23 || minute > 59 || second > 60)
+      return -1;
+
+    if(*p == 'Z') {
+      p++;
+      zoned = 1;
+    } else if(*p == '+' || *p == '-') {
+      int sign = (*p++ == '-') ? -1 : 1;
+      long offset_hour;
+      long offset_minute = 0;
+
+      if(flickcurl_get_digits(&p, 2, &offset_hour))
+        return -1;
+      if(*p == ':')
+        p++;
+      if(*p && flickcurl_get_digits(&p, 2, &offset_minute))
+        return -1;
+      offset = sign * (offset_hour * 3600 + offset_minute * 60);
+      zoned = 1;
+    }
+  }
+
+  if(*p)
+    return -1;
+
+  if(zoned_p)
+    *zoned_p = zoned;
+
+  return (time_t)flickcurl_days_from_civil(year, (int)month, (int)day) *
+         SECONDS_PER_DAY + hour * 3600 + minute * 60 + second - offset;
+}
+
+
+/**
+ * flickcurl_parse_datetime:
+ * @string: date string
+ *
+ * Parse a date and time string from the web service
+ *
+ * ISO 8601 and SQL timestamp forms such as "2004-11-29 16:01:26" are
+ * parsed directly and are UTC unless an offset is given.  Other forms
+ * are passed to curl_getdate().  This function is reentrant.
+ *
+ * Return value: time or -1 on failure
+ **/
+time_t
+flickcurl_parse_datetime(const char* string)
+{
+  time_t unix_time;
+
+  if(!string)
+    return -1;
+
+  unix_time = flickcurl_parse_iso_datetime(string, NULL);
+  if(unix_time != (time_t)-1)
+    return unix_time;
+
+  return curl_getdate(string, NULL);
+}
+
+
+/* hash of a cached date string */
+static unsigned int
+flickcurl_date_cache_hash(const char* string, int is_unixtime)
+{
+  unsigned int hash = 5381 + (unsigned int)is_unixtime;
+
+  while(*string)
+    hash = (hash * 33) ^ (unsigned char)*string++;
+
+  return hash;
+}
+
+
+/*
+ * flickcurl_date_to_isotime:
+ * @fc: flickcurl context
+ * @string: date string from the web service
+ * @is_unixtime: non-0 if @string is a decimal unix time
+ * @isotime: buffer of FLICKCURL_ISOTIME_SIZE for the ISO dateTime
+ *
+ * INTERNAL - convert a date field value to a time and an ISO dateTime
+ *
+ * Dates without a zone, such as the local taken dates of photos, give
+ * an ISO dateTime without the 'Z' and a time as if they were UTC.
+ *
+ * Results are kept in a small per-session cache since the same dates
+ * appear many times in one response.  Being per-session, sessions on
+ * different threads do not share or lock it.
+ *
+ * Return value: time or <0 on failure, when @isotime is empty
+ */
+time_t
+flickcurl_date_to_isotime(flickcurl* fc, const char* string, int is_unixtime,
+                          char* isotime)
+{
+  flickcurl_date_cache_entry* entry = NULL;
+  time_t unix_time;
+  int zoned = 1;
+
+  if(*string && strlen(string) < FLICKCURL_DATE_CACHE_KEY_SIZE) {
+    if(!fc->date_cache)
+      fc->date_cache = (flickcurl_date_cache_entry*)calloc(FLICKCURL_DATE_CACHE_SIZE,
+                                                           sizeof(flickcurl_date_cache_entry));
+    if(fc->date_cache) {
+      unsigned int hash = flickcurl_date_cache_hash(string, is_unixtime);
+
+      entry = &fc->date_cache[hash & (FLICKCURL_DATE_CACHE_SIZE - 1)];
+      if(entry->is_unixtime == is_unixtime && !strcmp(entry->key, string)) {
+        memcpy(isotime, entry->isotime, FLICKCURL_ISOTIME_SIZE);
+        return entry->unix_time;
+      }
+    }
+  }
+
+  if(is_unixtime)
+    unix_time = atoi(string);
+  else {
+    unix_time = flickcurl_parse_iso_datetime(string, &zoned);
+    if(unix_time == (time_t)-1)
+      unix_time = curl_getdate(string, NULL);
+  }
+
+  if(unix_time < 0 ||
+     !flickcurl_format_time(unix_time, isotime, FLICKCURL_ISOTIME_SIZE,
+                            '-', 'T', zoned)) {
+    unix_time = -1;
+    *isotime = '\0';
+  }
+
+  if(entry) {
+    strcpy(entry->key, string);
+    entry->is_unixtime = is_unixtime;
+    entry->unix_time = unix_time;
+    memcpy(entry->isotime, isotime, FLICKCURL_ISOTIME_SIZE);
+  }
+
+  return unix_time;
+}
@@ -91,6 +91,8 @@ flickcurl_favorites_add(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   return fc->failed;
 }
 
@@ -130,7 +132,7 @@ flickcurl_favorites_getList_params(flickcurl* fc, const char* user_id,
     parameters[count++][1]= user_id;
   }
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
   
   parameters[count][0]  = NULL;
 
@@ -225,7 +227,7 @@ flickcurl_favorites_getPublicList_params(flickcurl* fc, const char* user_id,
   parameters[count++][1]= user_id;
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -341,6 +343,8 @@ flickcurl_favorites_remove(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   return fc->failed;
 }
 
@@ -27,6 +27,12 @@
 extern "C" {
 #endif
 
+/* needed for FILE */
+#include <stdio.h>
+
+/* needed for time_t */
+#include <time.h>
+
 /* needed for xmlDocPtr */
 #include <libxml/tree.h>
 
@@ -124,7 +130,7 @@ typedef enum {
  * @PHOTO_FIELD_server: server
  * @PHOTO_FIELD_dates_lastupdate: last update date
  * @PHOTO_FIELD_dates_posted: posted date
- * @PHOTO_FIELD_dates_taken: taken date
+ * @PHOTO_FIELD_dates_taken: taken date in local time without a zone
  * @PHOTO_FIELD_dates_takengranularity: taken granularity
  * @PHOTO_FIELD_description: description
  * @PHOTO_FIELD_editability_canaddmeta: can add metadata boolean
@@ -252,6 +258,29 @@ typedef enum {
 } flickcurl_photo_field_type;
 
 
+/**
+ * flickcurl_photo_part:
+ * @FLICKCURL_PHOTO_PART_URI: photo page URI
+ * @FLICKCURL_PHOTO_PART_MEDIA: media type
+ * @FLICKCURL_PHOTO_PART_TAGS: tags
+ * @FLICKCURL_PHOTO_PART_PLACE: place
+ * @FLICKCURL_PHOTO_PART_VIDEO: video
+ * @FLICKCURL_PHOTO_PART_NOTES: notes
+ * @FLICKCURL_PHOTO_PART_ALL: all parts
+ *
+ * Parts of a photo besides its fields, for flickcurl_set_photo_fields()
+ */
+typedef enum {
+  FLICKCURL_PHOTO_PART_URI   = 1,
+  FLICKCURL_PHOTO_PART_MEDIA = 2,
+  FLICKCURL_PHOTO_PART_TAGS  = 4,
+  FLICKCURL_PHOTO_PART_PLACE = 8,
+  FLICKCURL_PHOTO_PART_VIDEO = 16,
+  FLICKCURL_PHOTO_PART_NOTES = 32,
+  FLICKCURL_PHOTO_PART_ALL   = 63
+} flickcurl_photo_part;
+
+
 /**
  * flickcurl:
  *
@@ -610,6 +639,7 @@ typedef struct {
  * @shapefile_urls_count: DEPRECATED for @shape->file_urls_count: number of entries in @shapefile_urls array
  * @shape: shapefile data (inline data and shapefile urls)
  * @timezone: timezone of location in 'zoneinfo' format such as “Europe/Paris”.
+ * @intern: internal - table of the interned strings (or NULL)
  *
  * A Place.
  *
@@ -634,6 +664,7 @@ typedef struct {
 
   struct flickcurl_shapedata_s* shape;
   char* timezone;
+  struct flickcurl_intern_table_s* intern;
 } flickcurl_place;
   
 
@@ -677,6 +708,7 @@ typedef struct flickcurl_shapedata_s {
  * @cooked: cooked tag (may be NULL, but if so @raw must not be NULL)
  * @machine_tag: boolean (non-0 true) if tag is a Machine Tag
  * @count: tag count in a histogram (or 0)
+ * @intern: internal - table of the interned strings (or NULL)
  *
  * A tag OR a posting of a tag about a photo by a user OR a tag in a histogram
  *
@@ -694,6 +726,7 @@ typedef struct flickcurl_tag_s {
   char* cooked;
   int machine_tag;
   int count;
+  struct flickcurl_intern_table_s* intern;
 } flickcurl_tag;
 
 
@@ -771,9 +804,13 @@ typedef struct {
  * @media_type: "photo" or "video"
  * @notes: array of notes (may be NULL)
  * @notes_count: size of notes array
+ * @lazy: internal - response retained to decode fields on access (or NULL)
+ * @intern: internal - table of the interned strings (or NULL)
  *
  * A photo or video.
  *
+ * Photos built by a session in lazy mode have empty @fields until
+ * they are read with flickcurl_photo_get_field().
  */
 typedef struct flickcurl_photo_s {
   char *id;
@@ -792,6 +829,9 @@ typedef struct flickcurl_photo_s {
 
   flickcurl_note** notes;
   int notes_count;
+
+  struct flickcurl_photo_lazy_s* lazy;
+  struct flickcurl_intern_table_s* intern;
 } flickcurl_photo;
 
 
@@ -1163,6 +1203,7 @@ typedef struct {
  * flickcurl_person: 
  * @nsid: user NSID
  * @fields: person fields
+ * @intern: internal - table of the interned strings (or NULL)
  *
  * A user.
  */
@@ -1170,12 +1211,13 @@ typedef struct {
   char *nsid;
 
   flickcurl_person_field fields[PERSON_FIELD_LAST + 1];
+  struct flickcurl_intern_table_s* intern;
 } flickcurl_person;
 
 
 /**
  * flickcurl_photos_list:
- * @format: requested content format or NULL if a list of photos was wanted.  On the result from API calls this is set to the requested feed format or "xml" if none was given.
+ * @format: requested content format or NULL if a list of photos was wanted.  On the result from API calls this is set to the requested feed format or "xml" (or "json" in JSON mode) if none was given and @photos was decoded.
  * @photos: list of photos if @format is NULL.  Also may be NULL on failure.
  * @photos_count: number of photos in @photos array if @format is NULL. Undefined on failure
  * @content: raw content if @format is not NULL.  Also may be NULL on failure.
@@ -1515,6 +1557,255 @@ void flickcurl_free_serializer(flickcurl_serializer* serializer);
 FLICKCURL_API
 int flickcurl_serialize_photo(flickcurl_serializer* fcs, flickcurl_photo* photo);
 
+typedef struct flickcurl_photo_store_s flickcurl_photo_store;
+
+/* compact binary photo records */
+FLICKCURL_API
+unsigned char* flickcurl_photo_to_binary(flickcurl_photo* photo, size_t* length_p);
+FLICKCURL_API
+flickcurl_photo* flickcurl_photo_from_binary(const unsigned char* data, size_t length);
+FLICKCURL_API
+size_t flickcurl_photo_binary_get_length(const unsigned char* data, size_t length);
+FLICKCURL_API
+const char* flickcurl_photo_binary_get_id(const unsigned char* data, size_t length);
+FLICKCURL_API
+int flickcurl_photo_binary_get_field(const unsigned char* data, size_t length, flickcurl_photo_field_type field, flickcurl_field_value_type* type_p, int* integer_p, const char** string_p);
+FLICKCURL_API
+flickcurl_photo_store* flickcurl_new_photo_store(flickcurl* fc, const char* filename);
+FLICKCURL_API
+void flickcurl_free_photo_store(flickcurl_photo_store* store);
+FLICKCURL_API
+const unsigned char* flickcurl_photo_store_next(flickcurl_photo_store* store, size_t* offset_p, size_t* length_p);
+
+typedef struct flickcurl_column_writer_s flickcurl_column_writer;
+
+/* columnar photo export */
+FLICKCURL_API
+flickcurl_column_writer* flickcurl_new_column_writer(flickcurl* fc, FILE* fh, const flickcurl_photo_field_type* fields, int row_group_size);
+FLICKCURL_API
+void flickcurl_free_column_writer(flickcurl_column_writer* writer);
+FLICKCURL_API
+int flickcurl_column_writer_add_photo(flickcurl_column_writer* writer, flickcurl_photo* photo);
+FLICKCURL_API
+int flickcurl_column_writer_add_photos_list(flickcurl_column_writer* writer, flickcurl_photos_list* photos_list);
+FLICKCURL_API
+int flickcurl_column_writer_finish(flickcurl_column_writer* writer);
+
+typedef struct flickcurl_compact_photo_s flickcurl_compact_photo;
+typedef struct flickcurl_photo_batch_s flickcurl_photo_batch;
+
+/* compact photos and struct-of-arrays photo batches */
+FLICKCURL_API
+flickcurl_compact_photo* flickcurl_new_compact_photo(flickcurl_photo* photo);
+FLICKCURL_API
+void flickcurl_free_compact_photo(flickcurl_compact_photo* cp);
+FLICKCURL_API
+const char* flickcurl_compact_photo_get_id(flickcurl_compact_photo* cp);
+FLICKCURL_API
+int flickcurl_compact_photo_get_field(flickcurl_compact_photo* cp, flickcurl_photo_field_type field, flickcurl_field_value_type* type_p, int* integer_p, const char** string_p);
+FLICKCURL_API
+flickcurl_photo_batch* flickcurl_new_photo_batch(const flickcurl_photo_field_type* fields);
+FLICKCURL_API
+void flickcurl_free_photo_batch(flickcurl_photo_batch* batch);
+FLICKCURL_API
+int flickcurl_photo_batch_add_photos_list(flickcurl_photo_batch* batch, flickcurl_photos_list* photos_list);
+FLICKCURL_API
+int flickcurl_photo_batch_get_count(flickcurl_photo_batch* batch);
+FLICKCURL_API
+const char** flickcurl_photo_batch_get_ids(flickcurl_photo_batch* batch);
+FLICKCURL_API
+const int* flickcurl_photo_batch_get_integers(flickcurl_photo_batch* batch, flickcurl_photo_field_type field);
+FLICKCURL_API
+const char** flickcurl_photo_batch_get_strings(flickcurl_photo_batch* batch, flickcurl_photo_field_type field);
+FLICKCURL_API
+const unsigned char* flickcurl_photo_batch_get_types(flickcurl_photo_batch* batch, flickcurl_photo_field_type field);
+
+
+/**
+ * flickcurl_sync_handler:
+ * @user_data: user data
+ * @photo: photo created or modified since the last sync
+ *
+ * Handler to apply a photo update to a local store during a sync
+ *
+ * Return value: non-0 to stop the sync
+ */
+typedef int (*flickcurl_sync_handler)(void* user_data, flickcurl_photo* photo);
+
+/**
+ * flickcurl_search_handler:
+ * @user_data: user data
+ * @photo: photo found
+ *
+ * Handler for each photo found by flickcurl_photos_search_all()
+ *
+ * Return value: non-0 to stop the search
+ */
+typedef int (*flickcurl_search_handler)(void* user_data, flickcurl_photo* photo);
+
+typedef struct flickcurl_sync_s flickcurl_sync;
+
+FLICKCURL_API
+flickcurl_sync* flickcurl_new_sync(flickcurl* fc, const char* account, const char* state_filename);
+FLICKCURL_API
+void flickcurl_free_sync(flickcurl_sync* sync);
+FLICKCURL_API
+int flickcurl_sync_run(flickcurl_sync* sync, const char* extras, flickcurl_sync_handler handler, void* user_data);
+FLICKCURL_API
+int flickcurl_sync_get_watermark(flickcurl_sync* sync);
+FLICKCURL_API
+int flickcurl_sync_get_updated_count(flickcurl_sync* sync);
+
+typedef struct flickcurl_mutation_batch_s flickcurl_mutation_batch;
+
+FLICKCURL_API
+flickcurl_mutation_batch* flickcurl_new_mutation_batch(flickcurl* fc, int max_ops, int max_age);
+FLICKCURL_API
+void flickcurl_free_mutation_batch(flickcurl_mutation_batch* batch);
+FLICKCURL_API
+int flickcurl_mutation_batch_photosets_addPhoto(flickcurl_mutation_batch* batch, const char* photoset_id, const char* photo_id);
+FLICKCURL_API
+int flickcurl_mutation_batch_photosets_removePhoto(flickcurl_mutation_batch* batch, const char* photoset_id, const char* photo_id);
+FLICKCURL_API
+int flickcurl_mutation_batch_galleries_addPhoto(flickcurl_mutation_batch* batch, const char* gallery_id, const char* photo_id);
+FLICKCURL_API
+int flickcurl_mutation_batch_galleries_removePhoto(flickcurl_mutation_batch* batch, const char* gallery_id, const char* photo_id);
+FLICKCURL_API
+int flickcurl_mutation_batch_photos_addTags(flickcurl_mutation_batch* batch, const char* photo_id, const char* tags);
+FLICKCURL_API
+int flickcurl_mutation_batch_flush(flickcurl_mutation_batch* batch);
+
+typedef struct flickcurl_write_queue_s flickcurl_write_queue;
+
+FLICKCURL_API
+flickcurl_write_queue* flickcurl_new_write_queue(flickcurl* fc, const char* journal_filename);
+FLICKCURL_API
+void flickcurl_free_write_queue(flickcurl_write_queue* queue);
+FLICKCURL_API
+void flickcurl_write_queue_set_max_attempts(flickcurl_write_queue* queue, int max_attempts);
+FLICKCURL_API
+int flickcurl_write_queue_add(flickcurl_write_queue* queue, const char* method, const char* parameters[][2], int count);
+FLICKCURL_API
+int flickcurl_write_queue_drain(flickcurl_write_queue* queue, int max_calls);
+FLICKCURL_API
+int flickcurl_write_queue_get_depth(flickcurl_write_queue* queue);
+FLICKCURL_API
+double flickcurl_write_queue_get_drain_rate(flickcurl_write_queue* queue);
+FLICKCURL_API
+int flickcurl_write_queue_get_failed_count(flickcurl_write_queue* queue);
+FLICKCURL_API
+int flickcurl_write_queue_get_retried_count(flickcurl_write_queue* queue);
+FLICKCURL_API
+int flickcurl_write_queue_photos_setMeta(flickcurl_write_queue* queue, const char* photo_id, const char* title, const char* description);
+FLICKCURL_API
+int flickcurl_write_queue_photos_setPerms(flickcurl_write_queue* queue, const char* photo_id, flickcurl_perms* perms);
+FLICKCURL_API
+int flickcurl_write_queue_photos_geo_setLocation(flickcurl_write_queue* queue, const char* photo_id, flickcurl_location* location);
+FLICKCURL_API
+int flickcurl_write_queue_photos_setTags(flickcurl_write_queue* queue, const char* photo_id, const char* tags);
+
+
+/**
+ * flickcurl_metrics_count:
+ * @code: HTTP status or Flickr error code or -1 for codes not recorded separately
+ * @count: number of responses with @code
+ *
+ * Count of responses with a status or error code
+ */
+typedef struct {
+  int code;
+  int count;
+} flickcurl_metrics_count;
+
+
+/**
+ * flickcurl_method_metrics:
+ * @method: API method name such as "flickr.photos.search"
+ * @requests: number of requests made
+ * @errors: number of requests that failed
+ * @wire_bytes: response body bytes received
+ * @decoded_bytes: response body bytes after decoding compression
+ * @latency_mean: mean latency of completed requests in microseconds
+ * @latency_p50: median latency in microseconds
+ * @latency_p90: 90th percentile latency in microseconds
+ * @latency_p99: 99th percentile latency in microseconds
+ * @latency_max: largest latency in microseconds
+ * @error_codes: array of Flickr error codes returned
+ * @error_codes_count: size of @error_codes array
+ * @status_codes: array of HTTP statuses returned
+ * @status_codes_count: size of @status_codes array
+ * @delay_usec: total wait before sending for the request delay in microseconds
+ *
+ * Request metrics of one API method
+ */
+typedef struct {
+  char* method;
+  int requests;
+  int errors;
+  double wire_bytes;
+  double decoded_bytes;
+  double latency_mean;
+  long latency_p50;
+  long latency_p90;
+  long latency_p99;
+  long latency_max;
+  flickcurl_metrics_count* error_codes;
+  int error_codes_count;
+  flickcurl_metrics_count* status_codes;
+  int status_codes_count;
+  double delay_usec;
+} flickcurl_method_metrics;
+
+FLICKCURL_API
+flickcurl_method_metrics** flickcurl_get_method_metrics(flickcurl* fc, int* count_p);
+FLICKCURL_API
+void flickcurl_free_method_metrics(flickcurl_method_metrics** metrics);
+FLICKCURL_API
+int flickcurl_dump_metrics(flickcurl* fc, FILE* fh);
+FLICKCURL_API
+void flickcurl_reset_metrics(flickcurl* fc);
+FLICKCURL_API
+size_t flickcurl_render_openmetrics(flickcurl* fc, char* buffer, size_t buffer_size);
+
+typedef struct flickcurl_metrics_listener_s flickcurl_metrics_listener;
+
+FLICKCURL_API
+flickcurl_metrics_listener* flickcurl_new_metrics_listener(flickcurl* fc, int port);
+FLICKCURL_API
+void flickcurl_free_metrics_listener(flickcurl_metrics_listener* listener);
+FLICKCURL_API
+int flickcurl_metrics_listener_get_port(flickcurl_metrics_listener* listener);
+FLICKCURL_API
+int flickcurl_metrics_listener_poll(flickcurl_metrics_listener* listener, int timeout_msec);
+
+typedef struct flickcurl_id_set_s flickcurl_id_set;
+
+/* compact sets of numeric IDs */
+FLICKCURL_API
+flickcurl_id_set* flickcurl_new_id_set(void);
+FLICKCURL_API
+void flickcurl_free_id_set(flickcurl_id_set* set);
+FLICKCURL_API
+int flickcurl_id_set_add(flickcurl_id_set* set, long long id);
+FLICKCURL_API
+int flickcurl_id_set_add_photos(flickcurl_id_set* set, flickcurl_photo** photos);
+FLICKCURL_API
+int flickcurl_id_set_add_photos_list(flickcurl_id_set* set, flickcurl_photos_list* photos_list);
+FLICKCURL_API
+int flickcurl_id_set_photo_handler(void* user_data, flickcurl_photo* photo);
+FLICKCURL_API
+int flickcurl_id_set_contains(flickcurl_id_set* set, long long id);
+FLICKCURL_API
+int flickcurl_id_set_get_count(flickcurl_id_set* set);
+FLICKCURL_API
+long long* flickcurl_id_set_get_ids(flickcurl_id_set* set, int* count_p);
+FLICKCURL_API
+int flickcurl_id_set_union(flickcurl_id_set* set, flickcurl_id_set* other);
+FLICKCURL_API
+int flickcurl_id_set_intersect(flickcurl_id_set* set, flickcurl_id_set* other);
+FLICKCURL_API
+int flickcurl_id_set_difference(flickcurl_id_set* set, flickcurl_id_set* other);
+
 
 /**
  * flickcurl_member:
@@ -1579,6 +1870,53 @@ typedef void (*flickcurl_tag_handler)(void *user_data, flickcurl_tag* tag);
 typedef void (*flickcurl_curl_setopt_handler)(void *user_data, void *curl_handle);
 
 
+/**
+ * flickcurl_request_timing:
+ * @method: API method name or NULL for uploads; valid until the next request
+ * @delay_usec: wait before sending to honour the request delay
+ * @dns_usec: host name lookup
+ * @connect_usec: TCP connect after the lookup
+ * @tls_usec: TLS handshake after the connect
+ * @ttfb_usec: time to first response byte after the connection was ready
+ * @transfer_usec: rest of the response after the first byte
+ * @parse_usec: XML parsing, both while the response arrives and after it
+ * @build_usec: decoding the response into flickcurl objects or -1 if not known
+ * @total_usec: whole call; the sum of the other phases except @parse_usec which overlaps @transfer_usec
+ *
+ * Phase timing of a web service request in microseconds.
+ *
+ * For a reused connection the lookup and connect phases are 0.
+ * Phases from curl are 0 for hedged requests (see
+ * flickcurl_set_hedging()) which are counted in @transfer_usec.
+ * @build_usec is -1 if the call did not report the end of its
+ * decoding, rather than counting whatever the application did next.
+ */
+typedef struct {
+  const char* method;
+  long delay_usec;
+  long dns_usec;
+  long connect_usec;
+  long tls_usec;
+  long ttfb_usec;
+  long transfer_usec;
+  long parse_usec;
+  long build_usec;
+  long total_usec;
+} flickcurl_request_timing;
+
+
+/**
+ * flickcurl_timing_handler:
+ * @user_data: user data pointer
+ * @timing: timing of the request
+ *
+ * Flickcurl request timing handler callback.
+ *
+ * For use with flickcurl_set_timing_handler().
+ */
+typedef void (*flickcurl_timing_handler)(void *user_data, const flickcurl_request_timing* timing);
+
+
 /* library constants */
 FLICKCURL_API
 extern const char* const flickcurl_short_copyright_string;
@@ -1627,6 +1965,8 @@ void flickcurl_set_upload_service_uri(flickcurl *fc, const char *uri);
 FLICKCURL_API
 void flickcurl_set_replace_service_uri(flickcurl *fc, const char *uri);
 FLICKCURL_API
+void flickcurl_set_accept_encoding(flickcurl* fc, const char *encodings);
+FLICKCURL_API
 void flickcurl_set_api_key(flickcurl* fc, const char *api_key);
 FLICKCURL_API
 void flickcurl_set_auth_token(flickcurl *fc, const char* auth_token);
@@ -1637,6 +1977,16 @@ void flickcurl_set_error_handler(flickcurl* fc, flickcurl_message_handler error_
 FLICKCURL_API
 void flickcurl_set_http_accept(flickcurl* fc, const char *value);
 FLICKCURL_API
+void flickcurl_set_intern_strings(flickcurl* fc, int intern_strings);
+FLICKCURL_API
+void flickcurl_set_json_mode(flickcurl* fc, int json_mode);
+FLICKCURL_API
+void flickcurl_set_lazy_photos(flickcurl* fc, int lazy_photos);
+FLICKCURL_API
+int flickcurl_set_photo_fields(flickcurl* fc, const flickcurl_photo_field_type* fields, int parts);
+FLICKCURL_API
+int flickcurl_set_partial_response(flickcurl* fc, const char* element, int count);
+FLICKCURL_API
 void flickcurl_set_proxy(flickcurl* fc, const char *proxy);
 FLICKCURL_API
 void flickcurl_set_request_delay(flickcurl *fc, long delay_msec);
@@ -1654,6 +2004,20 @@ FLICKCURL_API
 void flickcurl_set_xml_data(flickcurl *fc, xmlDocPtr doc);
 FLICKCURL_API
 int flickcurl_get_current_request_wait(flickcurl *fc);
+FLICKCURL_API
+void flickcurl_set_adaptive_pacing(flickcurl* fc, long min_delay_msec, long max_delay_msec, int max_concurrency);
+FLICKCURL_API
+int flickcurl_get_concurrency_limit(flickcurl* fc);
+FLICKCURL_API
+void flickcurl_set_hedging(flickcurl* fc, int percentile, int budget_percent);
+FLICKCURL_API
+void flickcurl_get_hedge_stats(flickcurl* fc, int* requests_p, int* hedged_p, int* wins_p);
+FLICKCURL_API
+void flickcurl_get_transfer_stats(flickcurl* fc, double* wire_bytes_p, double* decoded_bytes_p);
+FLICKCURL_API
+const flickcurl_request_timing* flickcurl_get_request_timing(flickcurl* fc);
+FLICKCURL_API
+void flickcurl_set_timing_handler(flickcurl* fc, flickcurl_timing_handler timing_handler, void *timing_data);
 
 /* flickcurl* object set methods */
 FLICKCURL_API
@@ -1739,6 +2103,33 @@ char* flickcurl_photo_as_source_uri(flickcurl_photo *photo, const char c);
 /* get a photo ID from an image URL */
 FLICKCURL_API
 char* flickcurl_source_uri_as_photo_id(const char *uri);
+/* reentrant date formatting and parsing */
+/**
+ * FLICKCURL_ISOTIME_SIZE:
+ *
+ * Size of a buffer for flickcurl_format_isotime()
+ */
+#define FLICKCURL_ISOTIME_SIZE 21
+/**
+ * FLICKCURL_SQLTIMESTAMP_SIZE:
+ *
+ * Size of a buffer for flickcurl_format_sqltimestamp()
+ */
+#define FLICKCURL_SQLTIMESTAMP_SIZE 20
+FLICKCURL_API
+size_t flickcurl_format_isotime(time_t unix_time, char* buffer, size_t size);
+FLICKCURL_API
+size_t flickcurl_format_sqltimestamp(time_t unix_time, char* buffer, size_t size);
+FLICKCURL_API
+time_t flickcurl_parse_datetime(const char* string);
+/* get a photo field, decoding it if the photo is lazy */
+FLICKCURL_API
+flickcurl_photo_field* flickcurl_photo_get_field(flickcurl_photo *photo, flickcurl_photo_field_type field);
+/* get a photo ID as a number */
+FLICKCURL_API
+long long flickcurl_photo_get_id_number(flickcurl_photo *photo);
+FLICKCURL_API
+long long flickcurl_id_to_number(const char* id);
 /* get a page URL for a photo */
 FLICKCURL_API
 char* flickcurl_photo_as_page_uri(flickcurl_photo *photo);
@@ -1935,6 +2326,24 @@ flickcurl_tag_predicate_value** flickcurl_machinetags_getValues(flickcurl* fc, c
 FLICKCURL_API
 flickcurl_tag_predicate_value** flickcurl_machinetags_getRecentValues(flickcurl* fc, const char *nspace, const char* predicate, int added_since);
 
+/* local machine tags index */
+typedef struct flickcurl_machinetag_index_s flickcurl_machinetag_index;
+
+FLICKCURL_API
+flickcurl_machinetag_index* flickcurl_new_machinetag_index(flickcurl* fc);
+FLICKCURL_API
+void flickcurl_free_machinetag_index(flickcurl_machinetag_index* index);
+FLICKCURL_API
+int flickcurl_machinetag_index_add_photo(flickcurl_machinetag_index* index, flickcurl_photo* photo);
+FLICKCURL_API
+int flickcurl_machinetag_index_add_photos_list(flickcurl_machinetag_index* index, flickcurl_photos_list* photos_list);
+FLICKCURL_API
+flickcurl_tag_predicate_value** flickcurl_machinetag_index_query(flickcurl_machinetag_index* index, const char* machine_tag, int* count_p);
+FLICKCURL_API
+char** flickcurl_machinetag_index_get_photos(flickcurl_machinetag_index* index, const char* machine_tag, int* count_p);
+FLICKCURL_API
+flickcurl_tag_namespace** flickcurl_machinetag_index_get_namespaces(flickcurl_machinetag_index* index, const char* predicate, int* count_p);
+
 /* flickr.panda */
 FLICKCURL_API
 char** flickcurl_panda_getList(flickcurl* fc);
@@ -2031,6 +2440,8 @@ flickcurl_photo** flickcurl_photos_search(flickcurl* fc, flickcurl_search_params
 FLICKCURL_API
 flickcurl_photos_list* flickcurl_photos_search_params(flickcurl* fc, flickcurl_search_params* params, flickcurl_photos_list_params* list_params);
 FLICKCURL_API
+int flickcurl_photos_search_all(flickcurl* fc, flickcurl_search_params* params, const char* extras, int use_taken_dates, flickcurl_search_handler handler, void* user_data, int* truncated_count_p);
+FLICKCURL_API
 int flickcurl_photos_setContentType(flickcurl* fc, const char* photo_id, int content_type);
 FLICKCURL_API
 int flickcurl_photos_setDates(flickcurl* fc, const char* photo_id, int date_posted, int date_taken, int date_taken_granularity);
@@ -2043,6 +2454,12 @@ int flickcurl_photos_setSafetyLevel(flickcurl* fc, const char* photo_id, int saf
 FLICKCURL_API
 int flickcurl_photos_setTags(flickcurl* fc, const char* photo_id, const char* tags);
 
+/* batched flickr.photos.getInfo */
+FLICKCURL_API
+flickcurl_photo** flickcurl_photos_getInfo_batch(flickcurl* fc, const char** photo_ids, const char** owners, int count, const flickcurl_photo_field_type* fields);
+FLICKCURL_API
+void flickcurl_free_photos_batch(flickcurl_photo** photos, int count);
+
 /* flickr.photos.people */
 FLICKCURL_API
 int flickcurl_photos_people_add(flickcurl* fc, const char* photo_id, const char* user_id, int person_x, int person_y, int person_w, int person_h);
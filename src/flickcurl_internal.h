@@ -128,6 +128,7 @@ flickcurl_blog_service** flickcurl_build_blog_services(flickcurl* fc, xmlXPathCo
 /* collection.c */
 flickcurl_collection** flickcurl_build_collections(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* collection_count_p);
 flickcurl_collection* flickcurl_build_collection(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* root_xpathExpr);
+int flickcurl_collection_register_xpaths(void);
 
 
 /* common.c */
@@ -149,7 +150,9 @@ char* flickcurl_xpath_eval_to_tree_string(flickcurl* fc, xmlXPathContextPtr xpat
 
 char* flickcurl_call_get_one_string_field(flickcurl* fc, const char* key, const char* value, const char* method, const xmlChar* xpathExpr);
 
-int flickcurl_append_photos_list_params(flickcurl_photos_list_params* list_params, const char* parameters[][2], int* count_p, const char** format_p);
+int flickcurl_append_photos_list_params(flickcurl* fc, flickcurl_photos_list_params* list_params, const char* parameters[][2], int* count_p, const char** format_p);
+
+double flickcurl_get_handle_wire_bytes(CURL* handle);
 
 /* activity.c */
 flickcurl_activity** flickcurl_build_activities(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* activity_count_p);
@@ -166,6 +169,9 @@ flickcurl_contact** flickcurl_build_contacts(flickcurl* fc, xmlXPathContextPtr x
 /* context.c */
 flickcurl_context** flickcurl_build_contexts(flickcurl* fc, xmlDocPtr doc);
 
+/* datetime.c */
+time_t flickcurl_date_to_isotime(flickcurl* fc, const char* string, int is_unixtime, char* isotime);
+
 /* exif.c */
 flickcurl_exif** flickcurl_build_exifs(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* exif_count_p);
 
@@ -178,6 +184,13 @@ flickcurl_group** flickcurl_build_groups(flickcurl* fc, xmlXPathContextPtr xpath
 /* institution.c */
 flickcurl_institution** flickcurl_build_institutions(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* institution_count_p);
 flickcurl_institution* flickcurl_build_institution(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
+int flickcurl_institution_register_xpaths(void);
+
+/* intern.c */
+typedef struct flickcurl_intern_table_s flickcurl_intern_table;
+char* flickcurl_intern_string(flickcurl* fc, char* string, flickcurl_intern_table** table_p);
+void flickcurl_intern_release(flickcurl_intern_table* table, char* string);
+void flickcurl_intern_table_release(flickcurl_intern_table* table);
 
 /* location.c */
 flickcurl_location* flickcurl_build_location(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
@@ -198,6 +211,7 @@ flickcurl_member** flickcurl_build_members(flickcurl* fc,  xmlXPathContextPtr xp
 
 /* method.c */
 flickcurl_method* flickcurl_build_method(flickcurl* fc, xmlXPathContextPtr xpathCtx);
+int flickcurl_method_register_xpaths(void);
 
 /* note.c  */
 void flickcurl_free_note(flickcurl_note *note);
@@ -206,14 +220,47 @@ flickcurl_note** flickcurl_build_notes(flickcurl* fc, flickcurl_photo* photo, xm
 /* perms.c */
 flickcurl_perms* flickcurl_build_perms(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
 
+/* hedge.c */
+int flickcurl_hedged_perform(flickcurl* fc, long* status_p, char** data_p, size_t* len_p);
+struct flickcurl_method_latency_s* flickcurl_get_method_latency(flickcurl* fc, const char* method);
+void flickcurl_free_method_latencies(flickcurl* fc);
+
+/* metrics.c */
+void flickcurl_metrics_update(flickcurl* fc, long latency_usec, double wire_bytes);
+
+/* pacing.c */
+void flickcurl_pacing_update(flickcurl* fc, long latency_usec);
+
 /* person.c */
 flickcurl_person** flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* person_count_p);
 flickcurl_person* flickcurl_build_person(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* root_xpathExpr);
+int flickcurl_person_register_xpaths(void);
 
 /* photo.c */
 flickcurl_photo** flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* photo_count_p);
 flickcurl_photo* flickcurl_build_photo(flickcurl* fc, xmlXPathContextPtr xpathCtx);
 flickcurl_photos_list* flickcurl_invoke_photos_list(flickcurl* fc, const xmlChar* xpathExpr, const char* format);
+flickcurl_field_value_type flickcurl_get_photo_field_value_type(flickcurl_photo_field_type field);
+void flickcurl_photo_set_field_from_path(flickcurl* fc, flickcurl_photo* photo, const char* path, char* string_value);
+int flickcurl_photo_register_xpaths(void);
+
+/* photos-json.c */
+int flickcurl_build_photos_list_from_json(flickcurl* fc, flickcurl_photos_list* photos_list, const char* content, size_t content_length, const char* list_key);
+
+/* photo-binary.c */
+typedef struct {
+  unsigned char* data;
+  size_t len;
+  size_t size;
+  int failed;
+} flickcurl_binary_buffer;
+
+void flickcurl_binary_put_bytes(flickcurl_binary_buffer* buf, const void* bytes, size_t len);
+void flickcurl_binary_put_varint(flickcurl_binary_buffer* buf, unsigned int value);
+void flickcurl_binary_put_int(flickcurl_binary_buffer* buf, int value);
+void flickcurl_binary_put_double(flickcurl_binary_buffer* buf, double value);
+void flickcurl_binary_set_u32(unsigned char* p, unsigned int value);
+unsigned int flickcurl_binary_get_u32(const unsigned char* p);
 
 /* photoset.c */
 flickcurl_photoset** flickcurl_build_photosets(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* photoset_count_p);
@@ -223,10 +270,12 @@ flickcurl_photoset* flickcurl_build_photoset(flickcurl* fc, xmlXPathContextPtr x
 flickcurl_place** flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* place_count_p);
 flickcurl_place* flickcurl_build_place(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
 flickcurl_place_type_info** flickcurl_build_place_types(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* place_type_count_p);
+int flickcurl_place_register_xpaths(void);
 
 /* shape.c */
 flickcurl_shapedata** flickcurl_build_shapes(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* shape_count_p);
 flickcurl_shapedata* flickcurl_build_shape(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
+int flickcurl_shape_register_xpaths(void);
 
 /* size.c */
 flickcurl_size** flickcurl_build_sizes(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* size_count_p);
@@ -236,18 +285,30 @@ flickcurl_stat** flickcurl_build_stats(flickcurl* fc, xmlXPathContextPtr xpathCt
 
 /* tags.c  */
 flickcurl_tag** flickcurl_build_tags(flickcurl* fc, flickcurl_photo* photo, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* tag_count_p);
-flickcurl_tag** flickcurl_build_tags_from_string(flickcurl* fc, flickcurl_photo* photo, const char *string, int *tag_count_p);
+flickcurl_tag** flickcurl_build_tags_from_string(flickcurl* fc, flickcurl_photo* photo, const char *string, int machine_tag, int *tag_count_p);
 flickcurl_tag_clusters* flickcurl_build_tag_clusters(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
 
 /* ticket.c */
 flickcurl_ticket** flickcurl_build_tickets(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr, int* ticket_count_p);
 
+/* timing.c */
+long flickcurl_timing_elapsed(struct timeval* start);
+void flickcurl_timing_set_transfer(flickcurl* fc, CURL* handle);
+void flickcurl_timing_end_build(flickcurl* fc);
+void flickcurl_timing_flush(flickcurl* fc);
+
 /* vsnprintf.c */
 extern char* my_vsnprintf(const char *message, va_list arguments);
 
 /* video.c */
 flickcurl_video* flickcurl_build_video(flickcurl* fc, xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
 
+/* xpath.c */
+int flickcurl_xpath_init(void);
+void flickcurl_xpath_terminate(void);
+int flickcurl_xpath_register(const xmlChar* xpathExpr);
+xmlXPathObjectPtr flickcurl_xpath_evaluate(xmlXPathContextPtr xpathCtx, const xmlChar* xpathExpr);
+
 struct flickcurl_chunk_s {
   char* content;
   size_t size;
@@ -257,6 +318,70 @@ struct flickcurl_chunk_s {
 typedef struct flickcurl_chunk_s flickcurl_chunk;
 
 
+/* Most results flickr.photos.search returns for one query; later
+ * pages repeat earlier ones
+ */
+#define FLICKCURL_SEARCH_CEILING 4000
+
+
+#define FLICKCURL_METHOD_LATENCY_SAMPLES 64
+
+/* recent latencies of one API method */
+typedef struct flickcurl_method_latency_s {
+  char* method;
+  /* ring of the last @count latencies in usec; @index is the next slot */
+  long samples[FLICKCURL_METHOD_LATENCY_SAMPLES];
+  int count;
+  int index;
+  /* adaptive pacing latency moving average and baseline in usec */
+  double pacing_latency;
+  double pacing_base_latency;
+  int pacing_samples;
+  struct flickcurl_method_latency_s* next;
+} flickcurl_method_latency;
+
+
+#define FLICKCURL_DATE_CACHE_SIZE 64
+#define FLICKCURL_DATE_CACHE_KEY_SIZE 32
+
+/* a date field value and its conversions */
+typedef struct {
+  /* value from the web service or "" if unused */
+  char key[FLICKCURL_DATE_CACHE_KEY_SIZE];
+  int is_unixtime;
+  time_t unix_time;
+  char isotime[FLICKCURL_ISOTIME_SIZE];
+} flickcurl_date_cache_entry;
+
+
+#define FLICKCURL_METRICS_BUCKETS 256
+#define FLICKCURL_METRICS_CODES 16
+
+/* request metrics of one API method */
+typedef struct flickcurl_metrics_entry_s {
+  char* method;
+  int requests;
+  int errors;
+  double wire_bytes;
+  double decoded_bytes;
+  /* log-linear histogram of latencies in usec */
+  unsigned long buckets[FLICKCURL_METRICS_BUCKETS];
+  unsigned long latency_count;
+  double latency_sum;
+  long latency_max;
+  /* distinct codes seen; more are only counted in the _other fields */
+  flickcurl_metrics_count error_codes[FLICKCURL_METRICS_CODES];
+  int error_codes_count;
+  int error_codes_other;
+  flickcurl_metrics_count status_codes[FLICKCURL_METRICS_CODES];
+  int status_codes_count;
+  int status_codes_other;
+  /* total request delay wait in usec */
+  double delay_sum;
+  struct flickcurl_metrics_entry_s* next;
+} flickcurl_metrics_entry;
+
+
 struct flickcurl_s {
   int total_bytes;
 
@@ -294,8 +419,10 @@ struct flickcurl_s {
 
   char *http_accept;
 
-  /* XML parser */
+  /* XML parser - kept between requests with its name dictionary */
   xmlParserCtxtPtr xc;
+  /* non-0 when the next response must reset @xc */
+  int xc_reset;
 
   /* The next three fields need to be set before authenticated
    * operations can be done (in most cases).
@@ -368,6 +495,79 @@ struct flickcurl_s {
 
   flickcurl_curl_setopt_handler curl_setopt_handler;
   void* curl_setopt_handler_data;
+
+  /* if non-0, intern repeated strings - flickcurl_set_intern_strings() */
+  int intern_strings;
+  /* table of strings interned by this session or NULL */
+  flickcurl_intern_table* intern_table;
+
+  /* adaptive pacing - flickcurl_set_adaptive_pacing() */
+  int adaptive_pacing;
+  long pacing_min_delay;
+  long pacing_max_delay;
+  int pacing_max_concurrency;
+  /* current rate in requests per second */
+  double pacing_rate;
+  /* responses since the last decrease and healthy ones in this window */
+  int pacing_responses;
+  int pacing_acks;
+  int concurrency_limit;
+
+  /* read request hedging - flickcurl_set_hedging() */
+  int hedge_percentile;
+  int hedge_budget;
+  flickcurl_method_latency* method_latencies;
+  int hedge_requests;
+  int hedged_count;
+  int hedge_wins;
+
+  /* Accept-Encoding: "" for all supported or NULL for none -
+   * flickcurl_set_accept_encoding()
+   */
+  char* accept_encoding;
+
+  /* response body bytes over the wire and decoded for all requests */
+  double wire_bytes;
+  double decoded_bytes;
+
+  /* non-0 to request photos lists as JSON - flickcurl_set_json_mode() */
+  int json_mode;
+
+  /* request metrics per method - flickcurl_get_method_metrics() */
+  flickcurl_metrics_entry* metrics;
+
+  /* phases of the last request - flickcurl_get_request_timing() */
+  flickcurl_request_timing timing;
+  /* non-0 while the build phase of @timing is still running */
+  int timing_pending;
+  struct timeval timing_build_start;
+  flickcurl_timing_handler timing_handler;
+  void* timing_handler_data;
+
+  /* recent date conversions, created on first use */
+  flickcurl_date_cache_entry* date_cache;
+
+  /* if non-0, only build the photo fields in @photo_fields_mask and
+   * the #flickcurl_photo_part in @photo_parts - flickcurl_set_photo_fields()
+   */
+  int photo_fields_masked;
+  char photo_fields_mask[PHOTO_FIELD_LAST + 1];
+  int photo_parts;
+  /* extras needed for the masked fields or NULL */
+  char* photo_fields_extras;
+
+  /* non-0 to decode photo fields on access - flickcurl_set_lazy_photos() */
+  int lazy_photos;
+
+  /* stop reading the next response after @partial_count (or at the
+   * start of the first) @partial_element - flickcurl_set_partial_response()
+   */
+  char* partial_element;
+  int partial_count;
+  /* matching elements ended so far in this response */
+  int partial_seen;
+  /* non-0 when the response was stopped early */
+  int partial_done;
 };
 
 struct flickcurl_serializer_s
@@ -379,3 +579,223 @@ struct flickcurl_serializer_s
 
 void flickcurl_serializer_init(void);
 void flickcurl_serializer_terminate(void);
+
+struct flickcurl_photo_store_s
+{
+  flickcurl* fc;
+  unsigned char* data;
+  size_t length;
+  /* non-0 if @data is mmap()ed rather than malloc()ed */
+  int is_mapped;
+};
+
+/* A machine tag triple and the photos using it */
+typedef struct flickcurl_machinetag_index_triple_s {
+  char* nspace;
+  char* predicate;
+  char* value;
+  unsigned int hash;
+  /* posting list of photo numbers in the order added */
+  int* photos;
+  int photos_count;
+  int photos_size;
+  struct flickcurl_machinetag_index_triple_s* next;
+} flickcurl_machinetag_index_triple;
+
+struct flickcurl_machinetag_index_s
+{
+  flickcurl* fc;
+
+  /* distinct triples and a hash of them */
+  flickcurl_machinetag_index_triple** triples;
+  int triples_count;
+  int triples_size;
+  flickcurl_machinetag_index_triple** buckets;
+  unsigned int buckets_size;
+
+  /* photo IDs indexed by photo number and an open hash of them */
+  char** photos;
+  int photos_count;
+  int* photo_slots;
+  unsigned int photo_slots_size;
+};
+
+/* One column of a columnar export and its values for the pending row group */
+typedef struct {
+  char* name;
+  int type;
+  flickcurl_photo_field_type field;
+  /* place type for a place ID column otherwise -1 */
+  int place_type;
+
+  /* per row presence; per row tag counts in @ints for list columns */
+  char* present;
+
+  /* present values */
+  int* ints;
+  double* doubles;
+  char** strings;
+  int values_count;
+  int values_size;
+} flickcurl_column;
+
+struct flickcurl_column_writer_s
+{
+  flickcurl* fc;
+  FILE* fh;
+  /* bytes written to @fh */
+  size_t offset;
+
+  flickcurl_column* columns;
+  int columns_count;
+
+  int row_group_size;
+  /* rows in the pending row group */
+  int rows_count;
+
+  /* footer metadata for the row groups written so far */
+  flickcurl_binary_buffer row_groups;
+  int row_groups_count;
+
+  int failed;
+};
+
+struct flickcurl_sync_s
+{
+  flickcurl* fc;
+
+  /* account name: the section in @state_filename */
+  char* account;
+
+  char* state_filename;
+
+  /* last update time below which everything has been applied */
+  int watermark;
+
+  /* in-progress run state; @run_min_date is 0 when there is none */
+  int run_min_date;
+  int run_start;
+  int run_max;
+  int run_page;
+
+  /* photos applied by the last flickcurl_sync_run() */
+  int updated_count;
+};
+
+/* queued membership change of one photo; only the last one is kept */
+typedef struct {
+  char* photo_id;
+  unsigned int hash;
+  int add;
+} flickcurl_mutation_batch_op;
+
+/* a photoset, gallery or (for tags) photo with queued mutations */
+typedef struct flickcurl_mutation_batch_target_s {
+  int type;
+  char* id;
+
+  flickcurl_mutation_batch_op* ops;
+  int ops_count;
+  int ops_size;
+  /* open addressed hash of @ops by photo ID; slots hold index + 1 */
+  int* op_slots;
+  unsigned int op_slots_size;
+
+  /* space-separated tags to add for a photo target */
+  char* tags;
+
+  unsigned int hash;
+  /* next target in the same hash bucket */
+  struct flickcurl_mutation_batch_target_s* hash_next;
+  struct flickcurl_mutation_batch_target_s* next;
+} flickcurl_mutation_batch_target;
+
+struct flickcurl_mutation_batch_s
+{
+  flickcurl* fc;
+
+  /* flush thresholds: queued mutations and age in seconds */
+  int max_ops;
+  int max_age;
+
+  flickcurl_mutation_batch_target* targets;
+  /* hash of @targets by type and ID */
+  flickcurl_mutation_batch_target** target_buckets;
+  unsigned int target_buckets_size;
+  int targets_count;
+
+  /* mutations queued since the last flush and when the first was */
+  int ops_count;
+  time_t oldest_time;
+};
+
+/* a queued API call */
+typedef struct flickcurl_write_queue_entry_s {
+  /* journal sequence number */
+  int seq;
+
+  char* method;
+  char* (*parameters)[2];
+  int count;
+
+  int attempts;
+  /* not sent again before this time while backing off */
+  time_t next_attempt;
+
+  struct flickcurl_write_queue_entry_s* next;
+} flickcurl_write_queue_entry;
+
+struct flickcurl_write_queue_s
+{
+  flickcurl* fc;
+
+  char* journal_filename;
+  /* journal open for appending */
+  FILE* journal;
+
+  flickcurl_write_queue_entry* head;
+  flickcurl_write_queue_entry* tail;
+  int depth;
+  int next_seq;
+
+  int max_attempts;
+
+  /* metrics */
+  int completed_count;
+  int failed_count;
+  int retried_count;
+  double drain_seconds;
+};
+
+struct flickcurl_metrics_listener_s
+{
+  flickcurl* fc;
+
+  /* listening socket */
+  int fd;
+  int port;
+
+  int scrapes;
+};
+
+/* Response nodes retained by the lazy photos built from one response */
+typedef struct {
+  flickcurl* fc;
+  /* document holding the photo nodes; shares the response dictionary */
+  xmlDocPtr doc;
+  /* created on first decode */
+  xmlXPathContextPtr xpathCtx;
+  int usage;
+  /* session photo field mask when the photos were built */
+  int photo_fields_masked;
+  char photo_fields_mask[PHOTO_FIELD_LAST + 1];
+  int photo_parts;
+} flickcurl_photo_source;
+
+struct flickcurl_photo_lazy_s
+{
+  flickcurl_photo_source* source;
+  xmlNodePtr node;
+  /* bit per photo field set once it is decoded */
+  unsigned char decoded[(PHOTO_FIELD_LAST + 8) / 8];
+};
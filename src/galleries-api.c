@@ -99,6 +99,8 @@ flickcurl_galleries_addPhoto(flickcurl* fc, const char* gallery_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = NULL;
 
@@ -178,6 +180,8 @@ flickcurl_galleries_create(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     gallery_id = NULL;
 
@@ -238,6 +242,7 @@ flickcurl_galleries_editMeta(flickcurl* fc,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -295,6 +300,7 @@ flickcurl_galleries_editPhoto(flickcurl* fc, const char* gallery_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -356,6 +362,7 @@ flickcurl_galleries_editPhotos(flickcurl* fc, const char* gallery_id,
   result = 0;
   
   tidy:
+  flickcurl_timing_end_build(fc);
   if(photo_ids)
     free(photo_ids);
 
@@ -426,6 +433,8 @@ flickcurl_galleries_getInfo(flickcurl* fc, const char* gallery_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     gallery = NULL;
 
@@ -501,6 +510,8 @@ flickcurl_galleries_getList(flickcurl* fc, const char* user_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     galleries = NULL;
 
@@ -578,6 +589,8 @@ flickcurl_galleries_getListForPhoto(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     galleries = NULL;
 
@@ -617,7 +630,7 @@ flickcurl_galleries_getPhotos_params(flickcurl* fc, const char* gallery_id,
   parameters[count++][1]= gallery_id;
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -96,6 +96,8 @@ flickcurl_groups_browse(flickcurl* fc, int cat_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     category = NULL;
 
@@ -164,6 +166,8 @@ flickcurl_groups_getInfo(flickcurl* fc, const char* group_id, const char* lang)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     group = NULL;
 
@@ -232,6 +236,8 @@ flickcurl_groups_search(flickcurl* fc, const char* text, int per_page, int page)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     groups = NULL;
 
@@ -120,6 +120,8 @@ flickcurl_groups_members_getList(flickcurl* fc, const char* group_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     members = NULL;
 
@@ -86,6 +86,7 @@ flickcurl_groups_pools_add(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -136,6 +137,7 @@ flickcurl_groups_pools_getContext(flickcurl* fc, const char* photo_id,
   contexts = flickcurl_build_contexts(fc, doc);
 
  tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     contexts = NULL;
 
@@ -197,6 +199,8 @@ flickcurl_groups_pools_getGroups(flickcurl* fc, int page, int per_page)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     groups = NULL;
 
@@ -249,7 +253,7 @@ flickcurl_groups_pools_getPhotos_params(flickcurl* fc, const char* group_id,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
   
   parameters[count][0]  = NULL;
 
@@ -363,6 +367,7 @@ flickcurl_groups_pools_remove(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -0,0 +1,408 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * hedge.c - Flickcurl hedged read requests
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#include <sys/time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/* Latencies recorded for a method before it is hedged */
+#define HEDGE_MIN_SAMPLES 16
+
+/* Longest wait in select() so the hedge is sent close to its time */
+#define HEDGE_POLL_USEC 10000
+
+
+typedef struct {
+  char* data;
+  size_t len;
+  size_t size;
+} flickcurl_hedge_buffer;
+
+
+static size_t
+flickcurl_hedge_write_callback(void *ptr, size_t size, size_t nmemb,
+                               void *userdata)
+{
+  flickcurl_hedge_buffer* buffer = (flickcurl_hedge_buffer*)userdata;
+  size_t len = size * nmemb;
+
+  if(buffer->len + len > buffer->size) {
+    size_t new_size = buffer->size ? buffer->size << 1 : 4096;
+    char* new_data;
+
+    while(new_size < buffer->len + len)
+      new_size <<= 1;
+    new_data = (char*)realloc(buffer->data, new_size);
+    if(!new_data)
+      return 0;
+    buffer->data = new_data;
+    buffer->size = new_size;
+  }
+
+  memcpy(buffer->data + buffer->len, ptr, len);
+  buffer->len += len;
+
+  return len;
+}
+
+
+/* headers of the duplicate request are not used */
+static size_t
+flickcurl_hedge_header_callback(void *ptr, size_t size, size_t nmemb,
+                                void *userdata)
+{
+  return size * nmemb;
+}
+
+
+static long
+flickcurl_hedge_elapsed(struct timeval* start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000000L +
+         (now.tv_usec - start->tv_usec);
+}
+
+
+/*
+ * flickcurl_get_method_latency:
+ * @fc: flickcurl context
+ * @method: API method name
+ *
+ * INTERNAL - find or add the latency record of a method
+ *
+ * Return value: latency record or NULL on failure
+ */
+flickcurl_method_latency*
+flickcurl_get_method_latency(flickcurl* fc, const char* method)
+{
+  flickcurl_method_latency* ml;
+  size_t len;
+
+  for(ml = fc->method_latencies; ml; ml = ml->next) {
+    if(!strcmp(ml->method, method))
+      return ml;
+  }
+
+  ml = (flickcurl_method_latency*)calloc(1, sizeof(*ml));
+  if(!ml)
+    return NULL;
+  len = strlen(method);
+  ml->method = (char*)malloc(len + 1);
+  if(!ml->method) {
+    free(ml);
+    return NULL;
+  }
+  memcpy(ml->method, method, len + 1);
+
+  ml->next = fc->method_latencies;
+  fc->method_latencies = ml;
+
+  return ml;
+}
+
+
+static int
+flickcurl_hedge_compare_latency(const void *a, const void *b)
+{
+  long la = *(const long*)a;
+  long lb = *(const long*)b;
+
+  return (la > lb) - (la < lb);
+}
+
+
+/*
+ * flickcurl_hedge_delay:
+ * @fc: flickcurl context
+ * @ml: method latencies
+ *
+ * INTERNAL - get the time after which a request should be hedged
+ *
+ * Return value: delay in usec or <0 if the request must not be hedged
+ */
+static long
+flickcurl_hedge_delay(flickcurl* fc, flickcurl_method_latency* ml)
+{
+  long sorted[FLICKCURL_METHOD_LATENCY_SAMPLES];
+  int i;
+
+  if(!ml || ml->count < HEDGE_MIN_SAMPLES)
+    return -1;
+
+  /* the duplicate requests must stay within the budget */
+  if((fc->hedged_count + 1) * 100 > fc->hedge_budget * fc->hedge_requests)
+    return -1;
+
+  memcpy(sorted, ml->samples, ml->count * sizeof(long));
+  qsort(sorted, ml->count, sizeof(long), flickcurl_hedge_compare_latency);
+
+  i = (ml->count * fc->hedge_percentile) / 100;
+  if(i >= ml->count)
+    i = ml->count - 1;
+
+  return sorted[i];
+}
+
+
+/*
+ * flickcurl_hedged_perform:
+ * @fc: flickcurl context with a read request prepared on its handle
+ * @status_p: pointer to store HTTP status of the response used
+ * @data_p: pointer to store new response body (may be NULL if empty)
+ * @len_p: pointer to store length of response body
+ *
+ * INTERNAL - perform a read request, sending a duplicate if it is slow
+ *
+ * If no response arrives within the configured percentile of recent
+ * latencies for the method, a copy of the request is sent on a
+ * duplicate curl handle and whichever succeeds first is used.  The
+ * body is buffered and returned rather than passed to the write
+ * callback of @fc so a losing response never reaches the parser.
+ * The caller must restore the write callback of the handle.
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_hedged_perform(flickcurl* fc, long* status_p, char** data_p,
+                         size_t* len_p)
+{
+  CURLM* multi;
+  CURL* handles[2];
+  flickcurl_hedge_buffer buffers[2];
+  struct timeval starts[2];
+  int done[2];
+  CURLcode results[2];
+  flickcurl_method_latency* ml;
+  long delay;
+  int winner = -1;
+  int rc = 1;
+  int i;
+
+  *status_p = 0;
+  *data_p = NULL;
+  *len_p = 0;
+
+  multi = curl_multi_init();
+  if(!multi)
+    return 1;
+
+  memset(buffers, 0, sizeof(buffers));
+  handles[0] = fc->curl_handle;
+  handles[1] = NULL;
+  done[0] = done[1] = 0;
+  results[0] = results[1] = CURLE_OK;
+
+  ml = flickcurl_get_method_latency(fc, fc->method);
+  delay = flickcurl_hedge_delay(fc, ml);
+  fc->hedge_requests++;
+
+  curl_easy_setopt(handles[0], CURLOPT_WRITEFUNCTION,
+                   flickcurl_hedge_write_callback);
+  curl_easy_setopt(handles[0], CURLOPT_WRITEDATA, &buffers[0]);
+  gettimeofday(&starts[0], NULL);
+  curl_multi_add_handle(multi, handles[0]);
+
+  while(1) {
+    CURLMsg* msg;
+    int running;
+    int msgs;
+    fd_set read_fds;
+    fd_set write_fds;
+    fd_set except_fds;
+    int max_fd = -1;
+    struct timeval timeout;
+
+    while(curl_multi_perform(multi, &running) == CURLM_CALL_MULTI_PERFORM)
+      ;
+
+    while((msg = curl_multi_info_read(multi, &msgs))) {
+      if(msg->msg != CURLMSG_DONE)
+        continue;
+      i = (msg->easy_handle == handles[0]) ? 0 : 1;
+      done[i] = 1;
+      results[i] = msg->data.result;
+    }
+
+    /* first success wins; a failure only counts when nothing is left */
+    for(i = 0; i < 2; i++) {
+      if(done[i] && results[i] == CURLE_OK) {
+        winner = i;
+        break;
+      }
+    }
+    if(winner >= 0)
+      break;
+    if(done[0] && (!handles[1] || done[1])) {
+      winner = handles[1] ? 1 : 0;
+      break;
+    }
+
+    if(!handles[1] && delay >= 0 && !done[0] &&
+       flickcurl_hedge_elapsed(&starts[0]) >= delay) {
+      handles[1] = curl_easy_duphandle(handles[0]);
+      if(handles[1]) {
+        curl_easy_setopt(handles[1], CURLOPT_WRITEDATA, &buffers[1]);
+        curl_easy_setopt(handles[1], CURLOPT_HEADERFUNCTION,
+                         flickcurl_hedge_header_callback);
+        curl_easy_setopt(handles[1], CURLOPT_WRITEHEADER, NULL);
+        gettimeofday(&starts[1], NULL);
+        curl_multi_add_handle(multi, handles[1]);
+        fc->hedged_count++;
+        continue;
+      }
+      delay = -1;
+    }
+
+    FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
+    FD_ZERO(&except_fds);
+    curl_multi_fdset(multi, &read_fds, &write_fds, &except_fds, &max_fd);
+
+    timeout.tv_sec = 0;
+    timeout.tv_usec = HEDGE_POLL_USEC;
+    select(max_fd + 1, &read_fds, &write_fds, &except_fds, &timeout);
+  }
+
+  if(results[winner] == CURLE_OK) {
+    long latency = flickcurl_hedge_elapsed(&starts[winner]);
+
+    if(ml) {
+      ml->samples[ml->index] = latency;
+      ml->index = (ml->index + 1) % FLICKCURL_METHOD_LATENCY_SAMPLES;
+      if(ml->count < FLICKCURL_METHOD_LATENCY_SAMPLES)
+        ml->count++;
+    }
+    if(winner == 1)
+      fc->hedge_wins++;
+
+    curl_easy_getinfo(handles[winner], CURLINFO_RESPONSE_CODE, status_p);
+    fc->wire_bytes += flickcurl_get_handle_wire_bytes(handles[winner]);
+    *data_p = buffers[winner].data;
+    *len_p = buffers[winner].len;
+    buffers[winner].data = NULL;
+    rc = 0;
+  }
+
+  for(i = 0; i < 2; i++) {
+    if(handles[i])
+      curl_multi_remove_handle(multi, handles[i]);
+    if(buffers[i].data)
+      free(buffers[i].data);
+  }
+  if(handles[1])
+    curl_easy_cleanup(handles[1]);
+  curl_multi_cleanup(multi);
+
+  return rc;
+}
+
+
+/*
+ * flickcurl_free_method_latencies:
+ * @fc: flickcurl context
+ *
+ * INTERNAL - free the per-method latency records
+ */
+void
+flickcurl_free_method_latencies(flickcurl* fc)
+{
+  while(fc->method_latencies) {
+    flickcurl_method_latency* next = fc->method_latencies->next;
+
+    free(fc->method_latencies->method);
+    free(fc->method_latencies);
+    fc->method_latencies = next;
+  }
+}
+
+
+/**
+ * flickcurl_set_hedging:
+ * @fc: flickcurl object
+ * @percentile: latency percentile after which a read is hedged (or 0 to turn off hedging)
+ * @budget_percent: most duplicate requests to send as a percentage of reads
+ *
+ * Set hedging of read-only web service requests
+ *
+ * When enabled, the latencies of the last few read calls of each
+ * method are recorded.  Once a method has enough history, a request
+ * that has had no response after @percentile of those latencies is
+ * sent again on a second connection and whichever response arrives
+ * first is used.  This trades a little extra load, capped at
+ * @budget_percent of read requests, for a shorter latency tail.
+ *
+ * Writes and uploads are never hedged.
+ */
+void
+flickcurl_set_hedging(flickcurl* fc, int percentile, int budget_percent)
+{
+  if(percentile < 0)
+    percentile = 0;
+  if(percentile > 100)
+    percentile = 100;
+  if(budget_percent < 0)
+    budget_percent = 0;
+
+  fc->hedge_percentile = percentile;
+  fc->hedge_budget = budget_percent;
+}
+
+
+/**
+ * flickcurl_get_hedge_stats:
+ * @fc: flickcurl object
+ * @requests_p: pointer to store number of read requests while hedging (or NULL)
+ * @hedged_p: pointer to store number of duplicate requests sent (or NULL)
+ * @wins_p: pointer to store number of duplicates that answered first (or NULL)
+ *
+ * Get request hedging counts
+ */
+void
+flickcurl_get_hedge_stats(flickcurl* fc, int* requests_p, int* hedged_p,
+                          int* wins_p)
+{
+  if(requests_p)
+    *requests_p = fc->hedge_requests;
+  if(hedged_p)
+    *hedged_p = fc->hedged_count;
+  if(wins_p)
+    *wins_p = fc->hedge_wins;
+}
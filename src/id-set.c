@@ -0,0 +1,691 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * id-set.c - Flickcurl compact sets of numeric IDs
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/* Smallest number of IDs added before they are sorted into the
+ * chunks; larger sets buffer a quarter of their size so each ID is
+ * only merged a few times as the set grows
+ */
+#define ID_SET_PENDING_SIZE 65536
+
+
+/*
+ * IDs are split on their upper 32 bits.  Flickr IDs are sparse
+ * (millions spread over tens of billions) so each chunk is a sorted
+ * array of the lower 32 bits: 4 bytes an ID rather than 8 plus a heap
+ * string.
+ */
+typedef struct {
+  long long high;
+  unsigned int* lows;
+  int count;
+} flickcurl_id_chunk;
+
+
+struct flickcurl_id_set_s {
+  /* chunks sorted by high */
+  flickcurl_id_chunk* chunks;
+  int chunks_count;
+  int chunks_size;
+
+  /* number of IDs in the chunks */
+  int count;
+
+  /* IDs added but not yet in the chunks, unsorted */
+  long long* pending;
+  int pending_count;
+  int pending_size;
+};
+
+
+#define ID_HIGH(id) ((id) >> 32)
+#define ID_LOW(id) ((unsigned int)((id) & 0xffffffffLL))
+
+
+/**
+ * flickcurl_id_to_number:
+ * @id: ID string
+ *
+ * Get the numeric value of a photo, photoset or other all-digit ID
+ *
+ * Return value: ID number or 0 if @id is NULL, not all digits or too large
+ **/
+long long
+flickcurl_id_to_number(const char* id)
+{
+  long long value = 0;
+
+  if(!id || !*id)
+    return 0;
+
+  for(; *id; id++) {
+    if(*id < '0' || *id > '9')
+      return 0;
+    /* keep clear of the sign bit */
+    if(value > (0x7fffffffffffffffLL - 9) / 10)
+      return 0;
+    value = value * 10 + (*id - '0');
+  }
+
+  return value;
+}
+
+
+/**
+ * flickcurl_new_id_set:
+ *
+ * Constructor - create a new empty set of numeric IDs
+ *
+ * The set holds positive 64 bit IDs such as those returned by
+ * flickcurl_photo_get_id_number() using about 4 bytes per ID.  IDs
+ * are buffered when added and sorted in bulk, so adding many IDs
+ * before querying the set is much faster than interleaving the two.
+ *
+ * Return value: new ID set or NULL on failure
+ **/
+flickcurl_id_set*
+flickcurl_new_id_set(void)
+{
+  return (flickcurl_id_set*)calloc(1, sizeof(flickcurl_id_set));
+}
+
+
+/**
+ * flickcurl_free_id_set:
+ * @set: ID set
+ *
+ * Destructor - free an ID set
+ */
+void
+flickcurl_free_id_set(flickcurl_id_set* set)
+{
+  int i;
+
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(set, flickcurl_id_set);
+
+  for(i = 0; i < set->chunks_count; i++)
+    free(set->chunks[i].lows);
+  if(set->chunks)
+    free(set->chunks);
+  if(set->pending)
+    free(set->pending);
+
+  free(set);
+}
+
+
+/* find the chunk for @high or where it would be inserted */
+static int
+flickcurl_id_set_find_chunk(flickcurl_id_set* set, long long high, int* found_p)
+{
+  int lo = 0;
+  int hi = set->chunks_count;
+
+  while(lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+
+    if(set->chunks[mid].high < high)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  *found_p = (lo < set->chunks_count && set->chunks[lo].high == high);
+  return lo;
+}
+
+
+static flickcurl_id_chunk*
+flickcurl_id_set_insert_chunk(flickcurl_id_set* set, int index, long long high)
+{
+  flickcurl_id_chunk* chunk;
+
+  if(set->chunks_count == set->chunks_size) {
+    int new_size = set->chunks_size ? set->chunks_size << 1 : 8;
+    flickcurl_id_chunk* new_chunks;
+
+    new_chunks = (flickcurl_id_chunk*)realloc(set->chunks,
+                                              new_size * sizeof(*new_chunks));
+    if(!new_chunks)
+      return NULL;
+    set->chunks = new_chunks;
+    set->chunks_size = new_size;
+  }
+
+  memmove(&set->chunks[index + 1], &set->chunks[index],
+          (set->chunks_count - index) * sizeof(*set->chunks));
+  set->chunks_count++;
+
+  chunk = &set->chunks[index];
+  chunk->high = high;
+  chunk->lows = NULL;
+  chunk->count = 0;
+
+  return chunk;
+}
+
+
+static void
+flickcurl_id_set_remove_chunk(flickcurl_id_set* set, int index)
+{
+  free(set->chunks[index].lows);
+  set->chunks_count--;
+  memmove(&set->chunks[index], &set->chunks[index + 1],
+          (set->chunks_count - index) * sizeof(*set->chunks));
+}
+
+
+/*
+ * flickcurl_id_chunk_merge:
+ * @chunk: chunk
+ * @lows: sorted unique lower ID parts
+ * @count: size of @lows
+ *
+ * INTERNAL - add sorted IDs to a chunk
+ *
+ * The chunk is grown and merged into from the tail so the existing
+ * IDs are not copied to a new array.
+ *
+ * Return value: number of IDs added or <0 on failure
+ */
+static int
+flickcurl_id_chunk_merge(flickcurl_id_chunk* chunk, const unsigned int* lows,
+                         int count)
+{
+  unsigned int* merged;
+  int total = chunk->count + count;
+  int i = chunk->count - 1;
+  int j = count - 1;
+  int n = total;
+
+  merged = (unsigned int*)realloc(chunk->lows, total * sizeof(*merged));
+  if(!merged)
+    return -1;
+  chunk->lows = merged;
+
+  /* the write position stays above every unread chunk ID */
+  while(j >= 0) {
+    if(i >= 0 && merged[i] > lows[j])
+      merged[--n] = merged[i--];
+    else {
+      if(i >= 0 && merged[i] == lows[j])
+        i--;
+      merged[--n] = lows[j--];
+    }
+  }
+
+  /* close the gap left by IDs already in the chunk */
+  if(n > i + 1)
+    memmove(merged + i + 1, merged + n, (total - n) * sizeof(*merged));
+
+  n = i + 1 + (total - n);
+  count = n - chunk->count;
+  chunk->count = n;
+
+  return count;
+}
+
+
+static int
+flickcurl_id_compare(const void* a, const void* b)
+{
+  long long id_a = *(const long long*)a;
+  long long id_b = *(const long long*)b;
+
+  return (id_a > id_b) - (id_a < id_b);
+}
+
+
+/*
+ * flickcurl_id_set_flush:
+ * @set: ID set
+ *
+ * INTERNAL - sort the pending IDs into the chunks
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_id_set_flush(flickcurl_id_set* set)
+{
+  unsigned int* lows;
+  int i;
+  int rc = 0;
+
+  if(!set->pending_count)
+    return 0;
+
+  qsort(set->pending, set->pending_count, sizeof(long long),
+        flickcurl_id_compare);
+
+  lows = (unsigned int*)malloc(set->pending_count * sizeof(*lows));
+  if(!lows)
+    return 1;
+
+  for(i = 0; i < set->pending_count && !rc; ) {
+    long long high = ID_HIGH(set->pending[i]);
+    flickcurl_id_chunk* chunk;
+    int lows_count = 0;
+    int index;
+    int found;
+    int added;
+
+    for(; i < set->pending_count && ID_HIGH(set->pending[i]) == high; i++) {
+      unsigned int low = ID_LOW(set->pending[i]);
+
+      if(!lows_count || lows[lows_count - 1] != low)
+        lows[lows_count++] = low;
+    }
+
+    index = flickcurl_id_set_find_chunk(set, high, &found);
+    chunk = found ? &set->chunks[index] :
+                    flickcurl_id_set_insert_chunk(set, index, high);
+    added = chunk ? flickcurl_id_chunk_merge(chunk, lows, lows_count) : -1;
+    if(added < 0)
+      rc = 1;
+    else
+      set->count += added;
+  }
+
+  free(lows);
+
+  /* IDs not sorted in on failure are lost */
+  set->pending_count = 0;
+
+  return rc;
+}
+
+
+/**
+ * flickcurl_id_set_add:
+ * @set: ID set
+ * @id: ID (> 0)
+ *
+ * Add an ID to a set
+ *
+ * Adding an ID already in the set does nothing.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_id_set_add(flickcurl_id_set* set, long long id)
+{
+  if(id <= 0)
+    return 1;
+
+  if(set->pending_count == set->pending_size) {
+    int new_size = set->count / 4;
+
+    if(new_size < ID_SET_PENDING_SIZE)
+      new_size = ID_SET_PENDING_SIZE;
+
+    if(set->pending_size < new_size) {
+      long long* new_pending;
+
+      /* grow with the set so a flush merges proportionally more IDs */
+      new_pending = (long long*)realloc(set->pending,
+                                        new_size * sizeof(long long));
+      if(!new_pending)
+        return 1;
+      set->pending = new_pending;
+      set->pending_size = new_size;
+    } else if(flickcurl_id_set_flush(set))
+      return 1;
+  }
+
+  set->pending[set->pending_count++] = id;
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_id_set_add_photos:
+ * @set: ID set
+ * @photos: NULL terminated array of photos
+ *
+ * Add the IDs of an array of photos to a set
+ *
+ * Photos without a numeric ID are skipped.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_id_set_add_photos(flickcurl_id_set* set, flickcurl_photo** photos)
+{
+  int i;
+
+  for(i = 0; photos[i]; i++) {
+    long long id = flickcurl_photo_get_id_number(photos[i]);
+
+    if(id && flickcurl_id_set_add(set, id))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_id_set_add_photos_list:
+ * @set: ID set
+ * @photos_list: photos list
+ *
+ * Add the IDs of the photos in a photos list to a set
+ *
+ * Photos without a numeric ID are skipped.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_id_set_add_photos_list(flickcurl_id_set* set,
+                                 flickcurl_photos_list* photos_list)
+{
+  if(!photos_list->photos)
+    return 0;
+
+  return flickcurl_id_set_add_photos(set, photos_list->photos);
+}
+
+
+/**
+ * flickcurl_id_set_photo_handler:
+ * @user_data: #flickcurl_id_set to add to
+ * @photo: photo
+ *
+ * Photo handler adding the photo ID to a set
+ *
+ * This may be passed with an ID set as the user data to
+ * flickcurl_photos_search_all() or flickcurl_sync_run() to collect
+ * the IDs of the photos they find.
+ *
+ * Return value: non-0 on failure, which stops the caller
+ **/
+int
+flickcurl_id_set_photo_handler(void* user_data, flickcurl_photo* photo)
+{
+  flickcurl_id_set* set = (flickcurl_id_set*)user_data;
+  long long id = flickcurl_photo_get_id_number(photo);
+
+  if(!id)
+    return 0;
+
+  return flickcurl_id_set_add(set, id);
+}
+
+
+/**
+ * flickcurl_id_set_contains:
+ * @set: ID set
+ * @id: ID
+ *
+ * Check if an ID is in a set
+ *
+ * Return value: non-0 if @id is in @set
+ **/
+int
+flickcurl_id_set_contains(flickcurl_id_set* set, long long id)
+{
+  flickcurl_id_chunk* chunk;
+  unsigned int low = ID_LOW(id);
+  int index;
+  int found;
+  int lo;
+  int hi;
+
+  if(flickcurl_id_set_flush(set))
+    return 0;
+
+  index = flickcurl_id_set_find_chunk(set, ID_HIGH(id), &found);
+  if(!found)
+    return 0;
+
+  chunk = &set->chunks[index];
+  lo = 0;
+  hi = chunk->count;
+  while(lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+
+    if(chunk->lows[mid] < low)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return (lo < chunk->count && chunk->lows[lo] == low);
+}
+
+
+/**
+ * flickcurl_id_set_get_count:
+ * @set: ID set
+ *
+ * Get the number of IDs in a set
+ *
+ * Return value: number of IDs or <0 on failure
+ **/
+int
+flickcurl_id_set_get_count(flickcurl_id_set* set)
+{
+  if(flickcurl_id_set_flush(set))
+    return -1;
+
+  return set->count;
+}
+
+
+/**
+ * flickcurl_id_set_get_ids:
+ * @set: ID set
+ * @count_p: pointer to store number of IDs (or NULL)
+ *
+ * Get the IDs in a set in ascending order
+ *
+ * Return value: new array of IDs or NULL on failure or if @set is empty
+ **/
+long long*
+flickcurl_id_set_get_ids(flickcurl_id_set* set, int* count_p)
+{
+  long long* ids;
+  int i;
+  int n = 0;
+
+  if(count_p)
+    *count_p = 0;
+
+  if(flickcurl_id_set_flush(set) || !set->count)
+    return NULL;
+
+  ids = (long long*)malloc(set->count * sizeof(long long));
+  if(!ids)
+    return NULL;
+
+  for(i = 0; i < set->chunks_count; i++) {
+    flickcurl_id_chunk* chunk = &set->chunks[i];
+    long long high = chunk->high << 32;
+    int j;
+
+    for(j = 0; j < chunk->count; j++)
+      ids[n++] = high | (long long)chunk->lows[j];
+  }
+
+  if(count_p)
+    *count_p = n;
+
+  return ids;
+}
+
+
+/**
+ * flickcurl_id_set_union:
+ * @set: ID set to change
+ * @other: ID set
+ *
+ * Add the IDs in one set to another
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_id_set_union(flickcurl_id_set* set, flickcurl_id_set* other)
+{
+  int i;
+
+  if(flickcurl_id_set_flush(set) || flickcurl_id_set_flush(other))
+    return 1;
+
+  for(i = 0; i < other->chunks_count; i++) {
+    flickcurl_id_chunk* other_chunk = &other->chunks[i];
+    flickcurl_id_chunk* chunk;
+    int index;
+    int found;
+    int added;
+
+    index = flickcurl_id_set_find_chunk(set, other_chunk->high, &found);
+    chunk = found ? &set->chunks[index] :
+                    flickcurl_id_set_insert_chunk(set, index,
+                                                  other_chunk->high);
+    if(!chunk)
+      return 1;
+
+    added = flickcurl_id_chunk_merge(chunk, other_chunk->lows,
+                                     other_chunk->count);
+    if(added < 0)
+      return 1;
+    set->count += added;
+  }
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_id_set_filter:
+ * @set: ID set to change
+ * @other: ID set
+ * @keep_common: non-0 to keep the IDs also in @other, 0 to remove them
+ *
+ * INTERNAL - intersect or subtract one set from another in place
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_id_set_filter(flickcurl_id_set* set, flickcurl_id_set* other,
+                        int keep_common)
+{
+  int i;
+
+  if(flickcurl_id_set_flush(set) || flickcurl_id_set_flush(other))
+    return 1;
+
+  for(i = 0; i < set->chunks_count; ) {
+    flickcurl_id_chunk* chunk = &set->chunks[i];
+    flickcurl_id_chunk* other_chunk = NULL;
+    int index;
+    int found;
+    int j;
+    int k = 0;
+    int n = 0;
+
+    index = flickcurl_id_set_find_chunk(other, chunk->high, &found);
+    if(found)
+      other_chunk = &other->chunks[index];
+
+    if(!other_chunk && !keep_common) {
+      i++;
+      continue;
+    }
+
+    /* both arrays are sorted so one pass finds the common IDs */
+    for(j = 0; j < chunk->count; j++) {
+      unsigned int low = chunk->lows[j];
+      int common = 0;
+
+      if(other_chunk) {
+        while(k < other_chunk->count && other_chunk->lows[k] < low)
+          k++;
+        common = (k < other_chunk->count && other_chunk->lows[k] == low);
+      }
+
+      if(common == (keep_common != 0))
+        chunk->lows[n++] = low;
+    }
+
+    set->count -= chunk->count - n;
+    chunk->count = n;
+
+    if(!n)
+      flickcurl_id_set_remove_chunk(set, i);
+    else
+      i++;
+  }
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_id_set_intersect:
+ * @set: ID set to change
+ * @other: ID set
+ *
+ * Remove the IDs from a set that are not in another
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_id_set_intersect(flickcurl_id_set* set, flickcurl_id_set* other)
+{
+  return flickcurl_id_set_filter(set, other, 1);
+}
+
+
+/**
+ * flickcurl_id_set_difference:
+ * @set: ID set to change
+ * @other: ID set
+ *
+ * Remove the IDs from a set that are in another
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_id_set_difference(flickcurl_id_set* set, flickcurl_id_set* other)
+{
+  return flickcurl_id_set_filter(set, other, 0);
+}
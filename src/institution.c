@@ -160,6 +160,27 @@ static struct {
 };
 
 
+/*
+ * flickcurl_institution_register_xpaths:
+ *
+ * INTERNAL - compile the institution field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_institution_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; institution_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(institution_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
 
 /* get shapedata from value */
 flickcurl_institution**
@@ -172,9 +193,10 @@ flickcurl_build_institutions(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   int institution_count;
   xmlXPathObjectPtr xpathObj = NULL;
   xmlNodeSetPtr nodes;
+  xmlXPathContextPtr xpathNodeCtx = NULL;
   int i;
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -187,10 +209,17 @@ flickcurl_build_institutions(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   nodes_count = xmlXPathNodeSetGetLength(nodes);
   institutions = (flickcurl_institution**)calloc(sizeof(flickcurl_institution*), nodes_count+1);
 
+  /* one XPath context is moved to each node in turn */
+  xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
+  if(!xpathNodeCtx) {
+    flickcurl_error(fc, "Failed to create XPath context for document");
+    fc->failed = 1;
+    goto tidy;
+  }
+
   for(i = 0, institution_count = 0; i < nodes_count; i++) {
     xmlNodePtr node = nodes->nodeTab[i];
     int expri;
-    xmlXPathContextPtr xpathNodeCtx = NULL;
     flickcurl_institution* institution;
     
     if(node->type != XML_ELEMENT_NODE) {
@@ -203,8 +232,6 @@ flickcurl_build_institutions(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     institution->urls = (char**)calloc(FLICKCURL_INSTITUTION_URL_LAST+1,
                                        sizeof(char*));
 
-    /* set up a new XPath context relative to the current node */
-    xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
     xpathNodeCtx->node = node;
 
     for(expri = 0; expri <= FLICKCURL_INSTITUTION_URL_LAST; expri++) {
@@ -254,8 +281,6 @@ flickcurl_build_institutions(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     } /* end for institution fields */
 
    institutionstidy:
-    if(xpathNodeCtx)
-      xmlXPathFreeContext(xpathNodeCtx);
 
     institutions[institution_count++] = institution;
   } /* for institutions */
@@ -264,6 +289,8 @@ flickcurl_build_institutions(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     *institution_count_p = institution_count;
   
  tidy:
+  if(xpathNodeCtx)
+    xmlXPathFreeContext(xpathNodeCtx);
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
   
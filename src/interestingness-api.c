@@ -71,7 +71,7 @@ flickcurl_interestingness_getList_params(flickcurl* fc, const char* date,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
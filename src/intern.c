@@ -0,0 +1,301 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * intern.c - Flickcurl shared string interning
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * Interned strings are ordinary malloc()ed strings that are also
+ * recorded in a reference counted table owned by the session that
+ * interned them.  An object that holds interned strings records the
+ * table and holds a reference to it, so the table outlives the session
+ * until the last such object is freed.  Objects built by sessions that
+ * never intern have no table and their strings are freed directly.
+ */
+
+typedef struct flickcurl_intern_entry_s {
+  char* string;
+  unsigned int hash;
+  int usage;
+  struct flickcurl_intern_entry_s* next;
+} flickcurl_intern_entry;
+
+
+struct flickcurl_intern_table_s {
+  flickcurl_intern_entry** buckets;
+  unsigned int size;
+  unsigned int count;
+  /* session plus objects holding strings from the table */
+  int usage;
+};
+
+
+#define INTERN_INITIAL_SIZE 1024
+
+
+static unsigned int
+flickcurl_intern_hash(const char* string)
+{
+  unsigned int hash = 5381;
+
+  while(*string)
+    hash = (hash * 33) ^ (unsigned char)*string++;
+
+  return hash;
+}
+
+
+static int
+flickcurl_intern_grow(flickcurl_intern_table* table)
+{
+  unsigned int new_size = table->size ? table->size << 1 :
+    INTERN_INITIAL_SIZE;
+  flickcurl_intern_entry** new_buckets;
+  unsigned int i;
+
+  new_buckets = (flickcurl_intern_entry**)calloc(new_size,
+                                                 sizeof(flickcurl_intern_entry*));
+  if(!new_buckets)
+    return 1;
+
+  for(i = 0; i < table->size; i++) {
+    flickcurl_intern_entry* entry = table->buckets[i];
+
+    while(entry) {
+      flickcurl_intern_entry* next = entry->next;
+      unsigned int bucket = entry->hash & (new_size - 1);
+
+      entry->next = new_buckets[bucket];
+      new_buckets[bucket] = entry;
+      entry = next;
+    }
+  }
+
+  if(table->buckets)
+    free(table->buckets);
+  table->buckets = new_buckets;
+  table->size = new_size;
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_intern_string:
+ * @fc: flickcurl context
+ * @string: malloc()ed string or NULL
+ * @table_p: pointer to the owning object's intern table field
+ *
+ * INTERNAL - intern a string if the session has interning enabled
+ *
+ * Takes ownership of @string.  If an equal string is already interned
+ * @string is freed and the shared copy returned with its usage
+ * increased.  When a string is interned and *@table_p is NULL, it is
+ * set to the session table and a reference to the table is taken,
+ * released by flickcurl_intern_table_release() in the object destructor.
+ *
+ * Return value: @string or an equal shared string
+ */
+char*
+flickcurl_intern_string(flickcurl* fc, char* string,
+                        flickcurl_intern_table** table_p)
+{
+  flickcurl_intern_table* table;
+  flickcurl_intern_entry* entry;
+  unsigned int hash;
+  unsigned int bucket;
+
+  if(!string || !fc->intern_strings)
+    return string;
+
+  table = fc->intern_table;
+  if(!table) {
+    table = (flickcurl_intern_table*)calloc(1, sizeof(*table));
+    if(!table)
+      return string;
+    table->usage = 1;
+    fc->intern_table = table;
+  }
+
+  /* an object only ever holds strings from one session's table */
+  if(*table_p && *table_p != table)
+    return string;
+
+  if(table->count >= table->size && flickcurl_intern_grow(table))
+    return string;
+
+  hash = flickcurl_intern_hash(string);
+  bucket = hash & (table->size - 1);
+
+  for(entry = table->buckets[bucket]; entry; entry = entry->next) {
+    if(entry->hash == hash && !strcmp(entry->string, string)) {
+      entry->usage++;
+      free(string);
+      string = entry->string;
+      goto interned;
+    }
+  }
+
+  entry = (flickcurl_intern_entry*)malloc(sizeof(*entry));
+  if(!entry)
+    return string;
+
+  entry->string = string;
+  entry->hash = hash;
+  entry->usage = 1;
+  entry->next = table->buckets[bucket];
+  table->buckets[bucket] = entry;
+  table->count++;
+
+  interned:
+  if(!*table_p) {
+    *table_p = table;
+    table->usage++;
+  }
+
+  return string;
+}
+
+
+/*
+ * flickcurl_intern_release:
+ * @table: intern table of the object holding @string or NULL
+ * @string: string or NULL
+ *
+ * INTERNAL - release a string that may have been interned
+ *
+ * Interned strings are freed when their last user releases them;
+ * other strings, and all strings of objects with no table, are freed
+ * immediately.
+ */
+void
+flickcurl_intern_release(flickcurl_intern_table* table, char* string)
+{
+  flickcurl_intern_entry* entry;
+  flickcurl_intern_entry* prev = NULL;
+  unsigned int bucket;
+
+  if(!string)
+    return;
+
+  if(!table || !table->count) {
+    free(string);
+    return;
+  }
+
+  bucket = flickcurl_intern_hash(string) & (table->size - 1);
+  for(entry = table->buckets[bucket]; entry;
+      prev = entry, entry = entry->next) {
+    /* pointer compare: an equal string may be a private copy */
+    if(entry->string != string)
+      continue;
+
+    if(--entry->usage)
+      return;
+
+    if(prev)
+      prev->next = entry->next;
+    else
+      table->buckets[bucket] = entry->next;
+    free(entry);
+    table->count--;
+    break;
+  }
+
+  free(string);
+}
+
+
+/*
+ * flickcurl_intern_table_release:
+ * @table: intern table or NULL
+ *
+ * INTERNAL - release a reference to an intern table held by a session or object
+ *
+ * The table is freed with its last reference.
+ */
+void
+flickcurl_intern_table_release(flickcurl_intern_table* table)
+{
+  unsigned int i;
+
+  if(!table || --table->usage)
+    return;
+
+  for(i = 0; i < table->size; i++) {
+    flickcurl_intern_entry* entry = table->buckets[i];
+
+    while(entry) {
+      flickcurl_intern_entry* next = entry->next;
+
+      free(entry->string);
+      free(entry);
+      entry = next;
+    }
+  }
+
+  if(table->buckets)
+    free(table->buckets);
+  free(table);
+}
+
+
+/**
+ * flickcurl_set_intern_strings:
+ * @fc: flickcurl object
+ * @intern_strings: non-0 to intern strings
+ *
+ * Set whether strings that repeat across objects are shared
+ *
+ * When enabled, tag raw and cooked text and authors, place names,
+ * IDs and URLs and person and photo owner names built by this session
+ * are interned in a reference counted table owned by the session.
+ * Equal interned strings from the same session are the same pointer,
+ * so such tags can be compared with ==.
+ *
+ * Interned strings must be treated as read-only and objects holding
+ * them must be freed with the flickcurl destructors.  The table is
+ * not locked, so objects built by an interning session must only be
+ * freed by the thread using that session, though they may outlive
+ * it.  Sessions that do not intern are unaffected.
+ */
+void
+flickcurl_set_intern_strings(flickcurl* fc, int intern_strings)
+{
+  fc->intern_strings = intern_strings;
+}
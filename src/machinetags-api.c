@@ -103,6 +103,8 @@ flickcurl_machinetags_getNamespaces(flickcurl* fc, const char* predicate,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tag_namespaces = NULL;
 
@@ -179,6 +181,8 @@ flickcurl_machinetags_getPairs(flickcurl* fc, const char *nspace,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tag_pvs = NULL;
 
@@ -252,6 +256,8 @@ flickcurl_machinetags_getPredicates(flickcurl* fc, const char *nspace,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tag_pvs = NULL;
 
@@ -331,6 +337,8 @@ flickcurl_machinetags_getValues(flickcurl* fc, const char *nspace,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tag_pvs = NULL;
 
@@ -407,6 +415,8 @@ flickcurl_machinetags_getRecentValues(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tag_pvs = NULL;
 
@@ -0,0 +1,832 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * machinetags-index.c - Flickcurl local machine tags index
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+#define MTINDEX_INITIAL_SIZE 256
+
+
+static unsigned int
+flickcurl_mtindex_hash(const char* string, unsigned int hash)
+{
+  while(*string)
+    hash = (hash * 33) ^ (unsigned char)*string++;
+
+  return hash;
+}
+
+
+static unsigned int
+flickcurl_mtindex_triple_hash(const char* nspace, const char* predicate,
+                              const char* value)
+{
+  unsigned int hash = 5381;
+
+  hash = flickcurl_mtindex_hash(nspace, hash) * 33;
+  hash = flickcurl_mtindex_hash(predicate, hash) * 33;
+  return flickcurl_mtindex_hash(value, hash);
+}
+
+
+/*
+ * flickcurl_mtindex_parse:
+ * @string: machine tag "namespace:predicate=value"
+ * @allow_wildcards: non-0 to allow "*" parts and a missing value
+ * @nspace_p: pointer to store new namespace
+ * @predicate_p: pointer to store new predicate
+ * @value_p: pointer to store new value
+ *
+ * INTERNAL - split a machine tag into its parts
+ *
+ * The namespace and predicate are lowercased as Flickr compares them
+ * case-insensitively; a quoted value has the quotes removed.
+ *
+ * Return value: non-0 if @string is not a machine tag
+ */
+static int
+flickcurl_mtindex_parse(const char* string, int allow_wildcards,
+                        char** nspace_p, char** predicate_p, char** value_p)
+{
+  const char* colon;
+  const char* equals;
+  const char* value;
+  size_t nspace_len;
+  size_t predicate_len;
+  size_t value_len;
+  size_t i;
+
+  colon = strchr(string, ':');
+  if(!colon)
+    return 1;
+  equals = strchr(colon + 1, '=');
+
+  nspace_len = colon - string;
+  if(equals)
+    predicate_len = equals - (colon + 1);
+  else if(allow_wildcards)
+    predicate_len = strlen(colon + 1);
+  else
+    return 1;
+
+  if(!nspace_len || !predicate_len)
+    return 1;
+
+  if(equals) {
+    value = equals + 1;
+    value_len = strlen(value);
+    if(value_len >= 2 && value[0] == '"' && value[value_len - 1] == '"') {
+      value++;
+      value_len -= 2;
+    }
+  } else {
+    value = "*";
+    value_len = 1;
+  }
+
+  *nspace_p = (char*)malloc(nspace_len + 1);
+  *predicate_p = (char*)malloc(predicate_len + 1);
+  *value_p = (char*)malloc(value_len + 1);
+  if(!*nspace_p || !*predicate_p || !*value_p) {
+    if(*nspace_p)
+      free(*nspace_p);
+    if(*predicate_p)
+      free(*predicate_p);
+    if(*value_p)
+      free(*value_p);
+    return 1;
+  }
+
+  for(i = 0; i < nspace_len; i++)
+    (*nspace_p)[i] = (char)tolower((unsigned char)string[i]);
+  (*nspace_p)[nspace_len] = '\0';
+  for(i = 0; i < predicate_len; i++)
+    (*predicate_p)[i] = (char)tolower((unsigned char)colon[1 + i]);
+  (*predicate_p)[predicate_len] = '\0';
+  memcpy(*value_p, value, value_len);
+  (*value_p)[value_len] = '\0';
+
+  return 0;
+}
+
+
+static int
+flickcurl_mtindex_grow_triples(flickcurl_machinetag_index* index)
+{
+  unsigned int new_size = index->buckets_size ? index->buckets_size << 1 :
+    MTINDEX_INITIAL_SIZE;
+  flickcurl_machinetag_index_triple** new_buckets;
+  int i;
+
+  new_buckets = (flickcurl_machinetag_index_triple**)calloc(new_size,
+                                                            sizeof(flickcurl_machinetag_index_triple*));
+  if(!new_buckets)
+    return 1;
+
+  for(i = 0; i < index->triples_count; i++) {
+    flickcurl_machinetag_index_triple* triple = index->triples[i];
+    unsigned int bucket = triple->hash & (new_size - 1);
+
+    triple->next = new_buckets[bucket];
+    new_buckets[bucket] = triple;
+  }
+
+  if(index->buckets)
+    free(index->buckets);
+  index->buckets = new_buckets;
+  index->buckets_size = new_size;
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_mtindex_photo_index:
+ * @index: machine tags index
+ * @photo_id: photo ID
+ *
+ * INTERNAL - find or add a photo ID
+ *
+ * Return value: photo number or <0 on failure
+ */
+static int
+flickcurl_mtindex_photo_index(flickcurl_machinetag_index* index,
+                              const char* photo_id)
+{
+  unsigned int slot;
+  size_t len;
+  char* copy;
+
+  if((unsigned int)index->photos_count * 2 >= index->photo_slots_size) {
+    unsigned int new_size = index->photo_slots_size ?
+      index->photo_slots_size << 1 : MTINDEX_INITIAL_SIZE;
+    int* new_slots;
+    char** new_photos;
+    int i;
+
+    new_slots = (int*)calloc(new_size, sizeof(int));
+    if(!new_slots)
+      return -1;
+    new_photos = (char**)realloc(index->photos, (new_size / 2) * sizeof(char*));
+    if(!new_photos) {
+      free(new_slots);
+      return -1;
+    }
+    index->photos = new_photos;
+
+    /* slots hold the photo number plus 1 */
+    for(i = 0; i < index->photos_count; i++) {
+      slot = flickcurl_mtindex_hash(index->photos[i], 5381) & (new_size - 1);
+      while(new_slots[slot])
+        slot = (slot + 1) & (new_size - 1);
+      new_slots[slot] = i + 1;
+    }
+
+    if(index->photo_slots)
+      free(index->photo_slots);
+    index->photo_slots = new_slots;
+    index->photo_slots_size = new_size;
+  }
+
+  slot = flickcurl_mtindex_hash(photo_id, 5381) & (index->photo_slots_size - 1);
+  while(index->photo_slots[slot]) {
+    int n = index->photo_slots[slot] - 1;
+
+    if(!strcmp(index->photos[n], photo_id))
+      return n;
+    slot = (slot + 1) & (index->photo_slots_size - 1);
+  }
+
+  len = strlen(photo_id);
+  copy = (char*)malloc(len + 1);
+  if(!copy)
+    return -1;
+  memcpy(copy, photo_id, len + 1);
+
+  index->photos[index->photos_count] = copy;
+  index->photo_slots[slot] = ++index->photos_count;
+
+  return index->photos_count - 1;
+}
+
+
+/*
+ * flickcurl_mtindex_add_posting:
+ * @index: machine tags index
+ * @nspace: namespace (ownership taken)
+ * @predicate: predicate (ownership taken)
+ * @value: value (ownership taken)
+ * @photo: photo number
+ *
+ * INTERNAL - record that a photo has a machine tag
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_mtindex_add_posting(flickcurl_machinetag_index* index,
+                              char* nspace, char* predicate, char* value,
+                              int photo)
+{
+  flickcurl_machinetag_index_triple* triple;
+  unsigned int hash;
+  int pos;
+
+  hash = flickcurl_mtindex_triple_hash(nspace, predicate, value);
+
+  if(index->buckets_size) {
+    for(triple = index->buckets[hash & (index->buckets_size - 1)];
+        triple; triple = triple->next) {
+      if(triple->hash == hash && !strcmp(triple->value, value) &&
+         !strcmp(triple->predicate, predicate) &&
+         !strcmp(triple->nspace, nspace))
+        break;
+    }
+  } else
+    triple = NULL;
+
+  if(triple) {
+    free(nspace);
+    free(predicate);
+    free(value);
+  } else {
+    if(index->triples_count == index->triples_size) {
+      int new_size = index->triples_size ? index->triples_size << 1 :
+        MTINDEX_INITIAL_SIZE;
+      flickcurl_machinetag_index_triple** new_triples;
+
+      new_triples = (flickcurl_machinetag_index_triple**)realloc(index->triples,
+                                                                 new_size * sizeof(flickcurl_machinetag_index_triple*));
+      if(!new_triples)
+        goto failed;
+      index->triples = new_triples;
+      index->triples_size = new_size;
+    }
+
+    if((unsigned int)index->triples_count >= index->buckets_size &&
+       flickcurl_mtindex_grow_triples(index))
+      goto failed;
+
+    triple = (flickcurl_machinetag_index_triple*)calloc(1, sizeof(*triple));
+    if(!triple)
+      goto failed;
+    triple->nspace = nspace;
+    triple->predicate = predicate;
+    triple->value = value;
+    triple->hash = hash;
+    triple->next = index->buckets[hash & (index->buckets_size - 1)];
+    index->buckets[hash & (index->buckets_size - 1)] = triple;
+    index->triples[index->triples_count++] = triple;
+  }
+
+  /* postings are kept in photo number order; new photos have the
+   * highest number so usually append, a photo added again is found by
+   * a binary search
+   */
+  pos = triple->photos_count;
+  if(pos && triple->photos[pos - 1] >= photo) {
+    int lo = 0;
+    int hi = pos;
+
+    while(lo < hi) {
+      int mid = (lo + hi) / 2;
+
+      if(triple->photos[mid] < photo)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if(triple->photos[lo] == photo)
+      return 0;
+    pos = lo;
+  }
+
+  if(triple->photos_count == triple->photos_size) {
+    int new_size = triple->photos_size ? triple->photos_size << 1 : 4;
+    int* new_photos;
+
+    new_photos = (int*)realloc(triple->photos, new_size * sizeof(int));
+    if(!new_photos)
+      return 1;
+    triple->photos = new_photos;
+    triple->photos_size = new_size;
+  }
+  if(pos < triple->photos_count)
+    memmove(triple->photos + pos + 1, triple->photos + pos,
+            (triple->photos_count - pos) * sizeof(int));
+  triple->photos[pos] = photo;
+  triple->photos_count++;
+
+  return 0;
+
+  failed:
+  free(nspace);
+  free(predicate);
+  free(value);
+  return 1;
+}
+
+
+static int
+flickcurl_mtindex_part_matches(const char* pattern, const char* part)
+{
+  return (pattern[0] == '*' && !pattern[1]) || !strcmp(pattern, part);
+}
+
+
+/**
+ * flickcurl_new_machinetag_index:
+ * @fc: flickcurl context
+ *
+ * Create an in-memory machine tags index
+ *
+ * Add harvested photos with flickcurl_machinetag_index_add_photo()
+ * and then query it locally with flickcurl_machinetag_index_query(),
+ * flickcurl_machinetag_index_get_photos() and
+ * flickcurl_machinetag_index_get_namespaces() instead of calling the
+ * flickr.machinetags APIs and machine_tags searches.
+ *
+ * Return value: new index or NULL on failure
+ **/
+flickcurl_machinetag_index*
+flickcurl_new_machinetag_index(flickcurl* fc)
+{
+  flickcurl_machinetag_index* index;
+
+  index = (flickcurl_machinetag_index*)calloc(1, sizeof(*index));
+  if(!index)
+    return NULL;
+
+  index->fc = fc;
+
+  return index;
+}
+
+
+/**
+ * flickcurl_free_machinetag_index:
+ * @index: machine tags index
+ *
+ * Destructor for machine tags index
+ */
+void
+flickcurl_free_machinetag_index(flickcurl_machinetag_index* index)
+{
+  int i;
+
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(index, flickcurl_machinetag_index);
+
+  for(i = 0; i < index->triples_count; i++) {
+    flickcurl_machinetag_index_triple* triple = index->triples[i];
+
+    free(triple->nspace);
+    free(triple->predicate);
+    free(triple->value);
+    if(triple->photos)
+      free(triple->photos);
+    free(triple);
+  }
+  if(index->triples)
+    free(index->triples);
+  if(index->buckets)
+    free(index->buckets);
+
+  for(i = 0; i < index->photos_count; i++)
+    free(index->photos[i]);
+  if(index->photos)
+    free(index->photos);
+  if(index->photo_slots)
+    free(index->photo_slots);
+
+  free(index);
+}
+
+
+/**
+ * flickcurl_machinetag_index_add_photo:
+ * @index: machine tags index
+ * @photo: photo
+ *
+ * Add the machine tags of a photo to a machine tags index
+ *
+ * Uses the raw form of each tag with the machine tag flag set, so
+ * photos should be fetched with the <code>machine_tags</code> extra
+ * or from flickcurl_photos_getInfo().  Adding a photo again only adds
+ * machine tags it did not have before.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_machinetag_index_add_photo(flickcurl_machinetag_index* index,
+                                     flickcurl_photo* photo)
+{
+  int photo_n = -1;
+  int i;
+
+  for(i = 0; i < photo->tags_count; i++) {
+    flickcurl_tag* tag = photo->tags[i];
+    const char* string = tag->raw ? tag->raw : tag->cooked;
+    char* nspace;
+    char* predicate;
+    char* value;
+
+    if(!string || !tag->machine_tag)
+      continue;
+
+    if(flickcurl_mtindex_parse(string, 0, &nspace, &predicate, &value))
+      continue;
+
+    if(photo_n < 0) {
+      photo_n = flickcurl_mtindex_photo_index(index, photo->id);
+      if(photo_n < 0) {
+        free(nspace);
+        free(predicate);
+        free(value);
+        return 1;
+      }
+    }
+
+    if(flickcurl_mtindex_add_posting(index, nspace, predicate, value, photo_n))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_machinetag_index_add_photos_list:
+ * @index: machine tags index
+ * @photos_list: photos list
+ *
+ * Add the machine tags of all photos in a list to a machine tags index
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_machinetag_index_add_photos_list(flickcurl_machinetag_index* index,
+                                           flickcurl_photos_list* photos_list)
+{
+  int i;
+
+  for(i = 0; i < photos_list->photos_count; i++) {
+    if(flickcurl_machinetag_index_add_photo(index, photos_list->photos[i]))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+static int
+flickcurl_mtindex_compare_predicate_value(const void* a, const void* b)
+{
+  const flickcurl_machinetag_index_triple* t1 = *(const flickcurl_machinetag_index_triple**)a;
+  const flickcurl_machinetag_index_triple* t2 = *(const flickcurl_machinetag_index_triple**)b;
+  int rc;
+
+  rc = strcmp(t1->predicate, t2->predicate);
+  if(!rc)
+    rc = strcmp(t1->value, t2->value);
+  return rc;
+}
+
+
+static int
+flickcurl_mtindex_compare_namespace_predicate(const void* a, const void* b)
+{
+  const flickcurl_machinetag_index_triple* t1 = *(const flickcurl_machinetag_index_triple**)a;
+  const flickcurl_machinetag_index_triple* t2 = *(const flickcurl_machinetag_index_triple**)b;
+  int rc;
+
+  rc = strcmp(t1->nspace, t2->nspace);
+  if(!rc)
+    rc = strcmp(t1->predicate, t2->predicate);
+  return rc;
+}
+
+
+/**
+ * flickcurl_machinetag_index_query:
+ * @index: machine tags index
+ * @machine_tag: machine tag pattern "namespace:predicate=value" where any part may be "*"
+ * @count_p: pointer to store number of results (or NULL)
+ *
+ * Count uses of predicate-value pairs matching a machine tag pattern
+ *
+ * For example "dc:creator=*" counts every creator and
+ * "*:pred=value" counts one pair over all namespaces.  A missing
+ * "=value" is the same as "=*".
+ *
+ * Each result has the @predicate and @value, @usage_count as the
+ * number of photos using the pair and @used_in_namespace_count as
+ * the number of matching namespaces it appears in.  Results are in
+ * predicate then value order.
+ *
+ * Return value: array of pairs or NULL on failure
+ **/
+flickcurl_tag_predicate_value**
+flickcurl_machinetag_index_query(flickcurl_machinetag_index* index,
+                                 const char* machine_tag, int* count_p)
+{
+  flickcurl_tag_predicate_value** pvs = NULL;
+  flickcurl_machinetag_index_triple** matches = NULL;
+  char* nspace = NULL;
+  char* predicate = NULL;
+  char* value = NULL;
+  int matches_count = 0;
+  int pvs_count = 0;
+  int i;
+
+  if(flickcurl_mtindex_parse(machine_tag, 1, &nspace, &predicate, &value)) {
+    flickcurl_error(index->fc, "Invalid machine tag pattern '%s'", machine_tag);
+    return NULL;
+  }
+
+  matches = (flickcurl_machinetag_index_triple**)calloc(index->triples_count + 1,
+                                                        sizeof(flickcurl_machinetag_index_triple*));
+  if(!matches)
+    goto tidy;
+
+  for(i = 0; i < index->triples_count; i++) {
+    flickcurl_machinetag_index_triple* triple = index->triples[i];
+
+    if(flickcurl_mtindex_part_matches(nspace, triple->nspace) &&
+       flickcurl_mtindex_part_matches(predicate, triple->predicate) &&
+       flickcurl_mtindex_part_matches(value, triple->value))
+      matches[matches_count++] = triple;
+  }
+
+  /* sorting brings the same pair from different namespaces together */
+  qsort(matches, matches_count, sizeof(flickcurl_machinetag_index_triple*),
+        flickcurl_mtindex_compare_predicate_value);
+
+  pvs = (flickcurl_tag_predicate_value**)calloc(matches_count + 1,
+                                                sizeof(flickcurl_tag_predicate_value*));
+  if(!pvs)
+    goto tidy;
+
+  for(i = 0; i < matches_count; i++) {
+    flickcurl_machinetag_index_triple* triple = matches[i];
+    flickcurl_tag_predicate_value* pv;
+
+    if(i && !flickcurl_mtindex_compare_predicate_value(&matches[i - 1],
+                                                       &matches[i])) {
+      pv = pvs[pvs_count - 1];
+    } else {
+      pv = (flickcurl_tag_predicate_value*)calloc(1, sizeof(*pv));
+      if(!pv)
+        goto failed;
+      pvs[pvs_count++] = pv;
+      pv->predicate = (char*)malloc(strlen(triple->predicate) + 1);
+      pv->value = (char*)malloc(strlen(triple->value) + 1);
+      if(!pv->predicate || !pv->value)
+        goto failed;
+      strcpy(pv->predicate, triple->predicate);
+      strcpy(pv->value, triple->value);
+    }
+
+    pv->usage_count += triple->photos_count;
+    pv->used_in_namespace_count++;
+  }
+
+  if(count_p)
+    *count_p = pvs_count;
+
+  tidy:
+  if(matches)
+    free(matches);
+  free(nspace);
+  free(predicate);
+  free(value);
+
+  return pvs;
+
+  failed:
+  flickcurl_free_tag_predicate_values(pvs);
+  pvs = NULL;
+  goto tidy;
+}
+
+
+/**
+ * flickcurl_machinetag_index_get_photos:
+ * @index: machine tags index
+ * @machine_tag: machine tag pattern "namespace:predicate=value" where any part may be "*"
+ * @count_p: pointer to store number of photo IDs (or NULL)
+ *
+ * Get the photos with a machine tag matching a pattern
+ *
+ * This answers the same question as a flickcurl_photos_search() with
+ * machine_tags but from the local index.  Photo IDs are returned in
+ * the order the photos were added.  Free the result with
+ * flickcurl_array_free().
+ *
+ * Return value: NULL terminated array of photo IDs or NULL on failure
+ **/
+char**
+flickcurl_machinetag_index_get_photos(flickcurl_machinetag_index* index,
+                                      const char* machine_tag, int* count_p)
+{
+  char** photo_ids = NULL;
+  char* seen = NULL;
+  char* nspace = NULL;
+  char* predicate = NULL;
+  char* value = NULL;
+  int photo_ids_count = 0;
+  int i;
+
+  if(flickcurl_mtindex_parse(machine_tag, 1, &nspace, &predicate, &value)) {
+    flickcurl_error(index->fc, "Invalid machine tag pattern '%s'", machine_tag);
+    return NULL;
+  }
+
+  seen = (char*)calloc(index->photos_count + 1, 1);
+  if(!seen)
+    goto tidy;
+
+  for(i = 0; i < index->triples_count; i++) {
+    flickcurl_machinetag_index_triple* triple = index->triples[i];
+    int j;
+
+    if(!flickcurl_mtindex_part_matches(nspace, triple->nspace) ||
+       !flickcurl_mtindex_part_matches(predicate, triple->predicate) ||
+       !flickcurl_mtindex_part_matches(value, triple->value))
+      continue;
+
+    for(j = 0; j < triple->photos_count; j++) {
+      if(!seen[triple->photos[j]]) {
+        seen[triple->photos[j]] = 1;
+        photo_ids_count++;
+      }
+    }
+  }
+
+  photo_ids = (char**)calloc(photo_ids_count + 1, sizeof(char*));
+  if(!photo_ids)
+    goto tidy;
+
+  photo_ids_count = 0;
+  for(i = 0; i < index->photos_count; i++) {
+    size_t len;
+
+    if(!seen[i])
+      continue;
+
+    len = strlen(index->photos[i]);
+    photo_ids[photo_ids_count] = (char*)malloc(len + 1);
+    if(!photo_ids[photo_ids_count]) {
+      flickcurl_array_free(photo_ids);
+      photo_ids = NULL;
+      goto tidy;
+    }
+    memcpy(photo_ids[photo_ids_count++], index->photos[i], len + 1);
+  }
+
+  if(count_p)
+    *count_p = photo_ids_count;
+
+  tidy:
+  if(seen)
+    free(seen);
+  free(nspace);
+  free(predicate);
+  free(value);
+
+  return photo_ids;
+}
+
+
+/**
+ * flickcurl_machinetag_index_get_namespaces:
+ * @index: machine tags index
+ * @predicate: limit to namespaces with this predicate (or NULL)
+ * @count_p: pointer to store number of namespaces (or NULL)
+ *
+ * Get the namespaces in a machine tags index with usage counts
+ *
+ * The local equivalent of flickcurl_machinetags_getNamespaces().
+ * @usage_count is the number of machine tag uses in the namespace and
+ * @predicates_count the number of distinct predicates in it.
+ *
+ * Return value: array of namespaces or NULL on failure
+ **/
+flickcurl_tag_namespace**
+flickcurl_machinetag_index_get_namespaces(flickcurl_machinetag_index* index,
+                                          const char* predicate,
+                                          int* count_p)
+{
+  flickcurl_tag_namespace** nspaces = NULL;
+  flickcurl_machinetag_index_triple** matches;
+  char* lc_predicate = NULL;
+  int matches_count = 0;
+  int nspaces_count = 0;
+  int i;
+
+  /* predicates are stored lowercased */
+  if(predicate) {
+    size_t len = strlen(predicate);
+
+    lc_predicate = (char*)malloc(len + 1);
+    if(!lc_predicate)
+      return NULL;
+    for(i = 0; i <= (int)len; i++)
+      lc_predicate[i] = (char)tolower((unsigned char)predicate[i]);
+  }
+
+  matches = (flickcurl_machinetag_index_triple**)calloc(index->triples_count + 1,
+                                                        sizeof(flickcurl_machinetag_index_triple*));
+  if(!matches) {
+    if(lc_predicate)
+      free(lc_predicate);
+    return NULL;
+  }
+
+  for(i = 0; i < index->triples_count; i++) {
+    flickcurl_machinetag_index_triple* triple = index->triples[i];
+
+    if(!lc_predicate || !strcmp(lc_predicate, triple->predicate))
+      matches[matches_count++] = triple;
+  }
+
+  qsort(matches, matches_count, sizeof(flickcurl_machinetag_index_triple*),
+        flickcurl_mtindex_compare_namespace_predicate);
+
+  nspaces = (flickcurl_tag_namespace**)calloc(matches_count + 1,
+                                              sizeof(flickcurl_tag_namespace*));
+  if(!nspaces)
+    goto tidy;
+
+  for(i = 0; i < matches_count; i++) {
+    flickcurl_machinetag_index_triple* triple = matches[i];
+    flickcurl_tag_namespace* ns;
+
+    if(i && !strcmp(matches[i - 1]->nspace, triple->nspace)) {
+      ns = nspaces[nspaces_count - 1];
+      if(strcmp(matches[i - 1]->predicate, triple->predicate))
+        ns->predicates_count++;
+    } else {
+      ns = (flickcurl_tag_namespace*)calloc(1, sizeof(*ns));
+      if(!ns)
+        goto failed;
+      nspaces[nspaces_count++] = ns;
+      ns->name = (char*)malloc(strlen(triple->nspace) + 1);
+      if(!ns->name)
+        goto failed;
+      strcpy(ns->name, triple->nspace);
+      ns->predicates_count = 1;
+    }
+
+    ns->usage_count += triple->photos_count;
+  }
+
+  if(count_p)
+    *count_p = nspaces_count;
+
+  tidy:
+  free(matches);
+  if(lc_predicate)
+    free(lc_predicate);
+
+  return nspaces;
+
+  failed:
+  flickcurl_free_tag_namespaces(nspaces);
+  nspaces = NULL;
+  goto tidy;
+}
@@ -108,6 +108,27 @@ static struct {
 };
 
 
+/*
+ * flickcurl_method_register_xpaths:
+ *
+ * INTERNAL - compile the method field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_method_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; method_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(method_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
 flickcurl_method*
 flickcurl_build_method(flickcurl* fc, xmlXPathContextPtr xpathCtx)
 {
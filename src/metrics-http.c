@@ -0,0 +1,388 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * metrics-http.c - Flickcurl local HTTP listener for metrics scraping
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#include <sys/time.h>
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_NETINET_IN_H)
+#define METRICS_HTTP 1
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+#ifdef METRICS_HTTP
+
+/* Longest request read from a client; only the request line is used */
+#define METRICS_HTTP_REQUEST_SIZE 2048
+
+/* Longest time a client may take to send its request */
+#define METRICS_HTTP_READ_MSEC 1000
+
+/* Longest time a client may take to read the response */
+#define METRICS_HTTP_WRITE_MSEC 1000
+
+/* Most connections served by one poll */
+#define METRICS_HTTP_MAX_CONNECTIONS 4
+
+#ifndef EWOULDBLOCK
+#define EWOULDBLOCK EAGAIN
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define METRICS_HTTP_CONTENT_TYPE \
+  "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+
+static int
+flickcurl_metrics_http_wait(int fd, int for_write, long timeout_msec)
+{
+  fd_set fds;
+  struct timeval timeout;
+
+  FD_ZERO(&fds);
+  FD_SET(fd, &fds);
+  timeout.tv_sec = timeout_msec / 1000;
+  timeout.tv_usec = (timeout_msec % 1000) * 1000;
+
+  if(for_write)
+    return select(fd + 1, NULL, &fds, NULL, &timeout);
+
+  return select(fd + 1, &fds, NULL, NULL, &timeout);
+}
+
+
+/*
+ * flickcurl_metrics_http_send:
+ * @fd: non-blocking client socket
+ * @data: data to send
+ * @len: length of @data
+ * @start: start of the response
+ *
+ * INTERNAL - send data unless the client reads too slowly
+ *
+ * Return value: non-0 if the data was not all sent by
+ * METRICS_HTTP_WRITE_MSEC after @start
+ */
+static int
+flickcurl_metrics_http_send(int fd, const char* data, size_t len,
+                            struct timeval* start)
+{
+  while(len) {
+    long left = METRICS_HTTP_WRITE_MSEC -
+                flickcurl_timing_elapsed(start) / 1000;
+    ssize_t sent;
+
+    if(left <= 0)
+      return 1;
+
+    sent = send(fd, data, len, MSG_NOSIGNAL);
+    if(sent < 0) {
+      if(errno == EINTR)
+        continue;
+      if(errno != EAGAIN && errno != EWOULDBLOCK)
+        return 1;
+      /* socket buffer full: wait for the client to read some */
+      if(flickcurl_metrics_http_wait(fd, 1, left) < 0 && errno != EINTR)
+        return 1;
+      continue;
+    }
+    data += sent;
+    len -= (size_t)sent;
+  }
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_metrics_http_serve:
+ * @listener: metrics listener
+ * @fd: accepted non-blocking client socket
+ *
+ * INTERNAL - read one HTTP request and answer it with the metrics
+ */
+static void
+flickcurl_metrics_http_serve(flickcurl_metrics_listener* listener, int fd)
+{
+  char request[METRICS_HTTP_REQUEST_SIZE + 1];
+  size_t request_len = 0;
+  struct timeval start;
+  char header[256];
+  char* body = NULL;
+  size_t body_len = 0;
+  int status = 200;
+
+  gettimeofday(&start, NULL);
+
+  /* read up to the end of the headers or as much as fits */
+  while(request_len < METRICS_HTTP_REQUEST_SIZE) {
+    long left = METRICS_HTTP_READ_MSEC -
+                flickcurl_timing_elapsed(&start) / 1000;
+    ssize_t got;
+
+    if(left <= 0 || flickcurl_metrics_http_wait(fd, 0, left) <= 0)
+      return;
+
+    got = recv(fd, request + request_len,
+               METRICS_HTTP_REQUEST_SIZE - request_len, 0);
+    if(got < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+      continue;
+    if(got <= 0)
+      return;
+
+    request_len += (size_t)got;
+    request[request_len] = '\0';
+    if(strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+      break;
+  }
+  request[request_len] = '\0';
+
+  if(strncmp(request, "GET ", 4))
+    status = 405;
+  else {
+    body_len = flickcurl_render_openmetrics(listener->fc, NULL, 0);
+    body = (char*)malloc(body_len + 1);
+    if(!body)
+      status = 500;
+    else
+      flickcurl_render_openmetrics(listener->fc, body, body_len + 1);
+  }
+
+  if(status == 200)
+    sprintf(header,
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: " METRICS_HTTP_CONTENT_TYPE "\r\n"
+            "Content-Length: %lu\r\n"
+            "Connection: close\r\n\r\n",
+            (unsigned long)body_len);
+  else
+    sprintf(header,
+            "HTTP/1.0 %d %s\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: close\r\n\r\n",
+            status, (status == 405) ? "Method Not Allowed" : "Error");
+
+  gettimeofday(&start, NULL);
+  if(!flickcurl_metrics_http_send(fd, header, strlen(header), &start) && body)
+    flickcurl_metrics_http_send(fd, body, body_len, &start);
+
+  if(body)
+    free(body);
+
+  listener->scrapes++;
+}
+
+#endif
+
+
+/**
+ * flickcurl_new_metrics_listener:
+ * @fc: flickcurl object
+ * @port: TCP port to listen on at 127.0.0.1 (or 0 for any free port)
+ *
+ * Constructor - create a local HTTP listener serving OpenMetrics text
+ *
+ * The listener answers every GET request with the output of
+ * flickcurl_render_openmetrics() for @fc so that a Prometheus
+ * compatible scraper on the same host can monitor it.  It starts no
+ * thread: connections are only served inside
+ * flickcurl_metrics_listener_poll(), within its time limits, which
+ * must be called from the thread using @fc, for example between
+ * requests.
+ *
+ * Listening is not available on systems without BSD sockets.
+ *
+ * Return value: new listener or NULL on failure
+ **/
+flickcurl_metrics_listener*
+flickcurl_new_metrics_listener(flickcurl* fc, int port)
+{
+#ifdef METRICS_HTTP
+  flickcurl_metrics_listener* listener;
+  struct sockaddr_in addr;
+  socklen_t addr_len = sizeof(addr);
+  int on = 1;
+  int fd;
+
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  if(fd < 0) {
+    flickcurl_error(fc, "Failed to create metrics socket - %s",
+                    strerror(errno));
+    return NULL;
+  }
+
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+
+  memset(&addr, '\0', sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons((unsigned short)port);
+
+  if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+     listen(fd, 8) ||
+     getsockname(fd, (struct sockaddr*)&addr, &addr_len)) {
+    flickcurl_error(fc, "Failed to listen for metrics on port %d - %s",
+                    port, strerror(errno));
+    close(fd);
+    return NULL;
+  }
+
+#ifdef O_NONBLOCK
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+  listener = (flickcurl_metrics_listener*)calloc(1, sizeof(*listener));
+  if(!listener) {
+    close(fd);
+    return NULL;
+  }
+
+  listener->fc = fc;
+  listener->fd = fd;
+  listener->port = ntohs(addr.sin_port);
+
+  return listener;
+#else
+  flickcurl_error(fc, "Metrics listener is not supported on this system");
+  return NULL;
+#endif
+}
+
+
+/**
+ * flickcurl_free_metrics_listener:
+ * @listener: metrics listener object
+ *
+ * Destructor - stop listening and free a metrics listener
+ */
+void
+flickcurl_free_metrics_listener(flickcurl_metrics_listener* listener)
+{
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(listener, flickcurl_metrics_listener);
+
+#ifdef METRICS_HTTP
+  if(listener->fd >= 0)
+    close(listener->fd);
+#endif
+
+  free(listener);
+}
+
+
+/**
+ * flickcurl_metrics_listener_get_port:
+ * @listener: metrics listener object
+ *
+ * Get the TCP port a metrics listener is using
+ *
+ * Return value: port number
+ **/
+int
+flickcurl_metrics_listener_get_port(flickcurl_metrics_listener* listener)
+{
+  return listener->port;
+}
+
+
+/**
+ * flickcurl_metrics_listener_poll:
+ * @listener: metrics listener object
+ * @timeout_msec: longest time to wait for a connection in milliseconds (or 0 to not wait)
+ *
+ * Serve the scrape requests waiting on a metrics listener
+ *
+ * Each waiting connection, up to 4 per call, gets one response and
+ * is closed.  A client that does not send its request or read the
+ * response within a second each is dropped, so one call takes at
+ * most @timeout_msec plus a few seconds.
+ *
+ * Return value: number of scrapes answered or <0 on failure
+ **/
+int
+flickcurl_metrics_listener_poll(flickcurl_metrics_listener* listener,
+                                int timeout_msec)
+{
+#ifdef METRICS_HTTP
+  int scrapes = listener->scrapes;
+  int connections = 0;
+  int rc;
+
+  rc = flickcurl_metrics_http_wait(listener->fd, 0,
+                                   timeout_msec > 0 ? timeout_msec : 0);
+  if(rc < 0)
+    return (errno == EINTR) ? 0 : -1;
+
+  while(rc > 0 && connections < METRICS_HTTP_MAX_CONNECTIONS) {
+    int fd = accept(listener->fd, NULL, NULL);
+
+    if(fd < 0) {
+      if(errno == EINTR)
+        continue;
+      /* EAGAIN: nothing more waiting */
+      break;
+    }
+    connections++;
+
+    /* accepted sockets do not inherit O_NONBLOCK everywhere */
+#ifdef O_NONBLOCK
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    flickcurl_metrics_http_serve(listener, fd);
+    close(fd);
+  }
+
+  return listener->scrapes - scrapes;
+#else
+  return -1;
+#endif
+}
@@ -0,0 +1,725 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * metrics.c - Flickcurl per-method request metrics
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * Latencies are counted in a log-linear histogram: values below
+ * 2^METRICS_SUB_BITS usec get a bucket each and every power of two
+ * above that is split into 2^METRICS_SUB_BITS linear buckets, so any
+ * percentile is within 1/2^METRICS_SUB_BITS of the true value for a
+ * fixed amount of memory.
+ *
+ * The registry belongs to one flickcurl object which, like its curl
+ * handle, is only used by one thread at a time so no locking is done.
+ */
+
+#define METRICS_SUB_BITS 3
+#define METRICS_SUB_COUNT (1 << METRICS_SUB_BITS)
+
+/* Method name used for calls that have none such as uploads */
+#define METRICS_NO_METHOD "(none)"
+
+
+static int
+flickcurl_metrics_bucket(long value)
+{
+  int exponent = 0;
+  int bucket;
+
+  if(value < METRICS_SUB_COUNT)
+    return (int)(value < 0 ? 0 : value);
+
+  while((value >> exponent) >= (2 * METRICS_SUB_COUNT))
+    exponent++;
+
+  /* exponent is now the shift leaving METRICS_SUB_BITS + 1 bits */
+  bucket = (exponent + 1) * METRICS_SUB_COUNT +
+           (int)((value >> exponent) - METRICS_SUB_COUNT);
+  if(bucket >= FLICKCURL_METRICS_BUCKETS)
+    bucket = FLICKCURL_METRICS_BUCKETS - 1;
+
+  return bucket;
+}
+
+
+/* middle of the range of values counted in @bucket */
+static long
+flickcurl_metrics_bucket_value(int bucket)
+{
+  int exponent;
+  long low;
+
+  if(bucket < METRICS_SUB_COUNT)
+    return bucket;
+
+  exponent = bucket / METRICS_SUB_COUNT - 1;
+  low = (long)(METRICS_SUB_COUNT + bucket % METRICS_SUB_COUNT) << exponent;
+
+  return low + ((1L << exponent) >> 1);
+}
+
+
+static long
+flickcurl_metrics_percentile(flickcurl_metrics_entry* entry, int percent)
+{
+  unsigned long rank;
+  unsigned long seen = 0;
+  int i;
+
+  if(!entry->latency_count)
+    return 0;
+
+  rank = (entry->latency_count * (unsigned long)percent + 99) / 100;
+  if(!rank)
+    rank = 1;
+
+  for(i = 0; i < FLICKCURL_METRICS_BUCKETS; i++) {
+    seen += entry->buckets[i];
+    if(seen >= rank)
+      break;
+  }
+
+  if(i >= FLICKCURL_METRICS_BUCKETS)
+    i = FLICKCURL_METRICS_BUCKETS - 1;
+
+  /* the bucket estimate can not be above the largest value seen */
+  if(flickcurl_metrics_bucket_value(i) > entry->latency_max)
+    return entry->latency_max;
+
+  return flickcurl_metrics_bucket_value(i);
+}
+
+
+static void
+flickcurl_metrics_add_code(flickcurl_metrics_count* counts, int* count_p,
+                           int* other_p, int code)
+{
+  int i;
+
+  for(i = 0; i < *count_p; i++) {
+    if(counts[i].code == code) {
+      counts[i].count++;
+      return;
+    }
+  }
+
+  if(*count_p < FLICKCURL_METRICS_CODES) {
+    counts[*count_p].code = code;
+    counts[*count_p].count = 1;
+    (*count_p)++;
+  } else
+    (*other_p)++;
+}
+
+
+static flickcurl_metrics_entry*
+flickcurl_metrics_get_entry(flickcurl* fc, const char* method)
+{
+  flickcurl_metrics_entry* entry;
+  flickcurl_metrics_entry* prev = NULL;
+  size_t len;
+
+  for(entry = fc->metrics; entry; prev = entry, entry = entry->next) {
+    if(!strcmp(entry->method, method)) {
+      /* keep the busiest methods at the front */
+      if(prev) {
+        prev->next = entry->next;
+        entry->next = fc->metrics;
+        fc->metrics = entry;
+      }
+      return entry;
+    }
+  }
+
+  entry = (flickcurl_metrics_entry*)calloc(1, sizeof(*entry));
+  if(!entry)
+    return NULL;
+  len = strlen(method);
+  entry->method = (char*)malloc(len + 1);
+  if(!entry->method) {
+    free(entry);
+    return NULL;
+  }
+  memcpy(entry->method, method, len + 1);
+
+  entry->next = fc->metrics;
+  fc->metrics = entry;
+
+  return entry;
+}
+
+
+/*
+ * flickcurl_metrics_update:
+ * @fc: flickcurl context after a web service request
+ * @latency_usec: time the request took or <0 if it did not complete
+ * @wire_bytes: response body bytes received over the network
+ *
+ * INTERNAL - record a request in the metrics of its method
+ */
+void
+flickcurl_metrics_update(flickcurl* fc, long latency_usec, double wire_bytes)
+{
+  flickcurl_metrics_entry* entry;
+
+  entry = flickcurl_metrics_get_entry(fc, fc->method ? fc->method :
+                                      METRICS_NO_METHOD);
+  if(!entry)
+    return;
+
+  entry->requests++;
+  if(fc->failed)
+    entry->errors++;
+
+  if(fc->error_code)
+    flickcurl_metrics_add_code(entry->error_codes, &entry->error_codes_count,
+                               &entry->error_codes_other, fc->error_code);
+  if(fc->status_code)
+    flickcurl_metrics_add_code(entry->status_codes, &entry->status_codes_count,
+                               &entry->status_codes_other, fc->status_code);
+
+  entry->wire_bytes += wire_bytes;
+  entry->decoded_bytes += fc->total_bytes;
+  entry->delay_sum += (double)fc->timing.delay_usec;
+
+  if(latency_usec >= 0) {
+    entry->buckets[flickcurl_metrics_bucket(latency_usec)]++;
+    entry->latency_count++;
+    entry->latency_sum += (double)latency_usec;
+    if(latency_usec > entry->latency_max)
+      entry->latency_max = latency_usec;
+  }
+}
+
+
+/**
+ * flickcurl_reset_metrics:
+ * @fc: flickcurl object
+ *
+ * Forget the request metrics recorded so far
+ */
+void
+flickcurl_reset_metrics(flickcurl* fc)
+{
+  while(fc->metrics) {
+    flickcurl_metrics_entry* next = fc->metrics->next;
+
+    free(fc->metrics->method);
+    free(fc->metrics);
+    fc->metrics = next;
+  }
+}
+
+
+static int
+flickcurl_compare_method_metrics(const void *a, const void *b)
+{
+  flickcurl_method_metrics* ma = *(flickcurl_method_metrics**)a;
+  flickcurl_method_metrics* mb = *(flickcurl_method_metrics**)b;
+
+  return strcmp(ma->method, mb->method);
+}
+
+
+static flickcurl_metrics_count*
+flickcurl_metrics_copy_codes(flickcurl_metrics_count* counts, int count,
+                             int other, int* count_p)
+{
+  flickcurl_metrics_count* copy;
+
+  copy = (flickcurl_metrics_count*)calloc(count + 2, sizeof(*copy));
+  if(!copy)
+    return NULL;
+
+  if(count)
+    memcpy(copy, counts, count * sizeof(*copy));
+  /* codes that did not fit are reported as code -1 */
+  if(other) {
+    copy[count].code = -1;
+    copy[count].count = other;
+    count++;
+  }
+
+  *count_p = count;
+  return copy;
+}
+
+
+/**
+ * flickcurl_get_method_metrics:
+ * @fc: flickcurl object
+ * @count_p: pointer to store number of methods (or NULL)
+ *
+ * Get a snapshot of the request metrics of each API method
+ *
+ * Every web service call made with @fc is counted against its method
+ * name with the HTTP status, Flickr error code, response sizes and
+ * latency.  Calls without a method such as uploads are counted under
+ * "(none)".  Latency percentiles are estimated from a histogram and
+ * are within 1/8 of the true value.
+ *
+ * Return value: new NULL-terminated array of metrics sorted by method or NULL on failure
+ **/
+flickcurl_method_metrics**
+flickcurl_get_method_metrics(flickcurl* fc, int* count_p)
+{
+  flickcurl_metrics_entry* entry;
+  flickcurl_method_metrics** metrics;
+  int count = 0;
+  int i;
+
+  for(entry = fc->metrics; entry; entry = entry->next)
+    count++;
+
+  metrics = (flickcurl_method_metrics**)calloc(count + 1,
+                                               sizeof(flickcurl_method_metrics*));
+  if(!metrics)
+    return NULL;
+
+  for(i = 0, entry = fc->metrics; entry; i++, entry = entry->next) {
+    flickcurl_method_metrics* m;
+    size_t len;
+
+    m = (flickcurl_method_metrics*)calloc(1, sizeof(*m));
+    if(!m)
+      goto failed;
+    metrics[i] = m;
+
+    len = strlen(entry->method);
+    m->method = (char*)malloc(len + 1);
+    if(!m->method)
+      goto failed;
+    memcpy(m->method, entry->method, len + 1);
+
+    m->requests = entry->requests;
+    m->errors = entry->errors;
+    m->wire_bytes = entry->wire_bytes;
+    m->decoded_bytes = entry->decoded_bytes;
+    if(entry->latency_count)
+      m->latency_mean = entry->latency_sum / entry->latency_count;
+    m->latency_p50 = flickcurl_metrics_percentile(entry, 50);
+    m->latency_p90 = flickcurl_metrics_percentile(entry, 90);
+    m->latency_p99 = flickcurl_metrics_percentile(entry, 99);
+    m->latency_max = entry->latency_max;
+    m->delay_usec = entry->delay_sum;
+
+    m->error_codes = flickcurl_metrics_copy_codes(entry->error_codes,
+                                                  entry->error_codes_count,
+                                                  entry->error_codes_other,
+                                                  &m->error_codes_count);
+    m->status_codes = flickcurl_metrics_copy_codes(entry->status_codes,
+                                                   entry->status_codes_count,
+                                                   entry->status_codes_other,
+                                                   &m->status_codes_count);
+    if(!m->error_codes || !m->status_codes)
+      goto failed;
+  }
+
+  qsort(metrics, count, sizeof(flickcurl_method_metrics*),
+        flickcurl_compare_method_metrics);
+
+  if(count_p)
+    *count_p = count;
+
+  return metrics;
+
+  failed:
+  flickcurl_free_method_metrics(metrics);
+  return NULL;
+}
+
+
+/**
+ * flickcurl_free_method_metrics:
+ * @metrics: metrics array from flickcurl_get_method_metrics()
+ *
+ * Destructor for method metrics array
+ */
+void
+flickcurl_free_method_metrics(flickcurl_method_metrics** metrics)
+{
+  int i;
+
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(metrics, flickcurl_method_metrics_array);
+
+  for(i = 0; metrics[i]; i++) {
+    if(metrics[i]->method)
+      free(metrics[i]->method);
+    if(metrics[i]->error_codes)
+      free(metrics[i]->error_codes);
+    if(metrics[i]->status_codes)
+      free(metrics[i]->status_codes);
+    free(metrics[i]);
+  }
+
+  free(metrics);
+}
+
+
+/**
+ * flickcurl_dump_metrics:
+ * @fc: flickcurl object
+ * @fh: file handle to write to
+ *
+ * Write the request metrics of each API method as a text table
+ *
+ * One line is written per method with counts, bytes and latencies in
+ * milliseconds followed by the HTTP statuses and Flickr error codes
+ * seen.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_dump_metrics(flickcurl* fc, FILE* fh)
+{
+  flickcurl_method_metrics** metrics;
+  int i;
+
+  metrics = flickcurl_get_method_metrics(fc, NULL);
+  if(!metrics)
+    return 1;
+
+  fprintf(fh, "%-40s %8s %6s %12s %9s %9s %9s %9s\n",
+          "method", "requests", "errors", "wire-bytes",
+          "p50-ms", "p90-ms", "p99-ms", "max-ms");
+
+  for(i = 0; metrics[i]; i++) {
+    flickcurl_method_metrics* m = metrics[i];
+    int j;
+
+    fprintf(fh, "%-40s %8d %6d %12.0f %9.1f %9.1f %9.1f %9.1f",
+            m->method, m->requests, m->errors, m->wire_bytes,
+            m->latency_p50 / 1000.0, m->latency_p90 / 1000.0,
+            m->latency_p99 / 1000.0, m->latency_max / 1000.0);
+
+    for(j = 0; j < m->status_codes_count; j++)
+      fprintf(fh, " http%d=%d", m->status_codes[j].code,
+              m->status_codes[j].count);
+    for(j = 0; j < m->error_codes_count; j++)
+      fprintf(fh, " error%d=%d", m->error_codes[j].code,
+              m->error_codes[j].count);
+    fputc('\n', fh);
+  }
+
+  flickcurl_free_method_metrics(metrics);
+
+  return 0;
+}
+
+
+typedef struct {
+  char* buffer;
+  size_t size;
+  size_t len;
+} flickcurl_metrics_text;
+
+
+static void
+flickcurl_metrics_text_append(flickcurl_metrics_text* text, const char* str,
+                              size_t len)
+{
+  if(text->len < text->size) {
+    size_t avail = text->size - text->len;
+
+    memcpy(text->buffer + text->len, str, len < avail ? len : avail);
+  }
+  text->len += len;
+}
+
+
+static void
+flickcurl_metrics_text_puts(flickcurl_metrics_text* text, const char* str)
+{
+  flickcurl_metrics_text_append(text, str, strlen(str));
+}
+
+
+static void
+flickcurl_metrics_text_number(flickcurl_metrics_text* text, double value)
+{
+  char number[64];
+
+  /* integral counts are printed exactly */
+  if(value == (double)(long)value)
+    sprintf(number, " %ld\n", (long)value);
+  else
+    sprintf(number, " %.6f\n", value);
+  flickcurl_metrics_text_puts(text, number);
+}
+
+
+/* start a sample line: NAME{method="METHOD" */
+static void
+flickcurl_metrics_text_sample(flickcurl_metrics_text* text, const char* name,
+                              const char* method)
+{
+  const char* p;
+
+  flickcurl_metrics_text_puts(text, name);
+  flickcurl_metrics_text_puts(text, "{method=\"");
+  for(p = method; *p; p++) {
+    if(*p == '"' || *p == '\\')
+      flickcurl_metrics_text_append(text, "\\", 1);
+    flickcurl_metrics_text_append(text, p, 1);
+  }
+  flickcurl_metrics_text_append(text, "\"", 1);
+}
+
+
+static void
+flickcurl_metrics_text_family(flickcurl_metrics_text* text, const char* name,
+                              const char* type, const char* help)
+{
+  flickcurl_metrics_text_puts(text, "# TYPE ");
+  flickcurl_metrics_text_puts(text, name);
+  flickcurl_metrics_text_append(text, " ", 1);
+  flickcurl_metrics_text_puts(text, type);
+  flickcurl_metrics_text_puts(text, "\n# HELP ");
+  flickcurl_metrics_text_puts(text, name);
+  flickcurl_metrics_text_append(text, " ", 1);
+  flickcurl_metrics_text_puts(text, help);
+  flickcurl_metrics_text_append(text, "\n", 1);
+}
+
+
+static void
+flickcurl_metrics_text_codes(flickcurl_metrics_text* text, const char* name,
+                             const char* method,
+                             flickcurl_metrics_count* counts, int count,
+                             int other)
+{
+  char label[32];
+  int i;
+
+  for(i = 0; i < count; i++) {
+    flickcurl_metrics_text_sample(text, name, method);
+    sprintf(label, ",code=\"%d\"}", counts[i].code);
+    flickcurl_metrics_text_puts(text, label);
+    flickcurl_metrics_text_number(text, counts[i].count);
+  }
+  if(other) {
+    flickcurl_metrics_text_sample(text, name, method);
+    flickcurl_metrics_text_puts(text, ",code=\"other\"}");
+    flickcurl_metrics_text_number(text, other);
+  }
+}
+
+
+/* Histogram bucket bounds are powers of two from 2^10 usec (about
+ * 1ms) to 2^26 usec (about 67s) which are exact bucket boundaries
+ */
+#define METRICS_LE_FIRST 10
+#define METRICS_LE_LAST 26
+
+
+/**
+ * flickcurl_render_openmetrics:
+ * @fc: flickcurl object
+ * @buffer: buffer to write to (or NULL to measure)
+ * @buffer_size: size of @buffer
+ *
+ * Render the request counters of @fc as OpenMetrics text
+ *
+ * The text holds the per-method counters of
+ * flickcurl_get_method_metrics() with a latency histogram, the time
+ * spent waiting for the request delay, the request hedging counts and
+ * the current request delay and concurrency window.  It is ended by
+ * "# EOF" as required for an OpenMetrics exposition.
+ *
+ * As with snprintf(), at most @buffer_size bytes are written including
+ * a terminating NUL and the full length is returned, so a result of
+ * @buffer_size or more means the text was truncated.
+ *
+ * Return value: length of the full text not counting the NUL
+ **/
+size_t
+flickcurl_render_openmetrics(flickcurl* fc, char* buffer, size_t buffer_size)
+{
+  flickcurl_metrics_text text;
+  flickcurl_metrics_entry* entry;
+  int hedge_requests = 0;
+  int hedged_count = 0;
+  int hedge_wins = 0;
+
+  text.buffer = buffer;
+  text.size = buffer ? buffer_size : 0;
+  text.len = 0;
+
+  flickcurl_metrics_text_family(&text, "flickcurl_requests", "counter",
+                                "Web service requests made");
+  for(entry = fc->metrics; entry; entry = entry->next) {
+    flickcurl_metrics_text_sample(&text, "flickcurl_requests_total",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, entry->requests);
+  }
+
+  flickcurl_metrics_text_family(&text, "flickcurl_request_errors", "counter",
+                                "Web service requests that failed");
+  for(entry = fc->metrics; entry; entry = entry->next) {
+    flickcurl_metrics_text_sample(&text, "flickcurl_request_errors_total",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, entry->errors);
+  }
+
+  flickcurl_metrics_text_family(&text, "flickcurl_http_responses", "counter",
+                                "HTTP responses by status code");
+  for(entry = fc->metrics; entry; entry = entry->next)
+    flickcurl_metrics_text_codes(&text, "flickcurl_http_responses_total",
+                                 entry->method, entry->status_codes,
+                                 entry->status_codes_count,
+                                 entry->status_codes_other);
+
+  flickcurl_metrics_text_family(&text, "flickcurl_api_errors", "counter",
+                                "Flickr API errors by error code");
+  for(entry = fc->metrics; entry; entry = entry->next)
+    flickcurl_metrics_text_codes(&text, "flickcurl_api_errors_total",
+                                 entry->method, entry->error_codes,
+                                 entry->error_codes_count,
+                                 entry->error_codes_other);
+
+  flickcurl_metrics_text_family(&text, "flickcurl_response_wire_bytes",
+                                "counter",
+                                "Response body bytes received");
+  for(entry = fc->metrics; entry; entry = entry->next) {
+    flickcurl_metrics_text_sample(&text, "flickcurl_response_wire_bytes_total",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, entry->wire_bytes);
+  }
+
+  flickcurl_metrics_text_family(&text, "flickcurl_response_decoded_bytes",
+                                "counter",
+                                "Response body bytes after decompression");
+  for(entry = fc->metrics; entry; entry = entry->next) {
+    flickcurl_metrics_text_sample(&text,
+                                  "flickcurl_response_decoded_bytes_total",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, entry->decoded_bytes);
+  }
+
+  flickcurl_metrics_text_family(&text, "flickcurl_request_delay_seconds",
+                                "counter",
+                                "Time waited before requests for the request delay");
+  for(entry = fc->metrics; entry; entry = entry->next) {
+    flickcurl_metrics_text_sample(&text,
+                                  "flickcurl_request_delay_seconds_total",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, entry->delay_sum / 1000000.0);
+  }
+
+  flickcurl_metrics_text_family(&text, "flickcurl_request_duration_seconds",
+                                "histogram",
+                                "Latency of completed web service requests");
+  for(entry = fc->metrics; entry; entry = entry->next) {
+    unsigned long cumulative = 0;
+    int bucket = 0;
+    int k;
+
+    for(k = METRICS_LE_FIRST; k <= METRICS_LE_LAST; k++) {
+      long le = 1L << k;
+      int end = flickcurl_metrics_bucket(le);
+      char label[48];
+
+      /* buckets before that of 2^k hold the values below 2^k */
+      while(bucket < end)
+        cumulative += entry->buckets[bucket++];
+
+      flickcurl_metrics_text_sample(&text,
+                                    "flickcurl_request_duration_seconds_bucket",
+                                    entry->method);
+      sprintf(label, ",le=\"%ld.%06ld\"}", le / 1000000L, le % 1000000L);
+      flickcurl_metrics_text_puts(&text, label);
+      flickcurl_metrics_text_number(&text, (double)cumulative);
+    }
+    flickcurl_metrics_text_sample(&text,
+                                  "flickcurl_request_duration_seconds_bucket",
+                                  entry->method);
+    flickcurl_metrics_text_puts(&text, ",le=\"+Inf\"}");
+    flickcurl_metrics_text_number(&text, (double)entry->latency_count);
+
+    flickcurl_metrics_text_sample(&text,
+                                  "flickcurl_request_duration_seconds_count",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, (double)entry->latency_count);
+
+    flickcurl_metrics_text_sample(&text,
+                                  "flickcurl_request_duration_seconds_sum",
+                                  entry->method);
+    flickcurl_metrics_text_append(&text, "}", 1);
+    flickcurl_metrics_text_number(&text, entry->latency_sum / 1000000.0);
+  }
+
+  flickcurl_get_hedge_stats(fc, &hedge_requests, &hedged_count, &hedge_wins);
+  flickcurl_metrics_text_family(&text, "flickcurl_hedge_reads", "counter",
+                                "Read requests made while hedging");
+  flickcurl_metrics_text_puts(&text, "flickcurl_hedge_reads_total");
+  flickcurl_metrics_text_number(&text, hedge_requests);
+  flickcurl_metrics_text_family(&text, "flickcurl_hedge_duplicates",
+                                "counter", "Duplicate read requests sent");
+  flickcurl_metrics_text_puts(&text, "flickcurl_hedge_duplicates_total");
+  flickcurl_metrics_text_number(&text, hedged_count);
+  flickcurl_metrics_text_family(&text, "flickcurl_hedge_wins", "counter",
+                                "Duplicate read requests answered first");
+  flickcurl_metrics_text_puts(&text, "flickcurl_hedge_wins_total");
+  flickcurl_metrics_text_number(&text, hedge_wins);
+
+  flickcurl_metrics_text_family(&text, "flickcurl_request_delay_target_seconds",
+                                "gauge",
+                                "Current minimum time between requests");
+  flickcurl_metrics_text_puts(&text, "flickcurl_request_delay_target_seconds");
+  flickcurl_metrics_text_number(&text, fc->request_delay / 1000.0);
+
+  flickcurl_metrics_text_family(&text, "flickcurl_concurrency_limit", "gauge",
+                                "Requests that should be in flight at once");
+  flickcurl_metrics_text_puts(&text, "flickcurl_concurrency_limit");
+  flickcurl_metrics_text_number(&text, flickcurl_get_concurrency_limit(fc));
+
+  flickcurl_metrics_text_puts(&text, "# EOF\n");
+
+  if(text.size)
+    text.buffer[text.len < text.size ? text.len : text.size - 1] = '\0';
+
+  return text.len;
+}
@@ -0,0 +1,791 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * mutation-batch.c - Flickcurl coalescing of photoset, gallery and tag writes
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#include <time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+#define BATCH_TARGET_PHOTOSET 1
+#define BATCH_TARGET_GALLERY 2
+#define BATCH_TARGET_TAGS 3
+
+/* Maximum page size of the membership list APIs */
+#define BATCH_PER_PAGE 500
+
+/* Photoset adds up to this many are cheaper one by one than fetching
+ * the membership and calling editPhotos
+ */
+#define BATCH_PHOTOSET_MAX_SINGLE_ADDS 2
+
+/* Initial size of the target and photo ID hashes */
+#define BATCH_HASH_INITIAL_SIZE 64
+
+
+static char*
+flickcurl_batch_strdup(const char* string)
+{
+  size_t len = strlen(string);
+  char* copy = (char*)malloc(len + 1);
+
+  if(copy)
+    memcpy(copy, string, len + 1);
+  return copy;
+}
+
+
+static unsigned int
+flickcurl_batch_hash(const char* string, unsigned int hash)
+{
+  while(*string)
+    hash = (hash * 33) ^ (unsigned char)*string++;
+
+  return hash;
+}
+
+
+/* size of an open addressed hash for @count entries */
+static unsigned int
+flickcurl_batch_slots_size(int count)
+{
+  unsigned int size = BATCH_HASH_INITIAL_SIZE;
+
+  while(size < (unsigned int)count * 2)
+    size <<= 1;
+
+  return size;
+}
+
+
+static void
+flickcurl_batch_free_target(flickcurl_mutation_batch_target* target)
+{
+  int i;
+
+  for(i = 0; i < target->ops_count; i++)
+    free(target->ops[i].photo_id);
+  if(target->ops)
+    free(target->ops);
+  if(target->op_slots)
+    free(target->op_slots);
+  if(target->tags)
+    free(target->tags);
+  free(target->id);
+  free(target);
+}
+
+
+static int
+flickcurl_batch_grow_targets(flickcurl_mutation_batch* batch)
+{
+  unsigned int new_size = batch->target_buckets_size ?
+    batch->target_buckets_size << 1 : BATCH_HASH_INITIAL_SIZE;
+  flickcurl_mutation_batch_target** new_buckets;
+  flickcurl_mutation_batch_target* target;
+
+  new_buckets = (flickcurl_mutation_batch_target**)calloc(new_size,
+                                                          sizeof(flickcurl_mutation_batch_target*));
+  if(!new_buckets)
+    return 1;
+
+  for(target = batch->targets; target; target = target->next) {
+    unsigned int bucket = target->hash & (new_size - 1);
+
+    target->hash_next = new_buckets[bucket];
+    new_buckets[bucket] = target;
+  }
+
+  if(batch->target_buckets)
+    free(batch->target_buckets);
+  batch->target_buckets = new_buckets;
+  batch->target_buckets_size = new_size;
+
+  return 0;
+}
+
+
+static flickcurl_mutation_batch_target*
+flickcurl_batch_get_target(flickcurl_mutation_batch* batch, int type,
+                           const char* id)
+{
+  flickcurl_mutation_batch_target* target;
+  unsigned int hash = flickcurl_batch_hash(id, 5381 + (unsigned int)type);
+  unsigned int bucket;
+
+  if(batch->target_buckets_size) {
+    bucket = hash & (batch->target_buckets_size - 1);
+    for(target = batch->target_buckets[bucket]; target;
+        target = target->hash_next) {
+      if(target->hash == hash && target->type == type &&
+         !strcmp(target->id, id))
+        return target;
+    }
+  }
+
+  if((unsigned int)batch->targets_count >= batch->target_buckets_size &&
+     flickcurl_batch_grow_targets(batch))
+    return NULL;
+
+  target = (flickcurl_mutation_batch_target*)calloc(1, sizeof(*target));
+  if(!target)
+    return NULL;
+  target->type = type;
+  target->hash = hash;
+  target->id = flickcurl_batch_strdup(id);
+  if(!target->id) {
+    free(target);
+    return NULL;
+  }
+
+  target->next = batch->targets;
+  batch->targets = target;
+  bucket = hash & (batch->target_buckets_size - 1);
+  target->hash_next = batch->target_buckets[bucket];
+  batch->target_buckets[bucket] = target;
+  batch->targets_count++;
+
+  return target;
+}
+
+
+/*
+ * flickcurl_batch_find_op:
+ * @target: target
+ * @photo_id: photo ID
+ * @hash: hash of @photo_id
+ *
+ * INTERNAL - find the queued op for a photo or the free slot for it
+ *
+ * Return value: op slot index; the slot is 0 if there is no op
+ */
+static unsigned int
+flickcurl_batch_find_op(flickcurl_mutation_batch_target* target,
+                        const char* photo_id, unsigned int hash)
+{
+  unsigned int mask = target->op_slots_size - 1;
+  unsigned int slot = hash & mask;
+
+  while(target->op_slots[slot]) {
+    flickcurl_mutation_batch_op* op = &target->ops[target->op_slots[slot] - 1];
+
+    if(op->hash == hash && !strcmp(op->photo_id, photo_id))
+      break;
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+
+static int
+flickcurl_batch_grow_op_slots(flickcurl_mutation_batch_target* target)
+{
+  unsigned int new_size = flickcurl_batch_slots_size(target->ops_count + 1);
+  int* new_slots;
+  int i;
+
+  new_slots = (int*)calloc(new_size, sizeof(int));
+  if(!new_slots)
+    return 1;
+
+  if(target->op_slots)
+    free(target->op_slots);
+  target->op_slots = new_slots;
+  target->op_slots_size = new_size;
+
+  for(i = 0; i < target->ops_count; i++) {
+    unsigned int slot = flickcurl_batch_find_op(target, target->ops[i].photo_id,
+                                                target->ops[i].hash);
+    target->op_slots[slot] = i + 1;
+  }
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_batch_queued:
+ * @batch: mutation batch
+ *
+ * INTERNAL - note a queued mutation and flush if a threshold is reached
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_batch_queued(flickcurl_mutation_batch* batch)
+{
+  time_t now = time(NULL);
+
+  if(!batch->ops_count++)
+    batch->oldest_time = now;
+
+  if((batch->max_ops > 0 && batch->ops_count >= batch->max_ops) ||
+     (batch->max_age > 0 && now - batch->oldest_time >= batch->max_age))
+    return flickcurl_mutation_batch_flush(batch);
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_batch_add_membership:
+ * @batch: mutation batch
+ * @type: BATCH_TARGET_PHOTOSET or BATCH_TARGET_GALLERY
+ * @target_id: photoset or gallery ID
+ * @photo_id: photo ID
+ * @add: non-0 to add, 0 to remove
+ *
+ * INTERNAL - queue a membership change, replacing any earlier change
+ * for the same photo so only the final state is sent
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_batch_add_membership(flickcurl_mutation_batch* batch, int type,
+                               const char* target_id, const char* photo_id,
+                               int add)
+{
+  flickcurl_mutation_batch_target* target;
+  unsigned int hash;
+  unsigned int slot;
+
+  if(!target_id || !photo_id)
+    return 1;
+
+  target = flickcurl_batch_get_target(batch, type, target_id);
+  if(!target)
+    return 1;
+
+  if((unsigned int)(target->ops_count + 1) * 2 > target->op_slots_size &&
+     flickcurl_batch_grow_op_slots(target))
+    return 1;
+
+  hash = flickcurl_batch_hash(photo_id, 5381);
+  slot = flickcurl_batch_find_op(target, photo_id, hash);
+  if(target->op_slots[slot]) {
+    target->ops[target->op_slots[slot] - 1].add = add;
+    return flickcurl_batch_queued(batch);
+  }
+
+  if(target->ops_count == target->ops_size) {
+    int new_size = target->ops_size ? target->ops_size << 1 : 16;
+    flickcurl_mutation_batch_op* new_ops;
+
+    new_ops = (flickcurl_mutation_batch_op*)realloc(target->ops,
+                                                    new_size * sizeof(flickcurl_mutation_batch_op));
+    if(!new_ops)
+      return 1;
+    target->ops = new_ops;
+    target->ops_size = new_size;
+  }
+
+  target->ops[target->ops_count].photo_id = flickcurl_batch_strdup(photo_id);
+  if(!target->ops[target->ops_count].photo_id)
+    return 1;
+  target->ops[target->ops_count].hash = hash;
+  target->ops[target->ops_count].add = add;
+  target->op_slots[slot] = ++target->ops_count;
+
+  return flickcurl_batch_queued(batch);
+}
+
+
+/*
+ * flickcurl_batch_get_members:
+ * @fc: flickcurl context
+ * @type: BATCH_TARGET_PHOTOSET or BATCH_TARGET_GALLERY
+ * @target_id: photoset or gallery ID
+ * @primary_p: pointer to store new primary photo ID
+ * @count_p: pointer to store number of photo IDs
+ *
+ * INTERNAL - fetch the current photo IDs and primary photo of a target
+ *
+ * Return value: new array of photo IDs or NULL on failure
+ */
+static char**
+flickcurl_batch_get_members(flickcurl* fc, int type, const char* target_id,
+                            char** primary_p, int* count_p)
+{
+  flickcurl_photos_list_params list_params;
+  char** ids = NULL;
+  int ids_count = 0;
+  int ids_size = 0;
+  int page;
+
+  *primary_p = NULL;
+
+  if(type == BATCH_TARGET_PHOTOSET) {
+    flickcurl_photoset* photoset = flickcurl_photosets_getInfo(fc, target_id);
+
+    if(!photoset)
+      return NULL;
+    if(photoset->primary)
+      *primary_p = flickcurl_batch_strdup(photoset->primary);
+    flickcurl_free_photoset(photoset);
+  } else {
+    flickcurl_gallery* gallery = flickcurl_galleries_getInfo(fc, target_id);
+
+    if(!gallery)
+      return NULL;
+    if(gallery->primary_photo && gallery->primary_photo->id)
+      *primary_p = flickcurl_batch_strdup(gallery->primary_photo->id);
+    flickcurl_free_gallery(gallery);
+  }
+
+  flickcurl_photos_list_params_init(&list_params);
+  list_params.per_page = BATCH_PER_PAGE;
+
+  for(page = 1; ; page++) {
+    flickcurl_photos_list* photos_list;
+    int i;
+
+    list_params.page = page;
+    if(type == BATCH_TARGET_PHOTOSET)
+      photos_list = flickcurl_photosets_getPhotos_params(fc, target_id, -1,
+                                                         &list_params);
+    else
+      photos_list = flickcurl_galleries_getPhotos_params(fc, target_id,
+                                                         &list_params);
+    if(!photos_list)
+      goto failed;
+
+    if(ids_count + photos_list->photos_count + 1 > ids_size) {
+      int new_size = ids_count + photos_list->photos_count + 1;
+      char** new_ids = (char**)realloc(ids, new_size * sizeof(char*));
+
+      if(!new_ids) {
+        flickcurl_free_photos_list(photos_list);
+        goto failed;
+      }
+      ids = new_ids;
+      ids_size = new_size;
+    }
+
+    /* steal the photo IDs */
+    for(i = 0; i < photos_list->photos_count; i++) {
+      ids[ids_count++] = photos_list->photos[i]->id;
+      photos_list->photos[i]->id = NULL;
+    }
+    ids[ids_count] = NULL;
+    flickcurl_free_photos_list(photos_list);
+
+    if(i < BATCH_PER_PAGE)
+      break;
+  }
+
+  *count_p = ids_count;
+  return ids;
+
+  failed:
+  if(ids) {
+    while(ids_count--)
+      free(ids[ids_count]);
+    free(ids);
+  }
+  if(*primary_p) {
+    free(*primary_p);
+    *primary_p = NULL;
+  }
+  return NULL;
+}
+
+
+/*
+ * flickcurl_batch_flush_membership:
+ * @batch: mutation batch
+ * @target: photoset or gallery target
+ *
+ * INTERNAL - send the queued membership changes for one target
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_batch_flush_membership(flickcurl_mutation_batch* batch,
+                                 flickcurl_mutation_batch_target* target)
+{
+  flickcurl* fc = batch->fc;
+  char** members = NULL;
+  const char** photo_ids = NULL;
+  char* primary = NULL;
+  int* member_slots = NULL;
+  unsigned int member_slots_size;
+  int members_count = 0;
+  int adds = 0;
+  int removes = 0;
+  int photo_ids_count = 0;
+  int rc = 1;
+  int i;
+
+  for(i = 0; i < target->ops_count; i++) {
+    if(target->ops[i].add)
+      adds++;
+    else
+      removes++;
+  }
+
+  /* photosets have calls for these that need no membership fetch */
+  if(target->type == BATCH_TARGET_PHOTOSET && !removes &&
+     adds <= BATCH_PHOTOSET_MAX_SINGLE_ADDS) {
+    for(i = 0; i < target->ops_count; i++) {
+      if(flickcurl_photosets_addPhoto(fc, target->id, target->ops[i].photo_id))
+        return 1;
+    }
+    return 0;
+  }
+
+  if(target->type == BATCH_TARGET_PHOTOSET && !adds) {
+    photo_ids = (const char**)calloc(removes + 1, sizeof(char*));
+    if(!photo_ids)
+      return 1;
+    for(i = 0; i < target->ops_count; i++)
+      photo_ids[photo_ids_count++] = target->ops[i].photo_id;
+    rc = flickcurl_photosets_removePhotos(fc, target->id, photo_ids);
+    free(photo_ids);
+    return rc;
+  }
+
+  members = flickcurl_batch_get_members(fc, target->type, target->id,
+                                        &primary, &members_count);
+  if(!members)
+    return 1;
+
+  photo_ids = (const char**)calloc(members_count + adds + 1, sizeof(char*));
+  member_slots_size = flickcurl_batch_slots_size(members_count);
+  member_slots = (int*)calloc(member_slots_size, sizeof(int));
+  if(!photo_ids || !member_slots)
+    goto tidy;
+
+  /* current members that are not removed, in their current order */
+  for(i = 0; i < members_count; i++) {
+    unsigned int hash = flickcurl_batch_hash(members[i], 5381);
+    unsigned int slot;
+    int op;
+
+    slot = hash & (member_slots_size - 1);
+    while(member_slots[slot])
+      slot = (slot + 1) & (member_slots_size - 1);
+    member_slots[slot] = i + 1;
+
+    op = target->op_slots[flickcurl_batch_find_op(target, members[i], hash)];
+    if(op && !target->ops[op - 1].add)
+      continue;
+    photo_ids[photo_ids_count++] = members[i];
+  }
+
+  /* then the new photos in the order they were added */
+  for(i = 0; i < target->ops_count; i++) {
+    unsigned int slot;
+
+    if(!target->ops[i].add)
+      continue;
+
+    slot = target->ops[i].hash & (member_slots_size - 1);
+    while(member_slots[slot] &&
+          strcmp(members[member_slots[slot] - 1], target->ops[i].photo_id))
+      slot = (slot + 1) & (member_slots_size - 1);
+    if(!member_slots[slot])
+      photo_ids[photo_ids_count++] = target->ops[i].photo_id;
+  }
+
+  if(!photo_ids_count) {
+    flickcurl_error(fc, "Cannot remove every photo from %s %s",
+                    target->type == BATCH_TARGET_PHOTOSET ? "photoset" : "gallery",
+                    target->id);
+    goto tidy;
+  }
+
+  /* keep the primary photo unless it was removed */
+  for(i = 0; primary && i < photo_ids_count; i++) {
+    if(!strcmp(photo_ids[i], primary))
+      break;
+  }
+  if(!primary || i == photo_ids_count) {
+    if(primary)
+      free(primary);
+    primary = flickcurl_batch_strdup(photo_ids[0]);
+    if(!primary)
+      goto tidy;
+  }
+
+  if(target->type == BATCH_TARGET_PHOTOSET)
+    rc = flickcurl_photosets_editPhotos(fc, target->id, primary, photo_ids);
+  else
+    rc = flickcurl_galleries_editPhotos(fc, target->id, primary, photo_ids);
+
+  tidy:
+  if(photo_ids)
+    free(photo_ids);
+  if(member_slots)
+    free(member_slots);
+  for(i = 0; i < members_count; i++)
+    free(members[i]);
+  free(members);
+  if(primary)
+    free(primary);
+
+  return rc;
+}
+
+
+/**
+ * flickcurl_new_mutation_batch:
+ * @fc: flickcurl context
+ * @max_ops: flush when this many mutations are queued (or <=0 for no limit)
+ * @max_age: flush when the oldest queued mutation is this many seconds old (or <=0 for no limit)
+ *
+ * Create a batch that coalesces photoset, gallery and tag mutations
+ *
+ * Queued changes are merged per photoset, gallery or photo into the
+ * fewest web service calls when the batch is flushed: photoset and
+ * gallery membership changes become a single editPhotos call after
+ * one fetch of the current membership (or removePhotos or a few
+ * addPhoto calls for photosets when that is cheaper) and all tags
+ * added to a photo become one addTags call.
+ *
+ * The thresholds are checked as mutations are queued; call
+ * flickcurl_mutation_batch_flush() to send the rest.
+ *
+ * Return value: new mutation batch or NULL on failure
+ **/
+flickcurl_mutation_batch*
+flickcurl_new_mutation_batch(flickcurl* fc, int max_ops, int max_age)
+{
+  flickcurl_mutation_batch* batch;
+
+  batch = (flickcurl_mutation_batch*)calloc(1, sizeof(*batch));
+  if(!batch)
+    return NULL;
+
+  batch->fc = fc;
+  batch->max_ops = max_ops;
+  batch->max_age = max_age;
+
+  return batch;
+}
+
+
+/**
+ * flickcurl_free_mutation_batch:
+ * @batch: mutation batch
+ *
+ * Destructor for mutation batch
+ *
+ * Mutations still queued are discarded; flush first to send them.
+ */
+void
+flickcurl_free_mutation_batch(flickcurl_mutation_batch* batch)
+{
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(batch, flickcurl_mutation_batch);
+
+  while(batch->targets) {
+    flickcurl_mutation_batch_target* next = batch->targets->next;
+
+    flickcurl_batch_free_target(batch->targets);
+    batch->targets = next;
+  }
+  if(batch->target_buckets)
+    free(batch->target_buckets);
+
+  free(batch);
+}
+
+
+/**
+ * flickcurl_mutation_batch_photosets_addPhoto:
+ * @batch: mutation batch
+ * @photoset_id: photoset ID
+ * @photo_id: photo ID
+ *
+ * Queue adding a photo to the end of a photoset
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_mutation_batch_photosets_addPhoto(flickcurl_mutation_batch* batch,
+                                            const char* photoset_id,
+                                            const char* photo_id)
+{
+  return flickcurl_batch_add_membership(batch, BATCH_TARGET_PHOTOSET,
+                                        photoset_id, photo_id, 1);
+}
+
+
+/**
+ * flickcurl_mutation_batch_photosets_removePhoto:
+ * @batch: mutation batch
+ * @photoset_id: photoset ID
+ * @photo_id: photo ID
+ *
+ * Queue removing a photo from a photoset
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_mutation_batch_photosets_removePhoto(flickcurl_mutation_batch* batch,
+                                               const char* photoset_id,
+                                               const char* photo_id)
+{
+  return flickcurl_batch_add_membership(batch, BATCH_TARGET_PHOTOSET,
+                                        photoset_id, photo_id, 0);
+}
+
+
+/**
+ * flickcurl_mutation_batch_galleries_addPhoto:
+ * @batch: mutation batch
+ * @gallery_id: gallery ID
+ * @photo_id: photo ID
+ *
+ * Queue adding a photo to the end of a gallery
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_mutation_batch_galleries_addPhoto(flickcurl_mutation_batch* batch,
+                                            const char* gallery_id,
+                                            const char* photo_id)
+{
+  return flickcurl_batch_add_membership(batch, BATCH_TARGET_GALLERY,
+                                        gallery_id, photo_id, 1);
+}
+
+
+/**
+ * flickcurl_mutation_batch_galleries_removePhoto:
+ * @batch: mutation batch
+ * @gallery_id: gallery ID
+ * @photo_id: photo ID
+ *
+ * Queue removing a photo from a gallery
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_mutation_batch_galleries_removePhoto(flickcurl_mutation_batch* batch,
+                                               const char* gallery_id,
+                                               const char* photo_id)
+{
+  return flickcurl_batch_add_membership(batch, BATCH_TARGET_GALLERY,
+                                        gallery_id, photo_id, 0);
+}
+
+
+/**
+ * flickcurl_mutation_batch_photos_addTags:
+ * @batch: mutation batch
+ * @photo_id: photo ID
+ * @tags: space-separated tags as for flickcurl_photos_addTags()
+ *
+ * Queue adding tags to a photo
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_mutation_batch_photos_addTags(flickcurl_mutation_batch* batch,
+                                        const char* photo_id,
+                                        const char* tags)
+{
+  flickcurl_mutation_batch_target* target;
+  size_t old_len;
+  size_t len;
+  char* new_tags;
+
+  if(!photo_id || !tags)
+    return 1;
+
+  target = flickcurl_batch_get_target(batch, BATCH_TARGET_TAGS, photo_id);
+  if(!target)
+    return 1;
+
+  old_len = target->tags ? strlen(target->tags) : 0;
+  len = strlen(tags);
+  new_tags = (char*)realloc(target->tags, old_len + 1 + len + 1);
+  if(!new_tags)
+    return 1;
+
+  if(old_len)
+    new_tags[old_len++] = ' ';
+  memcpy(new_tags + old_len, tags, len + 1);
+  target->tags = new_tags;
+
+  return flickcurl_batch_queued(batch);
+}
+
+
+/**
+ * flickcurl_mutation_batch_flush:
+ * @batch: mutation batch
+ *
+ * Send all queued mutations as merged bulk calls
+ *
+ * Every target is attempted even if one fails; the queue is empty
+ * afterwards either way.
+ *
+ * Return value: non-0 if any call failed
+ **/
+int
+flickcurl_mutation_batch_flush(flickcurl_mutation_batch* batch)
+{
+  flickcurl_mutation_batch_target* targets;
+  int rc = 0;
+
+  /* detach first so a failing target is not retried forever */
+  targets = batch->targets;
+  batch->targets = NULL;
+  batch->targets_count = 0;
+  if(batch->target_buckets_size)
+    memset(batch->target_buckets, '\0',
+           batch->target_buckets_size * sizeof(flickcurl_mutation_batch_target*));
+  batch->ops_count = 0;
+
+  while(targets) {
+    flickcurl_mutation_batch_target* next = targets->next;
+
+    if(targets->type == BATCH_TARGET_TAGS) {
+      if(flickcurl_photos_addTags(batch->fc, targets->id, targets->tags))
+        rc = 1;
+    } else if(targets->ops_count) {
+      if(flickcurl_batch_flush_membership(batch, targets))
+        rc = 1;
+    }
+
+    flickcurl_batch_free_target(targets);
+    targets = next;
+  }
+
+  return rc;
+}
@@ -0,0 +1,230 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * pacing.c - Flickcurl adaptive request pacing
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * Additive increase, multiplicative decrease: every healthy response
+ * raises the request rate by a constant; a throttled, failed or slow
+ * response halves the rate and the concurrency window.  Decreases
+ * wait for a window of responses since the last one so that a burst
+ * of errors from requests already sent only counts once.
+ *
+ * Slowness is judged against the history of the same method, kept in
+ * the per-method latency records shared with hedging, since a large
+ * search is normally much slower than a getInfo.
+ */
+
+/* Requests per second added for each healthy response */
+#define PACING_RATE_STEP 0.05
+
+/* Responses slower than this multiple of the baseline are congestion */
+#define PACING_LATENCY_FACTOR 2
+
+/* Responses needed before latency is used as a signal */
+#define PACING_LATENCY_WARMUP 8
+
+/* Flickr error code: service currently unavailable */
+#define FLICKR_ERROR_SERVICE_UNAVAILABLE 105
+
+
+static void
+flickcurl_pacing_set_rate(flickcurl* fc, double rate)
+{
+  double max_rate;
+  double min_rate;
+
+  /* a 0 minimum delay still allows at most one request per msec */
+  max_rate = 1000.0 / (fc->pacing_min_delay > 0 ? fc->pacing_min_delay : 1);
+  min_rate = 1000.0 / fc->pacing_max_delay;
+
+  if(rate > max_rate)
+    rate = max_rate;
+  if(rate < min_rate)
+    rate = min_rate;
+
+  fc->pacing_rate = rate;
+  fc->request_delay = (long)(1000.0 / rate);
+  if(fc->request_delay < fc->pacing_min_delay)
+    fc->request_delay = fc->pacing_min_delay;
+}
+
+
+/*
+ * flickcurl_pacing_update:
+ * @fc: flickcurl context
+ * @latency_usec: time the request took or <0 if it did not complete
+ *
+ * INTERNAL - adjust the request delay and concurrency window after a
+ * web service response
+ */
+void
+flickcurl_pacing_update(flickcurl* fc, long latency_usec)
+{
+  flickcurl_method_latency* ml;
+  int congested = 0;
+
+  if(!fc->adaptive_pacing)
+    return;
+
+  if(latency_usec < 0)
+    congested = 1;
+  else if(fc->status_code == 429 || fc->status_code == 503 ||
+          fc->error_code == FLICKR_ERROR_SERVICE_UNAVAILABLE)
+    congested = 1;
+  else if(fc->method &&
+          (ml = flickcurl_get_method_latency(fc, fc->method))) {
+    double latency = (double)latency_usec;
+
+    if(!ml->pacing_samples++) {
+      ml->pacing_latency = latency;
+      ml->pacing_base_latency = latency;
+    } else {
+      ml->pacing_latency += (latency - ml->pacing_latency) / 8;
+
+      /* track the fastest responses but let the baseline drift up
+       * slowly in case the route to the service changed
+       */
+      if(latency < ml->pacing_base_latency)
+        ml->pacing_base_latency = latency;
+      else
+        ml->pacing_base_latency += (latency - ml->pacing_base_latency) / 64;
+    }
+
+    if(ml->pacing_samples > PACING_LATENCY_WARMUP &&
+       ml->pacing_latency > PACING_LATENCY_FACTOR * ml->pacing_base_latency)
+      congested = 1;
+  }
+
+  fc->pacing_responses++;
+
+  if(congested) {
+    if(fc->pacing_responses < fc->concurrency_limit)
+      return;
+
+    flickcurl_pacing_set_rate(fc, fc->pacing_rate / 2);
+    fc->concurrency_limit /= 2;
+    if(fc->concurrency_limit < 1)
+      fc->concurrency_limit = 1;
+    fc->pacing_responses = 0;
+    fc->pacing_acks = 0;
+    return;
+  }
+
+  fc->pacing_acks++;
+
+  flickcurl_pacing_set_rate(fc, fc->pacing_rate + PACING_RATE_STEP);
+
+  /* one more request in flight per window of healthy responses */
+  if(fc->pacing_acks >= fc->concurrency_limit) {
+    if(fc->concurrency_limit < fc->pacing_max_concurrency)
+      fc->concurrency_limit++;
+    fc->pacing_acks = 0;
+  }
+}
+
+
+/**
+ * flickcurl_set_adaptive_pacing:
+ * @fc: flickcurl object
+ * @min_delay_msec: smallest request delay to use in milliseconds
+ * @max_delay_msec: largest request delay to use in milliseconds (or <=0 to turn off adaptive pacing)
+ * @max_concurrency: largest concurrency window to suggest
+ *
+ * Set the request delay automatically from web service responses
+ *
+ * When enabled, the delay set by flickcurl_set_request_delay() is the
+ * starting point.  HTTP 429 and 503 responses, the Flickr service
+ * unavailable error, transport failures and latency rising well above
+ * the fastest recent responses of the same method halve the request
+ * rate; each healthy response increases it by a small constant step.
+ *
+ * The same signals drive a concurrency window returned by
+ * flickcurl_get_concurrency_limit() for applications that spread work
+ * over several flickcurl objects.
+ */
+void
+flickcurl_set_adaptive_pacing(flickcurl* fc, long min_delay_msec,
+                              long max_delay_msec, int max_concurrency)
+{
+  flickcurl_method_latency* ml;
+
+  if(max_delay_msec <= 0) {
+    fc->adaptive_pacing = 0;
+    return;
+  }
+
+  if(min_delay_msec < 0)
+    min_delay_msec = 0;
+  if(min_delay_msec > max_delay_msec)
+    min_delay_msec = max_delay_msec;
+  if(max_concurrency < 1)
+    max_concurrency = 1;
+
+  fc->adaptive_pacing = 1;
+  fc->pacing_min_delay = min_delay_msec;
+  fc->pacing_max_delay = max_delay_msec;
+  fc->pacing_max_concurrency = max_concurrency;
+  fc->concurrency_limit = 1;
+  fc->pacing_responses = 0;
+  fc->pacing_acks = 0;
+  for(ml = fc->method_latencies; ml; ml = ml->next)
+    ml->pacing_samples = 0;
+
+  flickcurl_pacing_set_rate(fc, 1000.0 / (fc->request_delay > 0 ?
+                                          fc->request_delay : 1));
+}
+
+
+/**
+ * flickcurl_get_concurrency_limit:
+ * @fc: flickcurl object
+ *
+ * Get the number of requests that should be in flight at once
+ *
+ * Return value: concurrency window from adaptive pacing or 1 if it is off
+ **/
+int
+flickcurl_get_concurrency_limit(flickcurl* fc)
+{
+  if(!fc->adaptive_pacing)
+    return 1;
+
+  return fc->concurrency_limit;
+}
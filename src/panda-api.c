@@ -153,6 +153,8 @@ flickcurl_panda_getList(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     pandas = NULL;
 
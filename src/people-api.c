@@ -129,6 +129,9 @@ flickcurl_people_getInfo(flickcurl* fc, const char* user_id)
  tidy:
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
+
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     person = NULL;
 
@@ -186,6 +189,8 @@ flickcurl_people_getPublicGroups(flickcurl* fc, const char* user_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     groups = NULL;
 
@@ -227,7 +232,7 @@ flickcurl_people_getPublicPhotos_params(flickcurl* fc, const char* user_id,
   parameters[count++][1]= user_id;
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -335,6 +340,8 @@ flickcurl_people_getUploadStatus(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     status = NULL;
 
@@ -420,7 +427,7 @@ flickcurl_people_getPhotos_params(flickcurl* fc, const char* user_id,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -538,7 +545,7 @@ flickcurl_people_getPhotosOf_params(flickcurl* fc, const char* user_id,
   parameters[count++][1]= user_id;
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
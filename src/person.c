@@ -93,14 +93,14 @@ flickcurl_free_person(flickcurl_person *person)
 
   FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(person, flickcurl_person);
 
-  for(i = 0; i <= PERSON_FIELD_LAST; i++) {
-    if(person->fields[i].string)
-      free(person->fields[i].string);
-  }
+  for(i = 0; i <= PERSON_FIELD_LAST; i++)
+    flickcurl_intern_release(person->intern, person->fields[i].string);
   
   if(person->nsid)
     free(person->nsid);
   
+  flickcurl_intern_table_release(person->intern);
+
   free(person);
 }
 
@@ -229,6 +229,27 @@ static struct {
 };
 
 
+/*
+ * flickcurl_person_register_xpaths:
+ *
+ * INTERNAL - compile the person field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_person_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; person_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(person_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
 
 flickcurl_person**
 flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
@@ -239,6 +260,7 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   int person_count;
   xmlXPathObjectPtr xpathObj = NULL;
   xmlNodeSetPtr nodes;
+  xmlXPathContextPtr xpathNodeCtx = NULL;
   xmlChar full_xpath[512];
   size_t xpathExpr_len;
   int i;
@@ -246,7 +268,7 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   xpathExpr_len = strlen((const char*)xpathExpr);
   strncpy((char*)full_xpath, (const char*)xpathExpr, xpathExpr_len+1);
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -259,11 +281,18 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   nodes_count = xmlXPathNodeSetGetLength(nodes);
   persons = (flickcurl_person**)calloc(sizeof(flickcurl_person*), nodes_count+1);
 
+  /* one XPath context is moved to each node in turn */
+  xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
+  if(!xpathNodeCtx) {
+    flickcurl_error(fc, "Failed to create XPath context for document");
+    fc->failed = 1;
+    goto tidy;
+  }
+
   for(i = 0, person_count = 0; i < nodes_count; i++) {
     xmlNodePtr node = nodes->nodeTab[i];
     flickcurl_person* person;
     int expri;
-    xmlXPathContextPtr xpathNodeCtx = NULL;
     
     if(node->type != XML_ELEMENT_NODE) {
       flickcurl_error(fc, "Got unexpected node type %d", node->type);
@@ -273,8 +302,6 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     
     person = (flickcurl_person*)calloc(sizeof(flickcurl_person), 1);
 
-    /* set up a new XPath context relative to the current node */
-    xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
     xpathNodeCtx->node = node;
 
     for(expri = 0; expri <= PERSON_FIELD_LAST; expri++) {
@@ -291,6 +318,8 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
       char *string_value;
       int int_value= -1;
       time_t unix_time;
+      char isotime[FLICKCURL_ISOTIME_SIZE];
+      char* new_value;
       
       string_value = flickcurl_xpath_eval(fc, xpathNodeCtx,
                                         person_fields_table[expri].xpath);
@@ -311,18 +340,18 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
         case VALUE_TYPE_UNIXTIME:
         case VALUE_TYPE_DATETIME:
           
-          if(datatype == VALUE_TYPE_UNIXTIME)
-            unix_time = atoi(string_value);
-          else
-            unix_time = curl_getdate((const char*)string_value, NULL);
+          unix_time = flickcurl_date_to_isotime(fc, string_value,
+                                                (datatype == VALUE_TYPE_UNIXTIME),
+                                                isotime);
+          new_value = (unix_time >= 0) ?
+            (char*)realloc(string_value, FLICKCURL_ISOTIME_SIZE) : NULL;
           
-          if(unix_time >= 0) {
-            char* new_value = flickcurl_unixtime_to_isotime(unix_time);
+          if(new_value) {
 #if FLICKCURL_DEBUG > 1
             fprintf(stderr, "  date from: '%s' unix time %ld to '%s'\n",
-                    value, (long)unix_time, new_value);
+                    new_value, (long)unix_time, isotime);
 #endif
-            free(string_value);
+            memcpy(new_value, isotime, FLICKCURL_ISOTIME_SIZE);
             string_value= new_value;
             int_value= (int)unix_time;
             datatype = VALUE_TYPE_DATETIME;
@@ -351,6 +380,9 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
           abort();
       }
       
+      if(field == PERSON_FIELD_username || field == PERSON_FIELD_realname)
+        string_value = flickcurl_intern_string(fc, string_value, &person->intern);
+
       person->fields[field].string = string_value;
       person->fields[field].integer= (flickcurl_person_field_type)int_value;
       person->fields[field].type   = datatype;
@@ -372,6 +404,8 @@ flickcurl_build_persons(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     *person_count_p = person_count;
 
  tidy:
+  if(xpathNodeCtx)
+    xmlXPathFreeContext(xpathNodeCtx);
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
   
@@ -0,0 +1,1014 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * photo-binary.c - Flickcurl compact binary photo records
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#include <sys/mman.h>
+#define FLICKCURL_PHOTO_STORE_MMAP 1
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * Record layout.  All fixed width integers are little endian.
+ *
+ *  0  4 bytes  magic "FCPB"
+ *  4  u8       version
+ *  5  u8       flags: 1 place, 2 video, 4 place shape
+ *  6  u16      reserved (0)
+ *  8  u32      present fields bitmap bits 0-31
+ * 12  u32      present fields bitmap bits 32-63
+ * 16  u32      record length
+ * 20  u32      string table offset
+ * 24  u32      string table count
+ * 28  u32      tags section offset
+ * 32  u32      notes section offset
+ * 36  u32      place section offset (0 if none)
+ * 40  u32      video section offset (0 if none)
+ * 44           body sections
+ *
+ * Body sections are sequences of unsigned varints; signed values are
+ * zigzag encoded, doubles are 8 bytes and strings are references into
+ * the string table: 0 for NULL otherwise the string index plus 1.
+ *
+ * The string table is (count + 1) u32 offsets from the end of the
+ * offsets followed by the NUL terminated string bytes so strings can
+ * be returned as pointers into the record.
+ */
+
+#define PHOTO_BINARY_MAGIC "FCPB"
+#define PHOTO_BINARY_VERSION 1
+#define PHOTO_BINARY_HEADER_LEN 44
+
+#define PHOTO_BINARY_FLAG_PLACE 1
+#define PHOTO_BINARY_FLAG_VIDEO 2
+#define PHOTO_BINARY_FLAG_SHAPE 4
+
+/* the present fields bitmap has room for 64 fields; fails to compile
+ * if more are added without a new record version
+ */
+typedef char flickcurl_photo_binary_fields_check[(PHOTO_FIELD_LAST < 64) ? 1 : -1];
+
+
+typedef struct {
+  flickcurl_binary_buffer body;
+  flickcurl_binary_buffer strings;
+  flickcurl_binary_buffer offsets;
+  unsigned int strings_count;
+} flickcurl_binary_writer;
+
+
+typedef struct {
+  const unsigned char* data;
+  size_t pos;
+  size_t end;
+  const unsigned char* strings_offsets;
+  const unsigned char* strings;
+  unsigned int strings_count;
+  size_t strings_len;
+  int failed;
+} flickcurl_binary_reader;
+
+
+void
+flickcurl_binary_put_bytes(flickcurl_binary_buffer* buf,
+                           const void* bytes, size_t len)
+{
+  if(buf->failed)
+    return;
+
+  if(buf->len + len > buf->size) {
+    size_t new_size = buf->size ? buf->size << 1 : 256;
+    unsigned char* new_data;
+
+    while(new_size < buf->len + len)
+      new_size <<= 1;
+    new_data = (unsigned char*)realloc(buf->data, new_size);
+    if(!new_data) {
+      buf->failed = 1;
+      return;
+    }
+    buf->data = new_data;
+    buf->size = new_size;
+  }
+
+  memcpy(buf->data + buf->len, bytes, len);
+  buf->len += len;
+}
+
+
+void
+flickcurl_binary_put_varint(flickcurl_binary_buffer* buf, unsigned int value)
+{
+  unsigned char bytes[5];
+  size_t len = 0;
+
+  while(value >= 0x80) {
+    bytes[len++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  bytes[len++] = (unsigned char)value;
+
+  flickcurl_binary_put_bytes(buf, bytes, len);
+}
+
+
+void
+flickcurl_binary_put_int(flickcurl_binary_buffer* buf, int value)
+{
+  /* zigzag so that small negative values stay short */
+  flickcurl_binary_put_varint(buf, value < 0 ?
+                              ((~(unsigned int)value) << 1) | 1 :
+                              ((unsigned int)value) << 1);
+}
+
+
+void
+flickcurl_binary_set_u32(unsigned char* p, unsigned int value)
+{
+  p[0] = (unsigned char)(value & 0xff);
+  p[1] = (unsigned char)((value >> 8) & 0xff);
+  p[2] = (unsigned char)((value >> 16) & 0xff);
+  p[3] = (unsigned char)((value >> 24) & 0xff);
+}
+
+
+unsigned int
+flickcurl_binary_get_u32(const unsigned char* p)
+{
+  return (unsigned int)p[0] | ((unsigned int)p[1] << 8) |
+    ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+
+void
+flickcurl_binary_put_double(flickcurl_binary_buffer* buf, double value)
+{
+  unsigned char bytes[sizeof(double)];
+#ifdef WORDS_BIGENDIAN
+  unsigned char tmp;
+  size_t i;
+#endif
+
+  memcpy(bytes, &value, sizeof(double));
+#ifdef WORDS_BIGENDIAN
+  for(i = 0; i < sizeof(double) / 2; i++) {
+    tmp = bytes[i];
+    bytes[i] = bytes[sizeof(double) - 1 - i];
+    bytes[sizeof(double) - 1 - i] = tmp;
+  }
+#endif
+  flickcurl_binary_put_bytes(buf, bytes, sizeof(double));
+}
+
+
+static void
+flickcurl_binary_put_string(flickcurl_binary_writer* w, const char* string)
+{
+  unsigned char offset[4];
+
+  if(!string) {
+    flickcurl_binary_put_varint(&w->body, 0);
+    return;
+  }
+
+  flickcurl_binary_set_u32(offset, (unsigned int)w->strings.len);
+  flickcurl_binary_put_bytes(&w->offsets, offset, 4);
+  flickcurl_binary_put_bytes(&w->strings, string, strlen(string) + 1);
+  w->strings_count++;
+
+  flickcurl_binary_put_varint(&w->body, w->strings_count);
+}
+
+
+static unsigned int
+flickcurl_binary_get_varint(flickcurl_binary_reader* r)
+{
+  unsigned int value = 0;
+  int shift = 0;
+
+  while(!r->failed) {
+    unsigned char c;
+
+    if(r->pos >= r->end || shift > 28) {
+      r->failed = 1;
+      break;
+    }
+    c = r->data[r->pos++];
+    value |= (unsigned int)(c & 0x7f) << shift;
+    if(!(c & 0x80))
+      return value;
+    shift += 7;
+  }
+
+  return 0;
+}
+
+
+static int
+flickcurl_binary_get_int(flickcurl_binary_reader* r)
+{
+  unsigned int value = flickcurl_binary_get_varint(r);
+
+  return (value & 1) ? (int)~(value >> 1) : (int)(value >> 1);
+}
+
+
+static double
+flickcurl_binary_get_double(flickcurl_binary_reader* r)
+{
+  unsigned char bytes[sizeof(double)];
+  double value;
+  size_t i;
+
+  if(r->failed || r->pos + sizeof(double) > r->end) {
+    r->failed = 1;
+    return 0.0;
+  }
+
+  for(i = 0; i < sizeof(double); i++) {
+#ifdef WORDS_BIGENDIAN
+    bytes[sizeof(double) - 1 - i] = r->data[r->pos + i];
+#else
+    bytes[i] = r->data[r->pos + i];
+#endif
+  }
+  r->pos += sizeof(double);
+
+  memcpy(&value, bytes, sizeof(double));
+  return value;
+}
+
+
+static const char*
+flickcurl_binary_get_string(flickcurl_binary_reader* r)
+{
+  unsigned int ref = flickcurl_binary_get_varint(r);
+  unsigned int start;
+  unsigned int end;
+
+  if(!ref || r->failed)
+    return NULL;
+
+  if(ref > r->strings_count) {
+    r->failed = 1;
+    return NULL;
+  }
+
+  start = flickcurl_binary_get_u32(r->strings_offsets + (ref - 1) * 4);
+  end = flickcurl_binary_get_u32(r->strings_offsets + ref * 4);
+  if(start >= end || end > r->strings_len || r->strings[end - 1]) {
+    r->failed = 1;
+    return NULL;
+  }
+
+  return (const char*)r->strings + start;
+}
+
+
+static char*
+flickcurl_binary_get_string_copy(flickcurl_binary_reader* r)
+{
+  const char* string = flickcurl_binary_get_string(r);
+  char* copy;
+  size_t len;
+
+  if(!string)
+    return NULL;
+
+  len = strlen(string);
+  copy = (char*)malloc(len + 1);
+  if(!copy) {
+    r->failed = 1;
+    return NULL;
+  }
+  memcpy(copy, string, len + 1);
+  return copy;
+}
+
+
+/*
+ * flickcurl_binary_reader_init:
+ * @r: reader
+ * @data: record
+ * @length: length of @data
+ *
+ * INTERNAL - check a record header and set up a reader over it
+ *
+ * Return value: non-0 if the record is invalid
+ */
+static int
+flickcurl_binary_reader_init(flickcurl_binary_reader* r,
+                             const unsigned char* data, size_t length)
+{
+  size_t record_len;
+  size_t strings_offset;
+  size_t offsets_len;
+
+  memset(r, 0, sizeof(*r));
+
+  if(!data || length < PHOTO_BINARY_HEADER_LEN ||
+     memcmp(data, PHOTO_BINARY_MAGIC, 4) ||
+     data[4] != PHOTO_BINARY_VERSION)
+    return 1;
+
+  record_len = flickcurl_binary_get_u32(data + 16);
+  strings_offset = flickcurl_binary_get_u32(data + 20);
+  r->strings_count = flickcurl_binary_get_u32(data + 24);
+  offsets_len = ((size_t)r->strings_count + 1) * 4;
+
+  if(record_len > length || strings_offset < PHOTO_BINARY_HEADER_LEN ||
+     strings_offset > record_len ||
+     offsets_len > record_len - strings_offset)
+    return 1;
+
+  r->data = data;
+  r->pos = PHOTO_BINARY_HEADER_LEN;
+  r->end = strings_offset;
+  r->strings_offsets = data + strings_offset;
+  r->strings = r->strings_offsets + offsets_len;
+  r->strings_len = record_len - strings_offset - offsets_len;
+
+  return 0;
+}
+
+
+static int
+flickcurl_binary_reader_seek(flickcurl_binary_reader* r, int header_offset)
+{
+  size_t offset = flickcurl_binary_get_u32(r->data + header_offset);
+
+  if(!offset)
+    return 1;
+  if(offset < PHOTO_BINARY_HEADER_LEN || offset > r->end) {
+    r->failed = 1;
+    return 1;
+  }
+  r->pos = offset;
+  return 0;
+}
+
+
+/**
+ * flickcurl_photo_to_binary:
+ * @photo: photo object
+ * @length_p: pointer to store length of record
+ *
+ * Encode a photo as a compact binary record
+ *
+ * The record holds the photo fields, tags, notes, place and video
+ * in a fixed layout header, varint encoded body and string table.
+ * Records may be concatenated into a file and read back with
+ * flickcurl_new_photo_store() or decoded with
+ * flickcurl_photo_from_binary().
+ *
+ * Return value: new record or NULL on failure
+ **/
+unsigned char*
+flickcurl_photo_to_binary(flickcurl_photo* photo, size_t* length_p)
+{
+  flickcurl_binary_writer w;
+  unsigned char header[PHOTO_BINARY_HEADER_LEN];
+  unsigned char offset[4];
+  unsigned int bitmap[2] = { 0, 0 };
+  unsigned char* record = NULL;
+  size_t strings_offset;
+  size_t record_len;
+  int flags = 0;
+  int i;
+
+  if(!photo)
+    return NULL;
+
+  memset(&w, '\0', sizeof(w));
+  memset(header, '\0', sizeof(header));
+
+  /* core: id, uri, media type then present fields in bitmap order */
+  flickcurl_binary_put_string(&w, photo->id);
+  flickcurl_binary_put_string(&w, photo->uri);
+  flickcurl_binary_put_string(&w, photo->media_type);
+
+  for(i = 0; i <= PHOTO_FIELD_LAST; i++) {
+    flickcurl_photo_field* field;
+
+    field = flickcurl_photo_get_field(photo, (flickcurl_photo_field_type)i);
+    if(field->type == VALUE_TYPE_NONE)
+      continue;
+
+    bitmap[i >> 5] |= 1U << (i & 31);
+    flickcurl_binary_put_varint(&w.body, (unsigned int)field->type);
+    flickcurl_binary_put_int(&w.body, (int)field->integer);
+    flickcurl_binary_put_string(&w, field->string);
+  }
+
+  flickcurl_binary_set_u32(header + 28,
+                           (unsigned int)(PHOTO_BINARY_HEADER_LEN + w.body.len));
+  flickcurl_binary_put_varint(&w.body, (unsigned int)photo->tags_count);
+  for(i = 0; i < photo->tags_count; i++) {
+    flickcurl_tag* tag = photo->tags[i];
+
+    flickcurl_binary_put_string(&w, tag->id);
+    flickcurl_binary_put_string(&w, tag->author);
+    flickcurl_binary_put_string(&w, tag->authorname);
+    flickcurl_binary_put_string(&w, tag->raw);
+    flickcurl_binary_put_string(&w, tag->cooked);
+    flickcurl_binary_put_int(&w.body, tag->machine_tag);
+    flickcurl_binary_put_int(&w.body, tag->count);
+  }
+
+  flickcurl_binary_set_u32(header + 32,
+                           (unsigned int)(PHOTO_BINARY_HEADER_LEN + w.body.len));
+  flickcurl_binary_put_varint(&w.body, (unsigned int)photo->notes_count);
+  for(i = 0; i < photo->notes_count; i++) {
+    flickcurl_note* note = photo->notes[i];
+
+    flickcurl_binary_put_int(&w.body, note->id);
+    flickcurl_binary_put_string(&w, note->author);
+    flickcurl_binary_put_string(&w, note->authorname);
+    flickcurl_binary_put_varint(&w.body, note->x);
+    flickcurl_binary_put_varint(&w.body, note->y);
+    flickcurl_binary_put_varint(&w.body, note->w);
+    flickcurl_binary_put_varint(&w.body, note->h);
+    flickcurl_binary_put_string(&w, note->text);
+  }
+
+  if(photo->place) {
+    flickcurl_place* place = photo->place;
+
+    flags |= PHOTO_BINARY_FLAG_PLACE;
+    flickcurl_binary_set_u32(header + 36,
+                             (unsigned int)(PHOTO_BINARY_HEADER_LEN + w.body.len));
+    flickcurl_binary_put_int(&w.body, (int)place->type);
+    for(i = 0; i <= FLICKCURL_PLACE_LAST; i++) {
+      flickcurl_binary_put_string(&w, place->names[i]);
+      flickcurl_binary_put_string(&w, place->ids[i]);
+      flickcurl_binary_put_string(&w, place->urls[i]);
+      flickcurl_binary_put_string(&w, place->woe_ids[i]);
+    }
+    flickcurl_binary_put_double(&w.body, place->location.latitude);
+    flickcurl_binary_put_double(&w.body, place->location.longitude);
+    flickcurl_binary_put_int(&w.body, place->location.accuracy);
+    flickcurl_binary_put_int(&w.body, place->count);
+    flickcurl_binary_put_string(&w, place->timezone);
+
+    if(place->shape) {
+      flickcurl_shapedata* shape = place->shape;
+
+      flags |= PHOTO_BINARY_FLAG_SHAPE;
+      flickcurl_binary_put_int(&w.body, shape->created);
+      flickcurl_binary_put_double(&w.body, shape->alpha);
+      flickcurl_binary_put_int(&w.body, shape->points);
+      flickcurl_binary_put_int(&w.body, shape->edges);
+      flickcurl_binary_put_string(&w, shape->data);
+      flickcurl_binary_put_varint(&w.body,
+                                  (unsigned int)shape->file_urls_count);
+      for(i = 0; i < shape->file_urls_count; i++)
+        flickcurl_binary_put_string(&w, shape->file_urls[i]);
+      flickcurl_binary_put_int(&w.body, shape->is_donuthole);
+      flickcurl_binary_put_int(&w.body, shape->has_donuthole);
+    }
+  }
+
+  if(photo->video) {
+    flickcurl_video* video = photo->video;
+
+    flags |= PHOTO_BINARY_FLAG_VIDEO;
+    flickcurl_binary_set_u32(header + 40,
+                             (unsigned int)(PHOTO_BINARY_HEADER_LEN + w.body.len));
+    flickcurl_binary_put_int(&w.body, video->ready);
+    flickcurl_binary_put_int(&w.body, video->failed);
+    flickcurl_binary_put_int(&w.body, video->pending);
+    flickcurl_binary_put_int(&w.body, video->duration);
+    flickcurl_binary_put_int(&w.body, video->width);
+    flickcurl_binary_put_int(&w.body, video->height);
+  }
+
+  /* terminating offset giving the length of the last string */
+  flickcurl_binary_set_u32(offset, (unsigned int)w.strings.len);
+  flickcurl_binary_put_bytes(&w.offsets, offset, 4);
+
+  if(w.body.failed || w.strings.failed || w.offsets.failed)
+    goto tidy;
+
+  strings_offset = PHOTO_BINARY_HEADER_LEN + w.body.len;
+  record_len = strings_offset + w.offsets.len + w.strings.len;
+
+  memcpy(header, PHOTO_BINARY_MAGIC, 4);
+  header[4] = PHOTO_BINARY_VERSION;
+  header[5] = (unsigned char)flags;
+  flickcurl_binary_set_u32(header + 8, bitmap[0]);
+  flickcurl_binary_set_u32(header + 12, bitmap[1]);
+  flickcurl_binary_set_u32(header + 16, (unsigned int)record_len);
+  flickcurl_binary_set_u32(header + 20, (unsigned int)strings_offset);
+  flickcurl_binary_set_u32(header + 24, w.strings_count);
+
+  record = (unsigned char*)malloc(record_len);
+  if(!record)
+    goto tidy;
+
+  memcpy(record, header, PHOTO_BINARY_HEADER_LEN);
+  if(w.body.len)
+    memcpy(record + PHOTO_BINARY_HEADER_LEN, w.body.data, w.body.len);
+  memcpy(record + strings_offset, w.offsets.data, w.offsets.len);
+  if(w.strings.len)
+    memcpy(record + strings_offset + w.offsets.len, w.strings.data,
+           w.strings.len);
+
+  if(length_p)
+    *length_p = record_len;
+
+  tidy:
+  if(w.body.data)
+    free(w.body.data);
+  if(w.strings.data)
+    free(w.strings.data);
+  if(w.offsets.data)
+    free(w.offsets.data);
+
+  return record;
+}
+
+
+/**
+ * flickcurl_photo_from_binary:
+ * @data: binary photo record
+ * @length: size of @data
+ *
+ * Decode a binary photo record made by flickcurl_photo_to_binary()
+ *
+ * Return value: new photo object or NULL on failure
+ **/
+flickcurl_photo*
+flickcurl_photo_from_binary(const unsigned char* data, size_t length)
+{
+  flickcurl_binary_reader r;
+  flickcurl_photo* photo;
+  int i;
+  int int_value;
+
+  if(flickcurl_binary_reader_init(&r, data, length))
+    return NULL;
+
+  photo = (flickcurl_photo*)calloc(1, sizeof(flickcurl_photo));
+  if(!photo)
+    return NULL;
+
+  photo->id = flickcurl_binary_get_string_copy(&r);
+  photo->uri = flickcurl_binary_get_string_copy(&r);
+  photo->media_type = flickcurl_binary_get_string_copy(&r);
+
+  for(i = 0; i <= PHOTO_FIELD_LAST; i++) {
+    unsigned int bits = flickcurl_binary_get_u32(data + 8 + ((i >> 5) << 2));
+    flickcurl_photo_field* field = &photo->fields[i];
+
+    if(!(bits & (1U << (i & 31)))) {
+      field->type = VALUE_TYPE_NONE;
+      continue;
+    }
+
+    field->type = (flickcurl_field_value_type)flickcurl_binary_get_varint(&r);
+    /* the integer member is declared with the field enum type but holds
+     * an int value, as set by flickcurl_photo_set_table_field()
+     */
+    int_value = flickcurl_binary_get_int(&r);
+    field->integer = (flickcurl_photo_field_type)int_value;
+    field->string = flickcurl_binary_get_string_copy(&r);
+  }
+
+  flickcurl_binary_reader_seek(&r, 28);
+  photo->tags_count = (int)flickcurl_binary_get_varint(&r);
+  if(r.failed || (size_t)photo->tags_count > r.end - r.pos) {
+    photo->tags_count = 0;
+    goto failed;
+  }
+  photo->tags = (flickcurl_tag**)calloc(photo->tags_count + 1,
+                                        sizeof(flickcurl_tag*));
+  if(!photo->tags) {
+    photo->tags_count = 0;
+    goto failed;
+  }
+  for(i = 0; i < photo->tags_count; i++) {
+    flickcurl_tag* tag = (flickcurl_tag*)calloc(1, sizeof(flickcurl_tag));
+
+    if(!tag) {
+      photo->tags_count = i;
+      goto failed;
+    }
+    photo->tags[i] = tag;
+    tag->photo = photo;
+    tag->id = flickcurl_binary_get_string_copy(&r);
+    tag->author = flickcurl_binary_get_string_copy(&r);
+    tag->authorname = flickcurl_binary_get_string_copy(&r);
+    tag->raw = flickcurl_binary_get_string_copy(&r);
+    tag->cooked = flickcurl_binary_get_string_copy(&r);
+    tag->machine_tag = flickcurl_binary_get_int(&r);
+    tag->count = flickcurl_binary_get_int(&r);
+  }
+
+  flickcurl_binary_reader_seek(&r, 32);
+  photo->notes_count = (int)flickcurl_binary_get_varint(&r);
+  if(r.failed || (size_t)photo->notes_count > r.end - r.pos) {
+    photo->notes_count = 0;
+    goto failed;
+  }
+  photo->notes = (flickcurl_note**)calloc(photo->notes_count + 1,
+                                          sizeof(flickcurl_note*));
+  if(!photo->notes) {
+    photo->notes_count = 0;
+    goto failed;
+  }
+  for(i = 0; i < photo->notes_count; i++) {
+    flickcurl_note* note = (flickcurl_note*)calloc(1, sizeof(flickcurl_note));
+
+    if(!note) {
+      photo->notes_count = i;
+      goto failed;
+    }
+    photo->notes[i] = note;
+    note->id = flickcurl_binary_get_int(&r);
+    note->author = flickcurl_binary_get_string_copy(&r);
+    note->authorname = flickcurl_binary_get_string_copy(&r);
+    note->x = flickcurl_binary_get_varint(&r);
+    note->y = flickcurl_binary_get_varint(&r);
+    note->w = flickcurl_binary_get_varint(&r);
+    note->h = flickcurl_binary_get_varint(&r);
+    note->text = flickcurl_binary_get_string_copy(&r);
+  }
+
+  if((data[5] & PHOTO_BINARY_FLAG_PLACE) && !flickcurl_binary_reader_seek(&r, 36)) {
+    flickcurl_place* place;
+
+    place = (flickcurl_place*)calloc(1, sizeof(flickcurl_place));
+    if(!place)
+      goto failed;
+    photo->place = place;
+
+    place->type = (flickcurl_place_type)flickcurl_binary_get_int(&r);
+    for(i = 0; i <= FLICKCURL_PLACE_LAST; i++) {
+      place->names[i] = flickcurl_binary_get_string_copy(&r);
+      place->ids[i] = flickcurl_binary_get_string_copy(&r);
+      place->urls[i] = flickcurl_binary_get_string_copy(&r);
+      place->woe_ids[i] = flickcurl_binary_get_string_copy(&r);
+    }
+    place->location.latitude = flickcurl_binary_get_double(&r);
+    place->location.longitude = flickcurl_binary_get_double(&r);
+    place->location.accuracy = flickcurl_binary_get_int(&r);
+    place->count = flickcurl_binary_get_int(&r);
+    place->timezone = flickcurl_binary_get_string_copy(&r);
+
+    if(data[5] & PHOTO_BINARY_FLAG_SHAPE) {
+      flickcurl_shapedata* shape;
+      int count;
+
+      shape = (flickcurl_shapedata*)calloc(1, sizeof(flickcurl_shapedata));
+      if(!shape)
+        goto failed;
+      place->shape = shape;
+
+      shape->created = flickcurl_binary_get_int(&r);
+      shape->alpha = flickcurl_binary_get_double(&r);
+      shape->points = flickcurl_binary_get_int(&r);
+      shape->edges = flickcurl_binary_get_int(&r);
+      shape->data = flickcurl_binary_get_string_copy(&r);
+      if(shape->data)
+        shape->data_length = strlen(shape->data);
+
+      count = (int)flickcurl_binary_get_varint(&r);
+      if(r.failed || (size_t)count > r.end - r.pos)
+        goto failed;
+      shape->file_urls = (char**)calloc(count + 1, sizeof(char*));
+      if(!shape->file_urls)
+        goto failed;
+      for(i = 0; i < count; i++)
+        shape->file_urls[i] = flickcurl_binary_get_string_copy(&r);
+      shape->file_urls_count = count;
+      shape->is_donuthole = flickcurl_binary_get_int(&r);
+      shape->has_donuthole = flickcurl_binary_get_int(&r);
+
+      /* DEPRECATED fields point into the shape */
+      place->shapedata = shape->data;
+      place->shapedata_length = shape->data_length;
+      place->shapefile_urls = shape->file_urls;
+      place->shapefile_urls_count = shape->file_urls_count;
+    }
+  }
+
+  if((data[5] & PHOTO_BINARY_FLAG_VIDEO) && !flickcurl_binary_reader_seek(&r, 40)) {
+    flickcurl_video* video;
+
+    video = (flickcurl_video*)calloc(1, sizeof(flickcurl_video));
+    if(!video)
+      goto failed;
+    photo->video = video;
+
+    video->ready = flickcurl_binary_get_int(&r);
+    video->failed = flickcurl_binary_get_int(&r);
+    video->pending = flickcurl_binary_get_int(&r);
+    video->duration = flickcurl_binary_get_int(&r);
+    video->width = flickcurl_binary_get_int(&r);
+    video->height = flickcurl_binary_get_int(&r);
+  }
+
+  if(r.failed)
+    goto failed;
+
+  return photo;
+
+  failed:
+  flickcurl_free_photo(photo);
+  return NULL;
+}
+
+
+/**
+ * flickcurl_photo_binary_get_length:
+ * @data: binary photo record
+ * @length: size of @data
+ *
+ * Get the length of the binary photo record at the start of @data
+ *
+ * Return value: record length or 0 if @data does not start with a valid record
+ **/
+size_t
+flickcurl_photo_binary_get_length(const unsigned char* data, size_t length)
+{
+  flickcurl_binary_reader r;
+
+  if(flickcurl_binary_reader_init(&r, data, length))
+    return 0;
+
+  return flickcurl_binary_get_u32(data + 16);
+}
+
+
+/**
+ * flickcurl_photo_binary_get_id:
+ * @data: binary photo record
+ * @length: size of @data
+ *
+ * Get the photo ID from a binary photo record without decoding it
+ *
+ * The returned string points into @data.
+ *
+ * Return value: photo ID or NULL on failure
+ **/
+const char*
+flickcurl_photo_binary_get_id(const unsigned char* data, size_t length)
+{
+  flickcurl_binary_reader r;
+
+  if(flickcurl_binary_reader_init(&r, data, length))
+    return NULL;
+
+  return flickcurl_binary_get_string(&r);
+}
+
+
+/**
+ * flickcurl_photo_binary_get_field:
+ * @data: binary photo record
+ * @length: size of @data
+ * @field: photo field
+ * @type_p: pointer to store field value type (or NULL)
+ * @integer_p: pointer to store field integer value (or NULL)
+ * @string_p: pointer to store field string value (or NULL)
+ *
+ * Get one photo field from a binary photo record without decoding it
+ *
+ * Only the present fields before @field are skipped over and no
+ * memory is allocated; the returned string points into @data so this
+ * works on a read-only view such as a flickcurl_new_photo_store() map.
+ *
+ * Return value: 0 if the field is present, 1 if absent, <0 on failure
+ **/
+int
+flickcurl_photo_binary_get_field(const unsigned char* data, size_t length,
+                                 flickcurl_photo_field_type field,
+                                 flickcurl_field_value_type* type_p,
+                                 int* integer_p, const char** string_p)
+{
+  flickcurl_binary_reader r;
+  int i;
+
+  if((int)field < 0 || field > PHOTO_FIELD_LAST)
+    return -1;
+
+  if(flickcurl_binary_reader_init(&r, data, length))
+    return -1;
+
+  if(!(flickcurl_binary_get_u32(data + 8 + ((field >> 5) << 2)) &
+       (1U << (field & 31))))
+    return 1;
+
+  /* skip id, uri and media type */
+  flickcurl_binary_get_varint(&r);
+  flickcurl_binary_get_varint(&r);
+  flickcurl_binary_get_varint(&r);
+
+  for(i = 0; i < (int)field; i++) {
+    unsigned int bits = flickcurl_binary_get_u32(data + 8 + ((i >> 5) << 2));
+
+    if(!(bits & (1U << (i & 31))))
+      continue;
+
+    flickcurl_binary_get_varint(&r);
+    flickcurl_binary_get_varint(&r);
+    flickcurl_binary_get_varint(&r);
+  }
+
+  if(type_p)
+    *type_p = (flickcurl_field_value_type)flickcurl_binary_get_varint(&r);
+  else
+    flickcurl_binary_get_varint(&r);
+  if(integer_p)
+    *integer_p = flickcurl_binary_get_int(&r);
+  else
+    flickcurl_binary_get_varint(&r);
+  if(string_p)
+    *string_p = flickcurl_binary_get_string(&r);
+
+  return r.failed ? -1 : 0;
+}
+
+
+/**
+ * flickcurl_new_photo_store:
+ * @fc: flickcurl context
+ * @filename: file of concatenated binary photo records
+ *
+ * Open a read-only view of a file of binary photo records
+ *
+ * The file is memory mapped where the system supports it, otherwise
+ * it is read into memory.  Walk the records with
+ * flickcurl_photo_store_next().
+ *
+ * Return value: new photo store or NULL on failure
+ **/
+flickcurl_photo_store*
+flickcurl_new_photo_store(flickcurl* fc, const char* filename)
+{
+  flickcurl_photo_store* store;
+  struct stat st;
+  int fd;
+
+  fd = open(filename, O_RDONLY);
+  if(fd < 0) {
+    flickcurl_error(fc, "Failed to open photo store %s - %s",
+                    filename, strerror(errno));
+    return NULL;
+  }
+
+  if(fstat(fd, &st) < 0) {
+    flickcurl_error(fc, "Failed to stat photo store %s - %s",
+                    filename, strerror(errno));
+    close(fd);
+    return NULL;
+  }
+
+  store = (flickcurl_photo_store*)calloc(1, sizeof(*store));
+  if(!store) {
+    close(fd);
+    return NULL;
+  }
+  store->fc = fc;
+  store->length = (size_t)st.st_size;
+
+  if(!store->length) {
+    close(fd);
+    return store;
+  }
+
+#ifdef FLICKCURL_PHOTO_STORE_MMAP
+  store->data = (unsigned char*)mmap(NULL, store->length, PROT_READ,
+                                     MAP_SHARED, fd, 0);
+  if(store->data == (unsigned char*)MAP_FAILED) {
+    flickcurl_error(fc, "Failed to map photo store %s - %s",
+                    filename, strerror(errno));
+    store->data = NULL;
+    goto failed;
+  }
+  store->is_mapped = 1;
+#else
+  store->data = (unsigned char*)malloc(store->length);
+  if(!store->data)
+    goto failed;
+  if(read(fd, store->data, store->length) != (ssize_t)store->length) {
+    flickcurl_error(fc, "Failed to read photo store %s - %s",
+                    filename, strerror(errno));
+    goto failed;
+  }
+#endif
+
+  close(fd);
+  return store;
+
+  failed:
+  close(fd);
+  flickcurl_free_photo_store(store);
+  return NULL;
+}
+
+
+/**
+ * flickcurl_free_photo_store:
+ * @store: photo store
+ *
+ * Destructor for photo store
+ */
+void
+flickcurl_free_photo_store(flickcurl_photo_store* store)
+{
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(store, flickcurl_photo_store);
+
+  if(store->data) {
+#ifdef FLICKCURL_PHOTO_STORE_MMAP
+    if(store->is_mapped)
+      munmap(store->data, store->length);
+    else
+#endif
+      free(store->data);
+  }
+
+  free(store);
+}
+
+
+/**
+ * flickcurl_photo_store_next:
+ * @store: photo store
+ * @offset_p: pointer to the offset of the record to read; updated to the next record
+ * @length_p: pointer to store the record length
+ *
+ * Get the binary photo record at an offset in a photo store
+ *
+ * Start with *@offset_p set to 0.  The returned record points into the
+ * store and may be passed to flickcurl_photo_binary_get_field() or
+ * flickcurl_photo_from_binary().
+ *
+ * Return value: record or NULL at the end of the store or if the record is invalid
+ **/
+const unsigned char*
+flickcurl_photo_store_next(flickcurl_photo_store* store, size_t* offset_p,
+                           size_t* length_p)
+{
+  const unsigned char* record;
+  size_t offset = *offset_p;
+  size_t length;
+
+  if(offset >= store->length)
+    return NULL;
+
+  record = store->data + offset;
+  length = flickcurl_photo_binary_get_length(record, store->length - offset);
+  if(!length)
+    return NULL;
+
+  *offset_p = offset + length;
+  if(length_p)
+    *length_p = length;
+
+  return record;
+}
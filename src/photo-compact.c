@@ -0,0 +1,678 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * photo-compact.c - Flickcurl compact photos and struct-of-arrays batches
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+#define COMPACT_BITMAP_WORDS ((PHOTO_FIELD_LAST + 32) / 32)
+
+/* one present field of a compact photo */
+typedef struct {
+  int integer;
+  /* offset of the string in the blob plus 1 or 0 for NULL */
+  unsigned int string;
+  unsigned int type;
+} flickcurl_compact_value;
+
+
+/*
+ * A compact photo is one allocation: this header, the values of the
+ * present fields in field order then the NUL terminated strings.
+ */
+struct flickcurl_compact_photo_s {
+  unsigned int present[COMPACT_BITMAP_WORDS];
+  int values_count;
+  flickcurl_compact_value* values;
+  char* blob;
+};
+
+
+static int
+flickcurl_compact_popcount(unsigned int bits)
+{
+  int count = 0;
+
+  for(; bits; bits &= bits - 1)
+    count++;
+
+  return count;
+}
+
+
+/**
+ * flickcurl_new_compact_photo:
+ * @photo: photo
+ *
+ * Constructor - create a compact copy of the ID and fields of a photo
+ *
+ * A #flickcurl_photo has a slot for every field.  The compact form
+ * holds a bitmap of the present fields, their values packed in field
+ * order and one block with all their strings, so a photo with a few
+ * fields uses a few hundred bytes in a single allocation.  Tags,
+ * notes, place and video are not kept.
+ *
+ * Return value: new compact photo or NULL on failure
+ **/
+flickcurl_compact_photo*
+flickcurl_new_compact_photo(flickcurl_photo* photo)
+{
+  flickcurl_compact_photo* cp;
+  unsigned int present[COMPACT_BITMAP_WORDS];
+  size_t blob_len = 1;
+  int values_count = 0;
+  char* p;
+  int i;
+  int v = 0;
+
+  memset(present, '\0', sizeof(present));
+
+  if(photo->id)
+    blob_len += strlen(photo->id);
+
+  for(i = PHOTO_FIELD_FIRST; i <= PHOTO_FIELD_LAST; i++) {
+    flickcurl_photo_field* field;
+
+    field = flickcurl_photo_get_field(photo, (flickcurl_photo_field_type)i);
+    if(field->type == VALUE_TYPE_NONE)
+      continue;
+
+    present[i >> 5] |= 1U << (i & 31);
+    values_count++;
+    if(field->string)
+      blob_len += strlen(field->string) + 1;
+  }
+
+  cp = (flickcurl_compact_photo*)malloc(sizeof(*cp) +
+                                        values_count * sizeof(*cp->values) +
+                                        blob_len);
+  if(!cp)
+    return NULL;
+
+  memcpy(cp->present, present, sizeof(present));
+  cp->values_count = values_count;
+  cp->values = (flickcurl_compact_value*)(cp + 1);
+  cp->blob = (char*)(cp->values + values_count);
+
+  /* the ID is always first in the blob */
+  p = cp->blob;
+  if(photo->id) {
+    strcpy(p, photo->id);
+    p += strlen(p);
+  }
+  *p++ = '\0';
+
+  for(i = PHOTO_FIELD_FIRST; i <= PHOTO_FIELD_LAST; i++) {
+    flickcurl_photo_field* field = &photo->fields[i];
+    flickcurl_compact_value* value;
+
+    if(!(present[i >> 5] & (1U << (i & 31))))
+      continue;
+
+    value = &cp->values[v++];
+    value->integer = (int)field->integer;
+    value->type = (unsigned int)field->type;
+    value->string = 0;
+    if(field->string) {
+      value->string = (unsigned int)(p - cp->blob) + 1;
+      strcpy(p, field->string);
+      p += strlen(p) + 1;
+    }
+  }
+
+  return cp;
+}
+
+
+/**
+ * flickcurl_free_compact_photo:
+ * @cp: compact photo
+ *
+ * Destructor - free a compact photo
+ */
+void
+flickcurl_free_compact_photo(flickcurl_compact_photo* cp)
+{
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(cp, flickcurl_compact_photo);
+
+  free(cp);
+}
+
+
+/**
+ * flickcurl_compact_photo_get_id:
+ * @cp: compact photo
+ *
+ * Get the photo ID of a compact photo
+ *
+ * Return value: photo ID (empty if the photo had none)
+ **/
+const char*
+flickcurl_compact_photo_get_id(flickcurl_compact_photo* cp)
+{
+  return cp->blob;
+}
+
+
+/**
+ * flickcurl_compact_photo_get_field:
+ * @cp: compact photo
+ * @field: photo field
+ * @type_p: pointer to store field value type (or NULL)
+ * @integer_p: pointer to store field integer value (or NULL)
+ * @string_p: pointer to store field string value (or NULL)
+ *
+ * Get one field of a compact photo
+ *
+ * The field is found by counting the present fields before it in the
+ * bitmap.  The returned string is owned by @cp.
+ *
+ * Return value: 0 if the field is present, 1 if absent, <0 on failure
+ **/
+int
+flickcurl_compact_photo_get_field(flickcurl_compact_photo* cp,
+                                  flickcurl_photo_field_type field,
+                                  flickcurl_field_value_type* type_p,
+                                  int* integer_p, const char** string_p)
+{
+  flickcurl_compact_value* value;
+  int i = (int)field;
+  int index = 0;
+  int w;
+
+  if(i < PHOTO_FIELD_FIRST || i > PHOTO_FIELD_LAST)
+    return -1;
+
+  if(!(cp->present[i >> 5] & (1U << (i & 31))))
+    return 1;
+
+  for(w = 0; w < (i >> 5); w++)
+    index += flickcurl_compact_popcount(cp->present[w]);
+  index += flickcurl_compact_popcount(cp->present[w] &
+                                      ((1U << (i & 31)) - 1));
+
+  value = &cp->values[index];
+  if(type_p)
+    *type_p = (flickcurl_field_value_type)value->type;
+  if(integer_p)
+    *integer_p = value->integer;
+  if(string_p)
+    *string_p = value->string ? cp->blob + value->string - 1 : NULL;
+
+  return 0;
+}
+
+
+/* Size of each block of batch strings; longer strings get their own */
+#define BATCH_BLOCK_SIZE 65536
+
+typedef struct flickcurl_batch_block_s {
+  struct flickcurl_batch_block_s* next;
+  size_t used;
+  size_t size;
+  /* string bytes follow */
+} flickcurl_batch_block;
+
+
+/* one field of a batch as parallel arrays of every photo's value */
+typedef struct {
+  flickcurl_photo_field_type field;
+  int* integers;
+  const char** strings;
+  unsigned char* types;
+} flickcurl_batch_column;
+
+
+struct flickcurl_photo_batch_s {
+  int count;
+  int size;
+
+  const char** ids;
+
+  flickcurl_batch_column* columns;
+  int columns_count;
+  /* index into @columns by field or -1 */
+  int column_index[PHOTO_FIELD_LAST + 1];
+
+  /* string storage; blocks never move so strings can be pointed to */
+  flickcurl_batch_block* blocks;
+  /* open hash of the distinct strings stored */
+  const char** strings_hash;
+  unsigned int strings_hash_size;
+  unsigned int strings_count;
+};
+
+
+static unsigned int
+flickcurl_batch_hash(const char* string)
+{
+  unsigned int hash = 5381;
+
+  while(*string)
+    hash = (hash * 33) ^ (unsigned char)*string++;
+
+  return hash;
+}
+
+
+static char*
+flickcurl_batch_alloc(flickcurl_photo_batch* batch, size_t len)
+{
+  flickcurl_batch_block* block = batch->blocks;
+  char* p;
+
+  if(!block || block->used + len > block->size) {
+    size_t size = (len > BATCH_BLOCK_SIZE) ? len : BATCH_BLOCK_SIZE;
+
+    block = (flickcurl_batch_block*)malloc(sizeof(*block) + size);
+    if(!block)
+      return NULL;
+    block->size = size;
+    block->used = 0;
+    /* keep the current block first to fill it */
+    if(batch->blocks && len > BATCH_BLOCK_SIZE) {
+      block->next = batch->blocks->next;
+      batch->blocks->next = block;
+    } else {
+      block->next = batch->blocks;
+      batch->blocks = block;
+    }
+  }
+
+  p = (char*)(block + 1) + block->used;
+  block->used += len;
+
+  return p;
+}
+
+
+/*
+ * flickcurl_batch_add_string:
+ * @batch: photo batch
+ * @string: string or NULL
+ *
+ * INTERNAL - store a string in a batch once however often it is added
+ *
+ * Return value: stored copy of @string or NULL
+ */
+static const char*
+flickcurl_batch_add_string(flickcurl_photo_batch* batch, const char* string)
+{
+  unsigned int i;
+  size_t len;
+  char* copy;
+
+  if(!string)
+    return NULL;
+
+  if((batch->strings_count + 1) * 2 > batch->strings_hash_size) {
+    unsigned int new_size = batch->strings_hash_size ?
+      batch->strings_hash_size << 1 : 1024;
+    const char** new_hash;
+
+    new_hash = (const char**)calloc(new_size, sizeof(const char*));
+    if(!new_hash)
+      return NULL;
+    for(i = 0; i < batch->strings_hash_size; i++) {
+      unsigned int j;
+
+      if(!batch->strings_hash[i])
+        continue;
+      j = flickcurl_batch_hash(batch->strings_hash[i]) & (new_size - 1);
+      while(new_hash[j])
+        j = (j + 1) & (new_size - 1);
+      new_hash[j] = batch->strings_hash[i];
+    }
+    if(batch->strings_hash)
+      free(batch->strings_hash);
+    batch->strings_hash = new_hash;
+    batch->strings_hash_size = new_size;
+  }
+
+  i = flickcurl_batch_hash(string) & (batch->strings_hash_size - 1);
+  while(batch->strings_hash[i]) {
+    if(!strcmp(batch->strings_hash[i], string))
+      return batch->strings_hash[i];
+    i = (i + 1) & (batch->strings_hash_size - 1);
+  }
+
+  len = strlen(string) + 1;
+  copy = flickcurl_batch_alloc(batch, len);
+  if(!copy)
+    return NULL;
+  memcpy(copy, string, len);
+
+  batch->strings_hash[i] = copy;
+  batch->strings_count++;
+
+  return copy;
+}
+
+
+/**
+ * flickcurl_new_photo_batch:
+ * @fields: #PHOTO_FIELD_none terminated array of photo fields to hold or NULL for all
+ *
+ * Constructor - create a struct-of-arrays view of photos for scanning
+ *
+ * Each field of @fields is held as arrays of the integer value,
+ * string value and value type of every photo added, so scanning one
+ * field over many photos reads contiguous memory.  Equal strings are
+ * stored once in blocks shared by the whole batch.
+ *
+ * Add photos with flickcurl_photo_batch_add_photos_list().
+ *
+ * Return value: new photo batch or NULL on failure
+ **/
+flickcurl_photo_batch*
+flickcurl_new_photo_batch(const flickcurl_photo_field_type* fields)
+{
+  flickcurl_photo_batch* batch;
+  int i;
+
+  batch = (flickcurl_photo_batch*)calloc(1, sizeof(*batch));
+  if(!batch)
+    return NULL;
+
+  for(i = 0; i <= PHOTO_FIELD_LAST; i++)
+    batch->column_index[i] = -1;
+
+  batch->columns = (flickcurl_batch_column*)calloc(PHOTO_FIELD_LAST + 1,
+                                                   sizeof(*batch->columns));
+  if(!batch->columns) {
+    free(batch);
+    return NULL;
+  }
+
+  for(i = 0; fields ? fields[i] != PHOTO_FIELD_none : i < PHOTO_FIELD_LAST;
+      i++) {
+    flickcurl_photo_field_type field;
+
+    field = fields ? fields[i] : (flickcurl_photo_field_type)(i + 1);
+    if((int)field < PHOTO_FIELD_FIRST || field > PHOTO_FIELD_LAST ||
+       batch->column_index[field] >= 0)
+      continue;
+
+    batch->column_index[field] = batch->columns_count;
+    batch->columns[batch->columns_count++].field = field;
+  }
+
+  return batch;
+}
+
+
+/**
+ * flickcurl_free_photo_batch:
+ * @batch: photo batch
+ *
+ * Destructor - free a photo batch
+ */
+void
+flickcurl_free_photo_batch(flickcurl_photo_batch* batch)
+{
+  flickcurl_batch_block* block;
+  int i;
+
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(batch, flickcurl_photo_batch);
+
+  for(i = 0; i < batch->columns_count; i++) {
+    flickcurl_batch_column* column = &batch->columns[i];
+
+    if(column->integers)
+      free(column->integers);
+    if(column->strings)
+      free(column->strings);
+    if(column->types)
+      free(column->types);
+  }
+  free(batch->columns);
+
+  if(batch->ids)
+    free(batch->ids);
+
+  for(block = batch->blocks; block; ) {
+    flickcurl_batch_block* next = block->next;
+
+    free(block);
+    block = next;
+  }
+
+  if(batch->strings_hash)
+    free(batch->strings_hash);
+
+  free(batch);
+}
+
+
+static int
+flickcurl_photo_batch_grow(flickcurl_photo_batch* batch, int size)
+{
+  const char** ids;
+  int i;
+
+  ids = (const char**)realloc(batch->ids, size * sizeof(const char*));
+  if(!ids)
+    return 1;
+  batch->ids = ids;
+
+  for(i = 0; i < batch->columns_count; i++) {
+    flickcurl_batch_column* column = &batch->columns[i];
+    int* integers;
+    const char** strings;
+    unsigned char* types;
+
+    integers = (int*)realloc(column->integers, size * sizeof(int));
+    if(!integers)
+      return 1;
+    column->integers = integers;
+
+    strings = (const char**)realloc(column->strings, size * sizeof(char*));
+    if(!strings)
+      return 1;
+    column->strings = strings;
+
+    types = (unsigned char*)realloc(column->types, size);
+    if(!types)
+      return 1;
+    column->types = types;
+  }
+
+  batch->size = size;
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_photo_batch_add_photos_list:
+ * @batch: photo batch
+ * @photos_list: photos list
+ *
+ * Add the photos of a photos list to a batch
+ *
+ * The photo values are copied so @photos_list may be freed
+ * afterwards.  Lists of many pages can be added to one batch.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_photo_batch_add_photos_list(flickcurl_photo_batch* batch,
+                                      flickcurl_photos_list* photos_list)
+{
+  int i;
+
+  if(batch->count + photos_list->photos_count > batch->size) {
+    int size = batch->size ? batch->size : 512;
+
+    while(size < batch->count + photos_list->photos_count)
+      size <<= 1;
+    if(flickcurl_photo_batch_grow(batch, size))
+      return 1;
+  }
+
+  for(i = 0; i < photos_list->photos_count; i++) {
+    flickcurl_photo* photo = photos_list->photos[i];
+    int row = batch->count;
+    int c;
+
+    batch->ids[row] = flickcurl_batch_add_string(batch, photo->id);
+
+    for(c = 0; c < batch->columns_count; c++) {
+      flickcurl_batch_column* column = &batch->columns[c];
+      flickcurl_photo_field* field;
+
+      field = flickcurl_photo_get_field(photo, column->field);
+      column->integers[row] = (int)field->integer;
+      column->types[row] = (unsigned char)field->type;
+      column->strings[row] = NULL;
+      if(field->string) {
+        column->strings[row] = flickcurl_batch_add_string(batch,
+                                                          field->string);
+        if(!column->strings[row])
+          return 1;
+      }
+    }
+
+    batch->count++;
+  }
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_photo_batch_get_count:
+ * @batch: photo batch
+ *
+ * Get the number of photos in a batch
+ *
+ * Return value: number of photos
+ **/
+int
+flickcurl_photo_batch_get_count(flickcurl_photo_batch* batch)
+{
+  return batch->count;
+}
+
+
+/**
+ * flickcurl_photo_batch_get_ids:
+ * @batch: photo batch
+ *
+ * Get the photo IDs of a batch
+ *
+ * Return value: array of flickcurl_photo_batch_get_count() IDs owned by @batch
+ **/
+const char**
+flickcurl_photo_batch_get_ids(flickcurl_photo_batch* batch)
+{
+  return batch->ids;
+}
+
+
+/**
+ * flickcurl_photo_batch_get_integers:
+ * @batch: photo batch
+ * @field: photo field
+ *
+ * Get the integer values of a field for every photo of a batch
+ *
+ * Absent fields have value -1.  The array is owned by @batch and is
+ * only valid until more photos are added.
+ *
+ * Return value: array of flickcurl_photo_batch_get_count() values or NULL if @field is not in @batch
+ **/
+const int*
+flickcurl_photo_batch_get_integers(flickcurl_photo_batch* batch,
+                                   flickcurl_photo_field_type field)
+{
+  if((int)field < 0 || field > PHOTO_FIELD_LAST ||
+     batch->column_index[field] < 0)
+    return NULL;
+
+  return batch->columns[batch->column_index[field]].integers;
+}
+
+
+/**
+ * flickcurl_photo_batch_get_strings:
+ * @batch: photo batch
+ * @field: photo field
+ *
+ * Get the string values of a field for every photo of a batch
+ *
+ * Absent fields are NULL; equal strings are the same pointer.  The
+ * array is owned by @batch and is only valid until more photos are
+ * added; the strings stay valid until @batch is freed.
+ *
+ * Return value: array of flickcurl_photo_batch_get_count() strings or NULL if @field is not in @batch
+ **/
+const char**
+flickcurl_photo_batch_get_strings(flickcurl_photo_batch* batch,
+                                  flickcurl_photo_field_type field)
+{
+  if((int)field < 0 || field > PHOTO_FIELD_LAST ||
+     batch->column_index[field] < 0)
+    return NULL;
+
+  return batch->columns[batch->column_index[field]].strings;
+}
+
+
+/**
+ * flickcurl_photo_batch_get_types:
+ * @batch: photo batch
+ * @field: photo field
+ *
+ * Get the value types of a field for every photo of a batch
+ *
+ * Each byte is a #flickcurl_field_value_type; VALUE_TYPE_NONE for
+ * absent fields.  The array is owned by @batch and is only valid
+ * until more photos are added.
+ *
+ * Return value: array of flickcurl_photo_batch_get_count() types or NULL if @field is not in @batch
+ **/
+const unsigned char*
+flickcurl_photo_batch_get_types(flickcurl_photo_batch* batch,
+                                flickcurl_photo_field_type field)
+{
+  if((int)field < 0 || field > PHOTO_FIELD_LAST ||
+     batch->column_index[field] < 0)
+    return NULL;
+
+  return batch->columns[batch->column_index[field]].types;
+}
@@ -116,6 +116,71 @@ flickcurl_get_photo_field_label(flickcurl_photo_field_type field)
 }
 
 
+/*
+ * flickcurl_new_photo_source:
+ * @fc: flickcurl context
+ * @response: response document the photos are built from
+ *
+ * INTERNAL - create a document to retain the nodes of lazy photos
+ *
+ * The photo nodes are later moved here from @response so they outlive
+ * it.  Sharing the response dictionary means the move copies no names
+ * or values.
+ *
+ * Return value: new source with one usage or NULL on failure
+ */
+static flickcurl_photo_source*
+flickcurl_new_photo_source(flickcurl* fc, xmlDocPtr response)
+{
+  flickcurl_photo_source* source;
+  xmlNodePtr root;
+
+  source = (flickcurl_photo_source*)calloc(1, sizeof(*source));
+  if(!source)
+    return NULL;
+
+  source->fc = fc;
+  source->usage = 1;
+  source->photo_fields_masked = fc->photo_fields_masked;
+  memcpy(source->photo_fields_mask, fc->photo_fields_mask,
+         sizeof(source->photo_fields_mask));
+  source->photo_parts = fc->photo_parts;
+  source->doc = xmlNewDoc((const xmlChar*)"1.0");
+  if(!source->doc) {
+    free(source);
+    return NULL;
+  }
+
+  if(response->dict) {
+    source->doc->dict = response->dict;
+    xmlDictReference(response->dict);
+  }
+
+  root = xmlNewDocNode(source->doc, NULL, (const xmlChar*)"photos", NULL);
+  if(!root) {
+    xmlFreeDoc(source->doc);
+    free(source);
+    return NULL;
+  }
+  xmlDocSetRootElement(source->doc, root);
+
+  return source;
+}
+
+
+static void
+flickcurl_photo_source_release(flickcurl_photo_source* source)
+{
+  if(--source->usage)
+    return;
+
+  if(source->xpathCtx)
+    xmlXPathFreeContext(source->xpathCtx);
+  xmlFreeDoc(source->doc);
+  free(source);
+}
+
+
 /**
  * flickcurl_free_photo:
  * @photo: photo object
@@ -129,10 +194,8 @@ flickcurl_free_photo(flickcurl_photo *photo)
 
   FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(photo, flickcurl_photo);
 
-  for(i = 0; i <= PHOTO_FIELD_LAST; i++) {
-    if(photo->fields[i].string)
-      free(photo->fields[i].string);
-  }
+  for(i = 0; i <= PHOTO_FIELD_LAST; i++)
+    flickcurl_intern_release(photo->intern, photo->fields[i].string);
   
   for(i = 0; i < photo->tags_count; i++)
     flickcurl_free_tag(photo->tags[i]);
@@ -157,10 +220,32 @@ flickcurl_free_photo(flickcurl_photo *photo)
   if(photo->video)
     flickcurl_free_video(photo->video);
   
+  if(photo->lazy) {
+    flickcurl_photo_source_release(photo->lazy->source);
+    free(photo->lazy);
+  }
+
+  flickcurl_intern_table_release(photo->intern);
+
   free(photo);
 }
 
 
+/**
+ * flickcurl_photo_get_id_number:
+ * @photo: photo object
+ *
+ * Get a photo's ID as a number
+ *
+ * Return value: photo ID or 0 if the photo has no numeric ID
+ **/
+long long
+flickcurl_photo_get_id_number(flickcurl_photo *photo)
+{
+  return flickcurl_id_to_number(photo->id);
+}
+
+
 /**
  * flickcurl_photo_as_source_uri:
  * @photo: photo object
@@ -520,6 +605,12 @@ static struct {
     VALUE_TYPE_TAG_STRING
   }
   ,
+  {
+    (const xmlChar*)"./@machine_tags",
+    PHOTO_FIELD_none,
+    VALUE_TYPE_TAG_STRING
+  }
+  ,
   {
     (const xmlChar*)"./@owner",
     PHOTO_FIELD_owner_nsid,
@@ -956,6 +1047,396 @@ static struct {
 };
 
 
+/*
+ * flickcurl_photo_register_xpaths:
+ *
+ * INTERNAL - compile the photo field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_photo_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; photo_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(photo_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_get_photo_field_value_type:
+ * @field: field enum
+ *
+ * INTERNAL - get the value type a photo field is built with
+ *
+ * Times are always stored as #VALUE_TYPE_DATETIME after building.
+ *
+ * Return value: value type or VALUE_TYPE_NONE if the field is never built
+ */
+flickcurl_field_value_type
+flickcurl_get_photo_field_value_type(flickcurl_photo_field_type field)
+{
+  int i;
+
+  if(field == PHOTO_FIELD_none)
+    return VALUE_TYPE_NONE;
+
+  for(i = 0; photo_fields_table[i].xpath; i++) {
+    if(photo_fields_table[i].field != field)
+      continue;
+
+    if(photo_fields_table[i].type == VALUE_TYPE_UNIXTIME)
+      return VALUE_TYPE_DATETIME;
+    return photo_fields_table[i].type;
+  }
+
+  return VALUE_TYPE_NONE;
+}
+
+
+/*
+ * flickcurl_photo_set_table_field:
+ * @fc: flickcurl context
+ * @photo: photo
+ * @expri: index into photo_fields_table
+ * @string_value: new string value of the field (ownership taken)
+ *
+ * INTERNAL - convert a field value to the type of its table entry and set it
+ */
+static void
+flickcurl_photo_set_table_field(flickcurl* fc, flickcurl_photo* photo,
+                                int expri, char* string_value)
+{
+  flickcurl_field_value_type datatype = photo_fields_table[expri].type;
+  int int_value= -1;
+  flickcurl_photo_field_type field = photo_fields_table[expri].field;
+  time_t unix_time;
+  char isotime[FLICKCURL_ISOTIME_SIZE];
+  char* new_value;
+  int special = 0;
+  flickcurl_tag** tags;
+  int tags_count = 0;
+  int i;
+
+#if FLICKCURL_DEBUG > 1
+  fprintf(stderr, "  type %d  string value '%s'\n", datatype,
+          string_value);
+#endif
+  switch(datatype) {
+    case VALUE_TYPE_PHOTO_ID:
+      if(photo->id)
+        free(photo->id);
+      photo->id = string_value;
+      return;
+
+    case VALUE_TYPE_PHOTO_URI:
+      if(photo->uri)
+        free(photo->uri);
+      photo->uri = string_value;
+      return;
+
+    case VALUE_TYPE_MEDIA_TYPE:
+      if(photo->media_type)
+        free(photo->media_type);
+      photo->media_type = string_value;
+      return;
+
+    case VALUE_TYPE_UNIXTIME:
+    case VALUE_TYPE_DATETIME:
+
+      unix_time = flickcurl_date_to_isotime(fc, string_value,
+                                            (datatype == VALUE_TYPE_UNIXTIME),
+                                            isotime);
+      /* the ISO form is never much longer; reuse the value's storage */
+      new_value = (unix_time >= 0) ?
+        (char*)realloc(string_value, FLICKCURL_ISOTIME_SIZE) : NULL;
+
+      if(new_value) {
+#if FLICKCURL_DEBUG > 1
+        fprintf(stderr, "  date from: '%s' unix time %ld to '%s'\n",
+                new_value, (long)unix_time, isotime);
+#endif
+        memcpy(new_value, isotime, FLICKCURL_ISOTIME_SIZE);
+        string_value= new_value;
+        int_value= (int)unix_time;
+        datatype = VALUE_TYPE_DATETIME;
+      } else
+        /* failed to convert, make it a string */
+        datatype = VALUE_TYPE_STRING;
+      break;
+
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BOOLEAN:
+      if(!*string_value && datatype == VALUE_TYPE_BOOLEAN) {
+        /* skip setting field with a boolean value '' */
+        special = 1;
+        break;
+      }
+
+      int_value = atoi(string_value);
+      break;
+
+    case VALUE_TYPE_TAG_STRING:
+      /* A space-separated list of tags or machine tags; the tags and
+       * machine_tags extras may both be present so append
+       */
+      i = !strcmp((const char*)photo_fields_table[expri].xpath,
+                  "./@machine_tags");
+      tags = flickcurl_build_tags_from_string(fc, photo,
+                                              (const char*)string_value, i,
+                                              &tags_count);
+      if(tags && photo->tags) {
+        flickcurl_tag** new_tags;
+
+        new_tags = (flickcurl_tag**)realloc(photo->tags,
+                                            sizeof(flickcurl_tag*) *
+                                            (photo->tags_count + tags_count + 1));
+        if(new_tags) {
+          memcpy(new_tags + photo->tags_count, tags,
+                 sizeof(flickcurl_tag*) * (tags_count + 1));
+          photo->tags = new_tags;
+          photo->tags_count += tags_count;
+        } else {
+          for(i = 0; i < tags_count; i++)
+            flickcurl_free_tag(tags[i]);
+        }
+        free(tags);
+      } else if(tags) {
+        photo->tags = tags;
+        photo->tags_count = tags_count;
+      }
+      special = 1;
+      break;
+
+
+    case VALUE_TYPE_NONE:
+    case VALUE_TYPE_STRING:
+    case VALUE_TYPE_FLOAT:
+    case VALUE_TYPE_URI:
+      break;
+
+    case VALUE_TYPE_PERSON_ID:
+    case VALUE_TYPE_COLLECTION_ID:
+    case VALUE_TYPE_ICON_PHOTOS:
+      abort();
+  }
+
+  if(special) {
+    free(string_value);
+    return;
+  }
+
+  if(field == PHOTO_FIELD_owner_nsid ||
+     field == PHOTO_FIELD_owner_realname ||
+     field == PHOTO_FIELD_owner_username)
+    string_value = flickcurl_intern_string(fc, string_value, &photo->intern);
+
+  if(photo->fields[field].string)
+    flickcurl_intern_release(photo->intern, photo->fields[field].string);
+  photo->fields[field].string = string_value;
+  photo->fields[field].integer= (flickcurl_photo_field_type)int_value;
+  photo->fields[field].type   = datatype;
+
+#if FLICKCURL_DEBUG > 1
+  fprintf(stderr, "field %d with %s value: '%s' / %d\n",
+          field, flickcurl_get_field_value_type_label(datatype), 
+          string_value, int_value);
+#endif
+}
+
+
+/*
+ * flickcurl_photo_table_field_in_mask:
+ * @masked: non-0 if @mask and @parts apply
+ * @mask: photo field mask
+ * @parts: #flickcurl_photo_part bits
+ * @expri: index into photo_fields_table
+ *
+ * INTERNAL - check if a table entry is built under a photo field mask
+ *
+ * Return value: non-0 if the entry is built
+ */
+static int
+flickcurl_photo_table_field_in_mask(int masked, const char* mask, int parts,
+                                    int expri)
+{
+  flickcurl_photo_field_type field = photo_fields_table[expri].field;
+
+  if(!masked)
+    return 1;
+
+  if(field != PHOTO_FIELD_none)
+    return mask[(int)field];
+
+  if(photo_fields_table[expri].type == VALUE_TYPE_PHOTO_URI)
+    return (parts & FLICKCURL_PHOTO_PART_URI);
+  if(photo_fields_table[expri].type == VALUE_TYPE_MEDIA_TYPE)
+    return (parts & FLICKCURL_PHOTO_PART_MEDIA);
+  if(photo_fields_table[expri].type == VALUE_TYPE_TAG_STRING)
+    return (parts & FLICKCURL_PHOTO_PART_TAGS);
+
+  /* the photo ID is always built */
+  return 1;
+}
+
+
+/*
+ * flickcurl_photo_table_field_wanted:
+ * @fc: flickcurl context
+ * @expri: index into photo_fields_table
+ *
+ * INTERNAL - check if a table entry is built under the session field mask
+ *
+ * Return value: non-0 if the entry is built
+ */
+static int
+flickcurl_photo_table_field_wanted(flickcurl* fc, int expri)
+{
+  return flickcurl_photo_table_field_in_mask(fc->photo_fields_masked,
+                                             fc->photo_fields_mask,
+                                             fc->photo_parts, expri);
+}
+
+
+/*
+ * flickcurl_photo_decode_field:
+ * @photo: lazy photo
+ * @field: field
+ *
+ * INTERNAL - build one field of a lazy photo from its retained node
+ */
+static void
+flickcurl_photo_decode_field(flickcurl_photo* photo,
+                             flickcurl_photo_field_type field)
+{
+  flickcurl_photo_source* source = photo->lazy->source;
+  flickcurl* fc = source->fc;
+  int expri;
+
+  if(!source->xpathCtx) {
+    source->xpathCtx = xmlXPathNewContext(source->doc);
+    if(!source->xpathCtx)
+      return;
+  }
+  source->xpathCtx->node = photo->lazy->node;
+
+  /* later table entries for a field override earlier ones as when
+   * the photo is built in full.  The mask is the one used when the
+   * photo was built, not the current session mask.
+   */
+  for(expri = 0; photo_fields_table[expri].xpath; expri++) {
+    char *string_value;
+
+    if(photo_fields_table[expri].field != field ||
+       !flickcurl_photo_table_field_in_mask(source->photo_fields_masked,
+                                            source->photo_fields_mask,
+                                            source->photo_parts, expri))
+      continue;
+
+    string_value = flickcurl_xpath_eval(fc, source->xpathCtx,
+                                        photo_fields_table[expri].xpath);
+    if(string_value)
+      flickcurl_photo_set_table_field(fc, photo, expri, string_value);
+  }
+}
+
+
+/**
+ * flickcurl_photo_get_field:
+ * @photo: photo object
+ * @field: field
+ *
+ * Get a photo field
+ *
+ * For photos built in lazy mode (see flickcurl_set_lazy_photos()) the
+ * field is decoded from the response on the first call and kept in
+ * @photo.  Other photos just return their field.
+ *
+ * Return value: field (of type VALUE_TYPE_NONE if absent) or NULL if @field is not valid
+ **/
+flickcurl_photo_field*
+flickcurl_photo_get_field(flickcurl_photo *photo,
+                          flickcurl_photo_field_type field)
+{
+  struct flickcurl_photo_lazy_s* lazy = photo->lazy;
+  int i = (int)field;
+
+  if(i < 0 || i > PHOTO_FIELD_LAST)
+    return NULL;
+
+  if(lazy && i != PHOTO_FIELD_none &&
+     !(lazy->decoded[i >> 3] & (1 << (i & 7)))) {
+    lazy->decoded[i >> 3] |= (unsigned char)(1 << (i & 7));
+    flickcurl_photo_decode_field(photo, field);
+  }
+
+  return &photo->fields[i];
+}
+
+
+/**
+ * flickcurl_set_lazy_photos:
+ * @fc: flickcurl object
+ * @lazy_photos: non-0 to decode photo fields on access
+ *
+ * Set whether photos built from XML responses decode fields on access
+ *
+ * In lazy mode only the ID and the photo parts allowed by
+ * flickcurl_set_photo_fields() are built with the photo.  The
+ * photo's node is kept out of the response and each field is decoded
+ * and kept the first time it is read with flickcurl_photo_get_field().
+ * Reading #flickcurl_photo @fields directly sees them empty until then.
+ * Fields are decoded under the photo field mask in force when the
+ * photo was built, so later mask changes do not affect it.
+ *
+ * The photo nodes of a response are freed with the last photo built
+ * from it.  Lazy photos must be freed before @fc.  Photos decoded
+ * from JSON (see flickcurl_set_json_mode()) are always built in full.
+ */
+void
+flickcurl_set_lazy_photos(flickcurl* fc, int lazy_photos)
+{
+  fc->lazy_photos = lazy_photos;
+}
+
+
+/*
+ * flickcurl_photo_set_field_from_path:
+ * @fc: flickcurl context
+ * @photo: photo
+ * @path: XPath of the value relative to the photo element such as "./@id"
+ * @string_value: new string value (ownership taken)
+ *
+ * INTERNAL - set a photo field from a value found at a path
+ *
+ * Used by decoders of formats other than XML that mirror the XML
+ * structure of a photo.  Values at paths that are not photo fields
+ * are freed.
+ */
+void
+flickcurl_photo_set_field_from_path(flickcurl* fc, flickcurl_photo* photo,
+                                    const char* path, char* string_value)
+{
+  int expri;
+
+  for(expri = 0; photo_fields_table[expri].xpath; expri++) {
+    if(!strcmp((const char*)photo_fields_table[expri].xpath, path)) {
+      if(!flickcurl_photo_table_field_wanted(fc, expri))
+        break;
+      flickcurl_photo_set_table_field(fc, photo, expri, string_value);
+      return;
+    }
+  }
+
+  free(string_value);
+}
+
+
 flickcurl_photo**
 flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
                        const xmlChar* xpathExpr, int* photo_count_p)
@@ -965,14 +1446,27 @@ flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   int photo_count;
   xmlXPathObjectPtr xpathObj = NULL;
   xmlNodeSetPtr nodes;
+  xmlXPathContextPtr xpathNodeCtx = NULL;
   xmlChar full_xpath[512];
   size_t xpathExpr_len;
+  int parts;
+  flickcurl_photo_source* source = NULL;
   int i;
   
+  parts = fc->photo_fields_masked ? fc->photo_parts : FLICKCURL_PHOTO_PART_ALL;
+
+  if(fc->lazy_photos) {
+    source = flickcurl_new_photo_source(fc, xpathCtx->doc);
+    if(!source) {
+      fc->failed = 1;
+      goto tidy;
+    }
+  }
+
   xpathExpr_len = strlen((const char*)xpathExpr);
   strncpy((char*)full_xpath, (const char*)xpathExpr, xpathExpr_len+1);
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -985,11 +1479,18 @@ flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   nodes_count = xmlXPathNodeSetGetLength(nodes);
   photos = (flickcurl_photo**)calloc(sizeof(flickcurl_photo*), nodes_count+1);
 
+  /* one XPath context is moved to each node in turn */
+  xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
+  if(!xpathNodeCtx) {
+    flickcurl_error(fc, "Failed to create XPath context for document");
+    fc->failed = 1;
+    goto tidy;
+  }
+
   for(i = 0, photo_count = 0; i < nodes_count; i++) {
     xmlNodePtr node = nodes->nodeTab[i];
     flickcurl_photo* photo;
     int expri;
-    xmlXPathContextPtr xpathNodeCtx = NULL;
     
     if(node->type != XML_ELEMENT_NODE) {
       flickcurl_error(fc, "Got unexpected node type %d", node->type);
@@ -999,8 +1500,6 @@ flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     
     photo = (flickcurl_photo*)calloc(sizeof(flickcurl_photo), 1);
 
-    /* set up a new XPath context relative to the current node */
-    xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
     xpathNodeCtx->node = node;
     
     for(expri = 0; expri <= PHOTO_FIELD_LAST; expri++) {
@@ -1013,135 +1512,63 @@ flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
 
     for(expri = 0; photo_fields_table[expri].xpath; expri++) {
       char *string_value;
-      flickcurl_field_value_type datatype = photo_fields_table[expri].type;
-      int int_value= -1;
-      flickcurl_photo_field_type field = photo_fields_table[expri].field;
-      time_t unix_time;
-      int special = 0;
-      
-      string_value = flickcurl_xpath_eval(fc, xpathNodeCtx,
-                                        photo_fields_table[expri].xpath);
-      if(!string_value)
-        continue;
 
-#if FLICKCURL_DEBUG > 1
-        fprintf(stderr, "  type %d  string value '%s'\n", datatype,
-                string_value);
-#endif
-      switch(datatype) {
-        case VALUE_TYPE_PHOTO_ID:
-          photo->id = string_value;
-          string_value = NULL;
-          datatype = VALUE_TYPE_NONE;
-          break;
-
-        case VALUE_TYPE_PHOTO_URI:
-          photo->uri = string_value;
-          string_value = NULL;
-          datatype = VALUE_TYPE_NONE;
-          break;
-
-        case VALUE_TYPE_MEDIA_TYPE:
-          photo->media_type = string_value;
-          string_value = NULL;
-          datatype = VALUE_TYPE_NONE;
-          break;
-
-        case VALUE_TYPE_UNIXTIME:
-        case VALUE_TYPE_DATETIME:
-
-          if(datatype == VALUE_TYPE_UNIXTIME)
-            unix_time = atoi(string_value);
-          else
-            unix_time = curl_getdate((const char*)string_value, NULL);
-
-          if(unix_time >= 0) {
-            char* new_value = flickcurl_unixtime_to_isotime(unix_time);
-#if FLICKCURL_DEBUG > 1
-            fprintf(stderr, "  date from: '%s' unix time %ld to '%s'\n",
-                    string_value, (long)unix_time, new_value);
-#endif
-            free(string_value);
-            string_value= new_value;
-            int_value= (int)unix_time;
-            datatype = VALUE_TYPE_DATETIME;
-          } else
-            /* failed to convert, make it a string */
-            datatype = VALUE_TYPE_STRING;
-          break;
-
-        case VALUE_TYPE_INTEGER:
-        case VALUE_TYPE_BOOLEAN:
-          if(!*string_value && datatype == VALUE_TYPE_BOOLEAN) {
-            /* skip setting field with a boolean value '' */
-            special = 1;
-            break;
-          }
-
-          int_value = atoi(string_value);
-          break;
-
-        case VALUE_TYPE_TAG_STRING:
-          /* A space-separated list of tags */
-          photo->tags = flickcurl_build_tags_from_string(fc, photo,
-                                                         (const char*)string_value,
-                                                         &photo->tags_count);
-          special = 1;
-          break;
-
-
-        case VALUE_TYPE_NONE:
-        case VALUE_TYPE_STRING:
-        case VALUE_TYPE_FLOAT:
-        case VALUE_TYPE_URI:
-          break;
-
-        case VALUE_TYPE_PERSON_ID:
-        case VALUE_TYPE_COLLECTION_ID:
-        case VALUE_TYPE_ICON_PHOTOS:
-          abort();
-      }
+      if(!flickcurl_photo_table_field_wanted(fc, expri))
+        continue;
 
-      if(special)
+      /* lazy photos decode fields when read */
+      if(source && photo_fields_table[expri].field != PHOTO_FIELD_none)
         continue;
 
-      photo->fields[field].string = string_value;
-      photo->fields[field].integer= (flickcurl_photo_field_type)int_value;
-      photo->fields[field].type   = datatype;
+      string_value = flickcurl_xpath_eval(fc, xpathNodeCtx,
+                                        photo_fields_table[expri].xpath);
+      if(!string_value)
+        continue;
 
-  #if FLICKCURL_DEBUG > 1
-      fprintf(stderr, "field %d with %s value: '%s' / %d\n",
-              field, flickcurl_get_field_value_type_label(datatype), 
-              string_value, int_value);
-  #endif
+      flickcurl_photo_set_table_field(fc, photo, expri, string_value);
 
       if(fc->failed)
         goto tidy;
     } /* end for */
 
-    if(!photo->tags)
+    if(!photo->tags && (parts & FLICKCURL_PHOTO_PART_TAGS))
       photo->tags = flickcurl_build_tags(fc, photo, xpathNodeCtx, 
                                        (const xmlChar*)"./tags/tag",
                                        &photo->tags_count);
 
-    if(!photo->place)
+    if(!photo->place && (parts & FLICKCURL_PHOTO_PART_PLACE))
       photo->place = flickcurl_build_place(fc, xpathNodeCtx,
                                          (const xmlChar*)"./location");
 
-    photo->video = flickcurl_build_video(fc, xpathNodeCtx,
-                                       (const xmlChar*)"./video");
+    if(parts & FLICKCURL_PHOTO_PART_VIDEO)
+      photo->video = flickcurl_build_video(fc, xpathNodeCtx,
+                                         (const xmlChar*)"./video");
     
-    photo->notes = flickcurl_build_notes(fc, photo, xpathNodeCtx, 
-                                         (const xmlChar*)"./notes/note",
-                                         &photo->notes_count);
+    if(parts & FLICKCURL_PHOTO_PART_NOTES)
+      photo->notes = flickcurl_build_notes(fc, photo, xpathNodeCtx, 
+                                           (const xmlChar*)"./notes/note",
+                                           &photo->notes_count);
 
     if(!photo->media_type) {
       photo->media_type = (char*)malloc(6);
       strncpy(photo->media_type, "photo", 6);
     }
 
-    if(xpathNodeCtx)
-      xmlXPathFreeContext(xpathNodeCtx);
+
+    if(source) {
+      photo->lazy = (struct flickcurl_photo_lazy_s*)calloc(1, sizeof(*photo->lazy));
+      if(!photo->lazy) {
+        flickcurl_free_photo(photo);
+        fc->failed = 1;
+        goto tidy;
+      }
+      /* move the node out of the response */
+      xmlUnlinkNode(node);
+      xmlAddChild(xmlDocGetRootElement(source->doc), node);
+      photo->lazy->source = source;
+      photo->lazy->node = node;
+      source->usage++;
+    }
 
     photos[photo_count++] = photo;
   } /* for photos */
@@ -1150,8 +1577,12 @@ flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     *photo_count_p = photo_count;
 
   tidy:
+  if(xpathNodeCtx)
+    xmlXPathFreeContext(xpathNodeCtx);
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
+  if(source)
+    flickcurl_photo_source_release(source);
   if(fc->failed)
     photos = NULL;
 
@@ -1159,6 +1590,142 @@ flickcurl_build_photos(flickcurl* fc, xmlXPathContextPtr xpathCtx,
 }
 
 
+/* extras a photo list needs to return each field */
+static const struct {
+  flickcurl_photo_field_type field;
+  const char* extra;
+} flickcurl_photo_field_extras[] = {
+  { PHOTO_FIELD_dateuploaded, "date_upload" },
+  { PHOTO_FIELD_dates_taken, "date_taken" },
+  { PHOTO_FIELD_dates_takengranularity, "date_taken" },
+  { PHOTO_FIELD_dates_lastupdate, "last_update" },
+  { PHOTO_FIELD_license, "license" },
+  { PHOTO_FIELD_originalformat, "original_format" },
+  { PHOTO_FIELD_originalsecret, "original_format" },
+  { PHOTO_FIELD_owner_realname, "owner_name" },
+  { PHOTO_FIELD_owner_iconserver, "icon_server" },
+  { PHOTO_FIELD_owner_iconfarm, "icon_server" },
+  { PHOTO_FIELD_location_latitude, "geo" },
+  { PHOTO_FIELD_location_longitude, "geo" },
+  { PHOTO_FIELD_location_accuracy, "geo" },
+  { PHOTO_FIELD_location_placeid, "geo" },
+  { PHOTO_FIELD_location_woeid, "geo" },
+  { PHOTO_FIELD_original_width, "o_dims" },
+  { PHOTO_FIELD_original_height, "o_dims" },
+  { PHOTO_FIELD_views, "views" },
+  { PHOTO_FIELD_description, "description" },
+  { PHOTO_FIELD_none, NULL }
+};
+
+/* size of a buffer holding every extra above and those of the parts
+ * with commas; currently 134 characters
+ */
+#define PHOTO_FIELD_EXTRAS_SIZE 256
+
+
+static void
+flickcurl_photo_fields_add_extra(char* extras, const char* extra)
+{
+  size_t len = strlen(extra);
+  size_t extras_len = strlen(extras);
+  const char* p;
+
+  /* skip extras already listed */
+  for(p = extras; (p = strstr(p, extra)); p += len) {
+    if((p == extras || p[-1] == ',') && (p[len] == ',' || !p[len]))
+      return;
+  }
+
+  if(extras_len + len + 2 > PHOTO_FIELD_EXTRAS_SIZE)
+    return;
+
+  if(*extras)
+    strcat(extras, ",");
+  strcat(extras, extra);
+}
+
+
+/**
+ * flickcurl_set_photo_fields:
+ * @fc: flickcurl object
+ * @fields: #PHOTO_FIELD_none terminated array of photo fields to build or NULL for all
+ * @parts: #flickcurl_photo_part bits of the other photo parts to build
+ *
+ * Set the photo fields and parts built for photos returned by @fc
+ *
+ * Photos are then built with only their ID, the given fields and the
+ * given parts: the others are neither parsed nor allocated and are
+ * left empty.  The default media type "photo" is always set.
+ *
+ * When a photos list call is made without extras in its
+ * #flickcurl_photos_list_params the extras needed for @fields and
+ * @parts are sent instead, such as <code>date_taken</code> for
+ * #PHOTO_FIELD_dates_taken or <code>tags</code> and
+ * <code>machine_tags</code> for #FLICKCURL_PHOTO_PART_TAGS.
+ *
+ * The mask applies to every call of @fc returning photos, including
+ * flickcurl_photos_getInfo(), except that flickcurl_sync_run() always
+ * builds #PHOTO_FIELD_dates_lastupdate.  Pass NULL @fields to build
+ * everything again.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_set_photo_fields(flickcurl* fc,
+                           const flickcurl_photo_field_type* fields, int parts)
+{
+  char extras[PHOTO_FIELD_EXTRAS_SIZE];
+  int i;
+
+  if(fc->photo_fields_extras) {
+    free(fc->photo_fields_extras);
+    fc->photo_fields_extras = NULL;
+  }
+
+  memset(fc->photo_fields_mask, '\0', sizeof(fc->photo_fields_mask));
+  fc->photo_fields_masked = (fields != NULL);
+  fc->photo_parts = parts;
+
+  if(!fields)
+    return 0;
+
+  *extras = '\0';
+  for(i = 0; fields[i] != PHOTO_FIELD_none; i++) {
+    int j;
+
+    if(fields[i] < PHOTO_FIELD_FIRST || fields[i] > PHOTO_FIELD_LAST) {
+      flickcurl_error(fc, "Unknown photo field %d", (int)fields[i]);
+      fc->photo_fields_masked = 0;
+      return 1;
+    }
+
+    fc->photo_fields_mask[(int)fields[i]] = 1;
+
+    for(j = 0; flickcurl_photo_field_extras[j].extra; j++) {
+      if(flickcurl_photo_field_extras[j].field == fields[i])
+        flickcurl_photo_fields_add_extra(extras,
+                                         flickcurl_photo_field_extras[j].extra);
+    }
+  }
+
+  if(parts & FLICKCURL_PHOTO_PART_TAGS) {
+    flickcurl_photo_fields_add_extra(extras, "tags");
+    flickcurl_photo_fields_add_extra(extras, "machine_tags");
+  }
+  if(parts & FLICKCURL_PHOTO_PART_MEDIA)
+    flickcurl_photo_fields_add_extra(extras, "media");
+
+  if(*extras) {
+    fc->photo_fields_extras = (char*)malloc(strlen(extras) + 1);
+    if(!fc->photo_fields_extras)
+      return 1;
+    strcpy(fc->photo_fields_extras, extras);
+  }
+
+  return 0;
+}
+
+
 flickcurl_photo*
 flickcurl_build_photo(flickcurl* fc, xmlXPathContextPtr xpathCtx)
 {
@@ -1215,6 +1782,8 @@ flickcurl_invoke_photos_list(flickcurl* fc, const xmlChar* xpathExpr,
   xmlXPathContextPtr xpathNodeCtx = NULL;
   const char *nformat;
   size_t format_len;
+  int json = 0;
+  int i;
 
   photos_list = (flickcurl_photos_list*)calloc(1, sizeof(*photos_list));
   if(!photos_list) {
@@ -1238,6 +1807,56 @@ flickcurl_invoke_photos_list(flickcurl* fc, const xmlChar* xpathExpr,
     }
 
   } else {
+    /* JSON requested by flickcurl_append_photos_list_params() */
+    for(i = 0; fc->param_fields && fc->param_fields[i]; i++) {
+      if(!strcmp(fc->param_fields[i], "format") &&
+         !strcmp(fc->param_values[i], "json")) {
+        json = 1;
+        break;
+      }
+    }
+  }
+
+  if(json) {
+    char list_key[32];
+    const char* key_start = (const char*)xpathExpr;
+    size_t key_len;
+    char* content;
+    size_t content_length;
+
+    /* '/rsp/photos' or '/rsp/photoset/photo' has list key photos or photoset */
+    if(!strncmp(key_start, "/rsp/", 5))
+      key_start += 5;
+    key_len = strcspn(key_start, "/");
+    if(key_len >= sizeof(list_key))
+      key_len = sizeof(list_key) - 1;
+    memcpy(list_key, key_start, key_len);
+    list_key[key_len] = '\0';
+
+    nformat = "json";
+    format_len = 4;
+
+    content = flickcurl_invoke_get_content(fc, &content_length);
+    if(!content) {
+      fc->failed = 1;
+      goto tidy;
+    }
+
+    flickcurl_build_photos_list_from_json(fc, photos_list, content,
+                                          content_length, list_key);
+    free(content);
+    if(fc->failed)
+      goto tidy;
+
+    if(!photos_list->photos) {
+      photos_list->photos = (flickcurl_photo**)calloc(1, sizeof(flickcurl_photo*));
+      if(!photos_list->photos) {
+        fc->failed = 1;
+        goto tidy;
+      }
+    }
+
+  } else if(!format) {
     xmlDocPtr doc = NULL;
     xmlNodePtr photos_node;
     size_t xpathExprLen = strlen((const char*)xpathExpr);
@@ -1347,6 +1966,8 @@ flickcurl_invoke_photos_list(flickcurl* fc, const xmlChar* xpathExpr,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed) {
     if(photos_list)
       flickcurl_free_photos_list(photos_list);
@@ -83,6 +83,7 @@ flickcurl_photos_addTags(flickcurl* fc, const char* photo_id, const char* tags)
     goto tidy;
 
  tidy:
+  flickcurl_timing_end_build(fc);
 
   return fc->failed;
 }
@@ -128,6 +129,7 @@ flickcurl_photos_delete(flickcurl* fc, const char* photo_id)
   result = 0;
 
  tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -172,6 +174,7 @@ flickcurl_photos_getAllContexts(flickcurl* fc, const char* photo_id)
   contexts = flickcurl_build_contexts(fc, doc);
 
  tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     contexts = NULL;
 
@@ -231,7 +234,7 @@ flickcurl_photos_getContactsPhotos_params(flickcurl* fc,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -364,7 +367,7 @@ flickcurl_photos_getContactsPublicPhotos_params(flickcurl* fc,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
   
   parameters[count][0]  = NULL;
 
@@ -477,6 +480,7 @@ flickcurl_photos_getContext(flickcurl* fc, const char* photo_id)
   contexts = flickcurl_build_contexts(fc, doc);
 
  tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     contexts = NULL;
 
@@ -634,6 +638,8 @@ flickcurl_photos_getCounts(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     counts = NULL;
 
@@ -706,6 +712,8 @@ flickcurl_photos_getExif(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     exifs = NULL;
 
@@ -774,6 +782,8 @@ flickcurl_photos_getFavorites(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     persons = NULL;
 
@@ -827,6 +837,8 @@ flickcurl_photos_getInfo(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     photo = NULL;
 
@@ -877,7 +889,7 @@ flickcurl_get_photoslist_params(flickcurl* fc,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -1038,6 +1050,8 @@ flickcurl_photos_getPerms(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     perms = NULL;
 
@@ -1073,7 +1087,7 @@ flickcurl_photos_getRecent_params(flickcurl* fc,
   /* No API parameters */
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -1187,6 +1201,8 @@ flickcurl_photos_getSizes(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     sizes = NULL;
 
@@ -1520,7 +1536,7 @@ flickcurl_photos_recentlyUpdated_params(flickcurl* fc, int min_date,
   }
   
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -1626,6 +1642,7 @@ flickcurl_photos_removeTag(flickcurl* fc, const char* tag_id)
     goto tidy;
 
  tidy:
+  flickcurl_timing_end_build(fc);
 
   return fc->failed;
 }
@@ -1851,7 +1868,7 @@ flickcurl_photos_search_params(flickcurl* fc,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -1973,6 +1990,7 @@ flickcurl_photos_setContentType(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -2063,6 +2081,8 @@ flickcurl_photos_setDates(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = 1;
 
@@ -2132,6 +2152,8 @@ flickcurl_photos_setMeta(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = 1;
 
@@ -2221,6 +2243,8 @@ flickcurl_photos_setPerms(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = 1;
 
@@ -2298,6 +2322,8 @@ flickcurl_photos_setSafetyLevel(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = 1;
 
@@ -2348,6 +2374,7 @@ flickcurl_photos_setTags(flickcurl* fc, const char* photo_id, const char* tags)
     goto tidy;
 
  tidy:
+  flickcurl_timing_end_build(fc);
 
   return fc->failed;
 }
@@ -0,0 +1,340 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * photos-batch.c - Flickcurl batched photo metadata functions
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/* Every extra that maps onto a #flickcurl_photo field */
+#define PHOTOS_BATCH_EXTRAS "description,license,date_upload,date_taken,owner_name,icon_server,original_format,last_update,geo,tags,machine_tags,o_dims,views,media"
+
+/* Maximum page size allowed by the list APIs */
+#define PHOTOS_BATCH_PER_PAGE 500
+
+
+/* Fields that are only returned by flickr.photos.getInfo and never
+ * by a list API with extras
+ */
+static const flickcurl_photo_field_type photos_batch_getinfo_only_fields[] = {
+  PHOTO_FIELD_isfavorite,
+  PHOTO_FIELD_rotation,
+  PHOTO_FIELD_dates_posted,
+  PHOTO_FIELD_editability_canaddmeta,
+  PHOTO_FIELD_editability_cancomment,
+  PHOTO_FIELD_geoperms_iscontact,
+  PHOTO_FIELD_geoperms_isfamily,
+  PHOTO_FIELD_geoperms_isfriend,
+  PHOTO_FIELD_geoperms_ispublic,
+  PHOTO_FIELD_owner_location,
+  PHOTO_FIELD_owner_username,
+  PHOTO_FIELD_location_neighbourhood,
+  PHOTO_FIELD_location_locality,
+  PHOTO_FIELD_location_county,
+  PHOTO_FIELD_location_region,
+  PHOTO_FIELD_location_country,
+  PHOTO_FIELD_neighbourhood_placeid,
+  PHOTO_FIELD_neighborhood_placeid,
+  PHOTO_FIELD_locality_placeid,
+  PHOTO_FIELD_county_placeid,
+  PHOTO_FIELD_region_placeid,
+  PHOTO_FIELD_country_placeid,
+  PHOTO_FIELD_neighbourhood_woeid,
+  PHOTO_FIELD_neighborhood_woeid,
+  PHOTO_FIELD_locality_woeid,
+  PHOTO_FIELD_county_woeid,
+  PHOTO_FIELD_region_woeid,
+  PHOTO_FIELD_country_woeid,
+  PHOTO_FIELD_usage_candownload,
+  PHOTO_FIELD_usage_canblog,
+  PHOTO_FIELD_usage_canprint,
+  PHOTO_FIELD_comments,
+  PHOTO_FIELD_favorites,
+  PHOTO_FIELD_none
+};
+
+
+typedef struct {
+  long long id;
+  int index;
+} flickcurl_photos_batch_entry;
+
+
+static int
+flickcurl_photos_batch_entry_compare(const void *a, const void *b)
+{
+  const flickcurl_photos_batch_entry* e1 = (const flickcurl_photos_batch_entry*)a;
+  const flickcurl_photos_batch_entry* e2 = (const flickcurl_photos_batch_entry*)b;
+
+  if(e1->id < e2->id)
+    return -1;
+  return (e1->id > e2->id);
+}
+
+
+static int
+flickcurl_photos_batch_needs_getinfo(const flickcurl_photo_field_type* fields)
+{
+  int i;
+
+  if(!fields)
+    return 0;
+
+  for(i = 0; fields[i] != PHOTO_FIELD_none; i++) {
+    int j;
+
+    for(j = 0; photos_batch_getinfo_only_fields[j] != PHOTO_FIELD_none; j++) {
+      if(fields[i] == photos_batch_getinfo_only_fields[j])
+        return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_photos_batch_fill_owner:
+ * @fc: flickcurl context
+ * @owner: owner NSID
+ * @entries: sorted wanted photo entries for @owner
+ * @entries_count: size of @entries
+ * @photos: results array indexed by entry index
+ *
+ * INTERNAL - page through an owner's photos with extras until all
+ * wanted photos for that owner have been seen.
+ *
+ * Photo IDs increase with upload time so the owner's photos are
+ * listed newest first and paging stops once a page is entirely older
+ * than the oldest wanted photo, at the end of the owner's photos or
+ * at the search ceiling.  Photos older than the ceiling are left for
+ * the caller to fetch with getInfo.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_photos_batch_fill_owner(flickcurl* fc, const char* owner,
+                                  flickcurl_photos_batch_entry* entries,
+                                  int entries_count,
+                                  flickcurl_photo** photos)
+{
+  flickcurl_search_params params;
+  flickcurl_photos_list_params list_params;
+  long long min_id = entries[0].id;
+  int found = 0;
+  int pages = FLICKCURL_SEARCH_CEILING / PHOTOS_BATCH_PER_PAGE;
+  int page;
+
+  flickcurl_search_params_init(&params);
+  params.user_id = (char*)owner;
+  params.sort = (char*)"date-posted-desc";
+
+  flickcurl_photos_list_params_init(&list_params);
+  list_params.extras = PHOTOS_BATCH_EXTRAS;
+  list_params.per_page = PHOTOS_BATCH_PER_PAGE;
+
+  for(page = 1; found < entries_count && page <= pages; page++) {
+    flickcurl_photos_list* photos_list;
+    long long page_max_id = 0;
+    int i;
+
+    list_params.page = page;
+    photos_list = flickcurl_photos_search_params(fc, &params, &list_params);
+    if(!photos_list)
+      return 1;
+
+    for(i = 0; i < photos_list->photos_count; i++) {
+      flickcurl_photo* photo = photos_list->photos[i];
+      flickcurl_photos_batch_entry key;
+      flickcurl_photos_batch_entry* entry;
+
+      key.id = flickcurl_photo_get_id_number(photo);
+      if(key.id > page_max_id)
+        page_max_id = key.id;
+
+      entry = (flickcurl_photos_batch_entry*)bsearch(&key, entries,
+                                                     entries_count,
+                                                     sizeof(*entries),
+                                                     flickcurl_photos_batch_entry_compare);
+      if(entry && !photos[entry->index]) {
+        photos[entry->index] = photo;
+        found++;
+      } else
+        flickcurl_free_photo(photo);
+    }
+
+    if(page == 1 && photos_list->total_count >= 0) {
+      int total_pages = (photos_list->total_count + PHOTOS_BATCH_PER_PAGE - 1) /
+        PHOTOS_BATCH_PER_PAGE;
+
+      if(total_pages < pages)
+        pages = total_pages;
+    }
+
+    free(photos_list->photos);
+    photos_list->photos = NULL;
+    flickcurl_free_photos_list(photos_list);
+
+    /* last page or the whole page predates every wanted photo */
+    if(i < PHOTOS_BATCH_PER_PAGE || page_max_id < min_id)
+      break;
+  }
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_photos_getInfo_batch:
+ * @fc: flickcurl context
+ * @photo_ids: array of photo IDs
+ * @owners: array of owner NSIDs parallel to @photo_ids or NULL if not known (entries may also be NULL)
+ * @count: number of entries in @photo_ids
+ * @fields: #PHOTO_FIELD_none terminated array of photo fields required or NULL for any
+ *
+ * Get information about many photos with the fewest web service calls.
+ *
+ * Photos with a known owner are fetched 500 at a time via
+ * flickcurl_photos_search_params() with the owner's @user_id and all
+ * the photo field extras.  Photos with no owner, photos not found in
+ * the owner's list, including those older than the newest 4000 that
+ * a search can return, and photos needing any of @fields that are only
+ * available from flickr.photos.getInfo are fetched one by one with
+ * flickcurl_photos_getInfo().
+ *
+ * The result array is the same size and order as @photo_ids with
+ * NULL entries for photos that could not be found.  Free it with
+ * flickcurl_free_photos_batch().
+ *
+ * Return value: array of @count #flickcurl_photo pointers or NULL on failure
+ **/
+flickcurl_photo**
+flickcurl_photos_getInfo_batch(flickcurl* fc, const char** photo_ids,
+                               const char** owners, int count,
+                               const flickcurl_photo_field_type* fields)
+{
+  flickcurl_photo** photos = NULL;
+  flickcurl_photos_batch_entry* entries = NULL;
+  char* done = NULL;
+  int i;
+
+  if(!photo_ids || count < 0)
+    return NULL;
+
+  photos = (flickcurl_photo**)calloc(count+1, sizeof(flickcurl_photo*));
+  if(!photos)
+    goto failed;
+
+  if(owners && !flickcurl_photos_batch_needs_getinfo(fields)) {
+    entries = (flickcurl_photos_batch_entry*)calloc(count+1, sizeof(*entries));
+    done = (char*)calloc(count+1, 1);
+    if(!entries || !done)
+      goto failed;
+
+    /* Plan one paged list walk per distinct owner */
+    for(i = 0; i < count; i++) {
+      int entries_count = 0;
+      int j;
+
+      if(done[i] || !owners[i])
+        continue;
+
+      for(j = i; j < count; j++) {
+        if(!done[j] && owners[j] && !strcmp(owners[i], owners[j])) {
+          entries[entries_count].id = flickcurl_id_to_number(photo_ids[j]);
+          entries[entries_count].index = j;
+          entries_count++;
+          done[j] = 1;
+        }
+      }
+
+      qsort(entries, entries_count, sizeof(*entries),
+            flickcurl_photos_batch_entry_compare);
+
+      /* on failure, the photos not yet found fall back to getInfo below */
+      if(flickcurl_photos_batch_fill_owner(fc, owners[i], entries,
+                                           entries_count, photos))
+        fc->failed = 0;
+    }
+  }
+
+  /* Fall back to one call per photo for the rest */
+  for(i = 0; i < count; i++) {
+    if(photos[i])
+      continue;
+
+    photos[i] = flickcurl_photos_getInfo(fc, photo_ids[i]);
+    /* a missing photo is not a failure of the batch */
+    fc->failed = 0;
+  }
+
+  free(entries);
+  free(done);
+
+  return photos;
+
+  failed:
+  if(entries)
+    free(entries);
+  if(done)
+    free(done);
+  if(photos)
+    flickcurl_free_photos_batch(photos, count);
+
+  return NULL;
+}
+
+
+/**
+ * flickcurl_free_photos_batch:
+ * @photos: photo array from flickcurl_photos_getInfo_batch()
+ * @count: size of @photos array
+ *
+ * Destructor for photo array returned by flickcurl_photos_getInfo_batch()
+ */
+void
+flickcurl_free_photos_batch(flickcurl_photo** photos, int count)
+{
+  int i;
+
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(photos, flickcurl_photo_array);
+
+  for(i = 0; i < count; i++) {
+    if(photos[i])
+      flickcurl_free_photo(photos[i]);
+  }
+  free(photos);
+}
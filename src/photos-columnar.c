@@ -0,0 +1,777 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * photos-columnar.c - Flickcurl columnar photo export
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * File layout, modelled on Parquet.  Fixed width integers are little
+ * endian, varints are unsigned LEB128 and signed values are zigzag
+ * encoded.
+ *
+ *   "FCC1"
+ *   column chunks for row group 0, then row group 1, ...
+ *   footer
+ *   u32 footer length
+ *   "FCC1"
+ *
+ * Footer:
+ *   varint columns count
+ *   per column: varint name length, name bytes, varint column type,
+ *     varint PHOTO_FIELD_* (0 for non-field columns)
+ *   varint row groups count
+ *   per row group: varint rows count, then per column: varint chunk
+ *     offset, varint chunk length
+ *
+ * Column chunk (rows known from the footer):
+ *   presence: runs of varint (run length << 1 | present) covering all
+ *     rows (absent for list columns)
+ *   then for the present values only:
+ *   INTEGER, DATETIME, BOOLEAN: zigzag delta from the previous value
+ *     (the first from 0); DATETIME is a unix time in seconds
+ *   DOUBLE: 8 byte IEEE 754 values
+ *   STRING: varint dictionary size, per entry varint length and bytes,
+ *     then runs of varint dictionary index, varint run length
+ *   STRING_LIST: varint count per row then the values as STRING
+ */
+
+#define COLUMNS_MAGIC "FCC1"
+
+#define COLUMNS_DEFAULT_ROW_GROUP_SIZE 10000
+
+#define COLUMN_TYPE_INTEGER 1
+#define COLUMN_TYPE_DATETIME 2
+#define COLUMN_TYPE_BOOLEAN 3
+#define COLUMN_TYPE_DOUBLE 4
+#define COLUMN_TYPE_STRING 5
+#define COLUMN_TYPE_STRING_LIST 6
+
+
+static void
+flickcurl_columns_put_size(flickcurl_binary_buffer* buf, size_t value)
+{
+  unsigned char bytes[10];
+  size_t len = 0;
+
+  while(value >= 0x80) {
+    bytes[len++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  bytes[len++] = (unsigned char)value;
+
+  flickcurl_binary_put_bytes(buf, bytes, len);
+}
+
+
+static unsigned int
+flickcurl_columns_hash(const char* string)
+{
+  unsigned int hash = 5381;
+
+  while(*string)
+    hash = (hash * 33) ^ (unsigned char)*string++;
+
+  return hash;
+}
+
+
+/*
+ * flickcurl_columns_encode_strings:
+ * @buf: output buffer
+ * @strings: string values
+ * @count: number of @strings
+ *
+ * INTERNAL - dictionary and run length encode string values
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_columns_encode_strings(flickcurl_binary_buffer* buf,
+                                 char** strings, int count)
+{
+  int* slots;
+  int* indexes;
+  int* dict;
+  int dict_count = 0;
+  unsigned int slots_size = 16;
+  int i;
+
+  while(slots_size < (unsigned int)count * 2)
+    slots_size <<= 1;
+
+  slots = (int*)malloc(slots_size * sizeof(int));
+  indexes = (int*)malloc((count + 1) * sizeof(int));
+  dict = (int*)malloc((count + 1) * sizeof(int));
+  if(!slots || !indexes || !dict) {
+    if(slots)
+      free(slots);
+    if(indexes)
+      free(indexes);
+    if(dict)
+      free(dict);
+    return 1;
+  }
+
+  /* slots hold the index into @dict plus 1 of each distinct string */
+  memset(slots, '\0', slots_size * sizeof(int));
+  for(i = 0; i < count; i++) {
+    unsigned int slot = flickcurl_columns_hash(strings[i]) & (slots_size - 1);
+
+    while(slots[slot] && strcmp(strings[dict[slots[slot] - 1]], strings[i]))
+      slot = (slot + 1) & (slots_size - 1);
+
+    if(!slots[slot]) {
+      dict[dict_count++] = i;
+      slots[slot] = dict_count;
+    }
+    indexes[i] = slots[slot] - 1;
+  }
+
+  flickcurl_binary_put_varint(buf, (unsigned int)dict_count);
+  for(i = 0; i < dict_count; i++) {
+    const char* string = strings[dict[i]];
+    size_t len = strlen(string);
+
+    flickcurl_columns_put_size(buf, len);
+    flickcurl_binary_put_bytes(buf, string, len);
+  }
+
+  for(i = 0; i < count; ) {
+    int run = 1;
+
+    while(i + run < count && indexes[i + run] == indexes[i])
+      run++;
+    flickcurl_binary_put_varint(buf, (unsigned int)indexes[i]);
+    flickcurl_binary_put_varint(buf, (unsigned int)run);
+    i += run;
+  }
+
+  free(slots);
+  free(indexes);
+  free(dict);
+
+  return 0;
+}
+
+
+static void
+flickcurl_columns_encode_presence(flickcurl_binary_buffer* buf,
+                                  const char* present, int rows)
+{
+  int i;
+
+  for(i = 0; i < rows; ) {
+    int run = 1;
+
+    while(i + run < rows && present[i + run] == present[i])
+      run++;
+    flickcurl_binary_put_varint(buf,
+                                ((unsigned int)run << 1) | (present[i] ? 1 : 0));
+    i += run;
+  }
+}
+
+
+static int
+flickcurl_columns_encode_chunk(flickcurl_binary_buffer* buf,
+                               flickcurl_column* column, int rows)
+{
+  unsigned int previous = 0;
+  int i;
+
+  switch(column->type) {
+    case COLUMN_TYPE_INTEGER:
+    case COLUMN_TYPE_DATETIME:
+    case COLUMN_TYPE_BOOLEAN:
+      flickcurl_columns_encode_presence(buf, column->present, rows);
+      for(i = 0; i < column->values_count; i++) {
+        /* unsigned arithmetic so the delta wraps rather than overflows */
+        unsigned int value = (unsigned int)column->ints[i];
+
+        flickcurl_binary_put_int(buf, (int)(value - previous));
+        previous = value;
+      }
+      break;
+
+    case COLUMN_TYPE_DOUBLE:
+      flickcurl_columns_encode_presence(buf, column->present, rows);
+      for(i = 0; i < column->values_count; i++)
+        flickcurl_binary_put_double(buf, column->doubles[i]);
+      break;
+
+    case COLUMN_TYPE_STRING:
+      flickcurl_columns_encode_presence(buf, column->present, rows);
+      return flickcurl_columns_encode_strings(buf, column->strings,
+                                              column->values_count);
+
+    case COLUMN_TYPE_STRING_LIST:
+      for(i = 0; i < rows; i++)
+        flickcurl_binary_put_varint(buf, (unsigned int)column->ints[i]);
+      return flickcurl_columns_encode_strings(buf, column->strings,
+                                              column->values_count);
+
+    default:
+      return 1;
+  }
+
+  return 0;
+}
+
+
+static int
+flickcurl_columns_add_string(flickcurl_column* column, const char* string)
+{
+  size_t len = strlen(string);
+  char* copy;
+
+  if(column->values_count == column->values_size) {
+    int new_size = column->values_size ? column->values_size << 1 : 64;
+    char** new_strings;
+
+    new_strings = (char**)realloc(column->strings, new_size * sizeof(char*));
+    if(!new_strings)
+      return 1;
+    column->strings = new_strings;
+    column->values_size = new_size;
+  }
+
+  copy = (char*)malloc(len + 1);
+  if(!copy)
+    return 1;
+  memcpy(copy, string, len + 1);
+  column->strings[column->values_count++] = copy;
+
+  return 0;
+}
+
+
+static void
+flickcurl_columns_reset(flickcurl_column* column)
+{
+  int i;
+
+  if(column->strings) {
+    for(i = 0; i < column->values_count; i++)
+      free(column->strings[i]);
+  }
+  column->values_count = 0;
+}
+
+
+static int
+flickcurl_columns_init_column(flickcurl_column_writer* writer,
+                              flickcurl_column* column, const char* name,
+                              int type, flickcurl_photo_field_type field,
+                              int place_type)
+{
+  size_t len = strlen(name);
+  int rows = writer->row_group_size;
+
+  column->name = (char*)malloc(len + 1);
+  if(!column->name)
+    return 1;
+  memcpy(column->name, name, len + 1);
+  column->type = type;
+  column->field = field;
+  column->place_type = place_type;
+
+  column->present = (char*)calloc(rows, 1);
+  if(!column->present)
+    return 1;
+
+  switch(type) {
+    case COLUMN_TYPE_INTEGER:
+    case COLUMN_TYPE_DATETIME:
+    case COLUMN_TYPE_BOOLEAN:
+    case COLUMN_TYPE_STRING_LIST:
+      column->ints = (int*)calloc(rows, sizeof(int));
+      return !column->ints;
+
+    case COLUMN_TYPE_DOUBLE:
+      column->doubles = (double*)calloc(rows, sizeof(double));
+      return !column->doubles;
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_columns_write:
+ * @writer: column writer
+ * @data: bytes
+ * @len: size of @data
+ *
+ * INTERNAL - write bytes to the output and advance the offset
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_columns_write(flickcurl_column_writer* writer,
+                        const void* data, size_t len)
+{
+  if(len && fwrite(data, 1, len, writer->fh) != len) {
+    flickcurl_error(writer->fc, "Failed to write columnar export - %s",
+                    strerror(errno));
+    writer->failed = 1;
+    return 1;
+  }
+  writer->offset += len;
+  return 0;
+}
+
+
+/*
+ * flickcurl_columns_flush:
+ * @writer: column writer
+ *
+ * INTERNAL - encode and write the pending rows as one row group
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_columns_flush(flickcurl_column_writer* writer)
+{
+  flickcurl_binary_buffer chunk;
+  int i;
+  int rc = 0;
+
+  if(!writer->rows_count)
+    return 0;
+
+  memset(&chunk, '\0', sizeof(chunk));
+
+  flickcurl_binary_put_varint(&writer->row_groups, (unsigned int)writer->rows_count);
+
+  for(i = 0; i < writer->columns_count; i++) {
+    flickcurl_column* column = &writer->columns[i];
+
+    chunk.len = 0;
+    if(flickcurl_columns_encode_chunk(&chunk, column, writer->rows_count) ||
+       chunk.failed) {
+      rc = 1;
+      break;
+    }
+
+    flickcurl_columns_put_size(&writer->row_groups, writer->offset);
+    flickcurl_columns_put_size(&writer->row_groups, chunk.len);
+    if(flickcurl_columns_write(writer, chunk.data, chunk.len)) {
+      rc = 1;
+      break;
+    }
+
+    flickcurl_columns_reset(column);
+  }
+
+  if(chunk.data)
+    free(chunk.data);
+
+  writer->row_groups_count++;
+  writer->rows_count = 0;
+
+  if(rc || writer->row_groups.failed)
+    writer->failed = 1;
+
+  return writer->failed;
+}
+
+
+/**
+ * flickcurl_new_column_writer:
+ * @fc: flickcurl context
+ * @fh: file handle to write to
+ * @fields: #PHOTO_FIELD_none terminated array of photo fields to export or NULL for all
+ * @row_group_size: rows per row group or 0 for the default
+ *
+ * Create a columnar exporter for photos
+ *
+ * Writes a file of row groups where each column is stored
+ * contiguously: the photo ID, each of @fields, the photo tags and the
+ * place ID for each place type.  Integer, boolean and date fields
+ * are written as delta encoded integers (dates as unix times) from
+ * #flickcurl_photo_field integer, floating point fields as doubles
+ * and other fields as dictionary and run length encoded strings so
+ * that scans over many photos can be done one column at a time.
+ *
+ * Add photos with flickcurl_column_writer_add_photo() or
+ * flickcurl_column_writer_add_photos_list() and then call
+ * flickcurl_column_writer_finish() to write the footer.
+ *
+ * Return value: new column writer or NULL on failure
+ **/
+flickcurl_column_writer*
+flickcurl_new_column_writer(flickcurl* fc, FILE* fh,
+                            const flickcurl_photo_field_type* fields,
+                            int row_group_size)
+{
+  flickcurl_column_writer* writer;
+  int fields_count = 0;
+  int i;
+
+  if(!fh)
+    return NULL;
+
+  writer = (flickcurl_column_writer*)calloc(1, sizeof(*writer));
+  if(!writer)
+    return NULL;
+
+  writer->fc = fc;
+  writer->fh = fh;
+  writer->row_group_size = row_group_size > 0 ? row_group_size :
+    COLUMNS_DEFAULT_ROW_GROUP_SIZE;
+
+  if(fields) {
+    while(fields[fields_count] != PHOTO_FIELD_none)
+      fields_count++;
+  } else
+    fields_count = PHOTO_FIELD_LAST;
+
+  /* id + fields + tags + place ids */
+  writer->columns = (flickcurl_column*)calloc(fields_count + 2 + FLICKCURL_PLACE_LAST + 1,
+                                              sizeof(flickcurl_column));
+  if(!writer->columns)
+    goto failed;
+
+  if(flickcurl_columns_init_column(writer, &writer->columns[writer->columns_count++],
+                                   "id", COLUMN_TYPE_STRING,
+                                   PHOTO_FIELD_none, -1))
+    goto failed;
+
+  for(i = 0; i < fields_count; i++) {
+    flickcurl_photo_field_type field;
+    int type;
+
+    field = fields ? fields[i] : (flickcurl_photo_field_type)(i + 1);
+    if(field > PHOTO_FIELD_LAST)
+      continue;
+
+    switch(flickcurl_get_photo_field_value_type(field)) {
+      case VALUE_TYPE_DATETIME:
+        type = COLUMN_TYPE_DATETIME;
+        break;
+
+      case VALUE_TYPE_INTEGER:
+        type = COLUMN_TYPE_INTEGER;
+        break;
+
+      case VALUE_TYPE_BOOLEAN:
+        type = COLUMN_TYPE_BOOLEAN;
+        break;
+
+      case VALUE_TYPE_FLOAT:
+        type = COLUMN_TYPE_DOUBLE;
+        break;
+
+      case VALUE_TYPE_NONE:
+        /* never built */
+        continue;
+
+      case VALUE_TYPE_PHOTO_ID:
+      case VALUE_TYPE_PHOTO_URI:
+      case VALUE_TYPE_UNIXTIME:
+      case VALUE_TYPE_STRING:
+      case VALUE_TYPE_URI:
+      case VALUE_TYPE_PERSON_ID:
+      case VALUE_TYPE_MEDIA_TYPE:
+      case VALUE_TYPE_TAG_STRING:
+      case VALUE_TYPE_COLLECTION_ID:
+      case VALUE_TYPE_ICON_PHOTOS:
+      default:
+        type = COLUMN_TYPE_STRING;
+        break;
+    }
+
+    if(flickcurl_columns_init_column(writer, &writer->columns[writer->columns_count++],
+                                     flickcurl_get_photo_field_label(field),
+                                     type, field, -1))
+      goto failed;
+  }
+
+  if(flickcurl_columns_init_column(writer, &writer->columns[writer->columns_count++],
+                                   "tags", COLUMN_TYPE_STRING_LIST,
+                                   PHOTO_FIELD_none, -1))
+    goto failed;
+
+  for(i = 0; i <= FLICKCURL_PLACE_LAST; i++) {
+    char name[64];
+
+    sprintf(name, "place_%s_id",
+            flickcurl_get_place_type_label((flickcurl_place_type)i));
+    if(flickcurl_columns_init_column(writer, &writer->columns[writer->columns_count++],
+                                     name, COLUMN_TYPE_STRING,
+                                     PHOTO_FIELD_none, i))
+      goto failed;
+  }
+
+  if(flickcurl_columns_write(writer, COLUMNS_MAGIC, 4))
+    goto failed;
+
+  return writer;
+
+  failed:
+  flickcurl_free_column_writer(writer);
+  return NULL;
+}
+
+
+/**
+ * flickcurl_free_column_writer:
+ * @writer: column writer
+ *
+ * Destructor for column writer
+ *
+ * Does not close the file handle; use flickcurl_column_writer_finish()
+ * first to complete the file.
+ */
+void
+flickcurl_free_column_writer(flickcurl_column_writer* writer)
+{
+  int i;
+
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(writer, flickcurl_column_writer);
+
+  if(writer->columns) {
+    for(i = 0; i < writer->columns_count; i++) {
+      flickcurl_column* column = &writer->columns[i];
+
+      flickcurl_columns_reset(column);
+      if(column->name)
+        free(column->name);
+      if(column->present)
+        free(column->present);
+      if(column->ints)
+        free(column->ints);
+      if(column->doubles)
+        free(column->doubles);
+      if(column->strings)
+        free(column->strings);
+    }
+    free(writer->columns);
+  }
+
+  if(writer->row_groups.data)
+    free(writer->row_groups.data);
+
+  free(writer);
+}
+
+
+/**
+ * flickcurl_column_writer_add_photo:
+ * @writer: column writer
+ * @photo: photo
+ *
+ * Add a photo as a row of a columnar export
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_column_writer_add_photo(flickcurl_column_writer* writer,
+                                  flickcurl_photo* photo)
+{
+  int row = writer->rows_count;
+  int i;
+
+  if(writer->failed)
+    return 1;
+
+  for(i = 0; i < writer->columns_count; i++) {
+    flickcurl_column* column = &writer->columns[i];
+    const char* string = NULL;
+    int j;
+
+    if(column->type == COLUMN_TYPE_STRING_LIST) {
+      column->ints[row] = 0;
+      for(j = 0; j < photo->tags_count; j++) {
+        flickcurl_tag* tag = photo->tags[j];
+        const char* value = tag->cooked ? tag->cooked : tag->raw;
+
+        if(!value)
+          continue;
+        if(flickcurl_columns_add_string(column, value))
+          goto failed;
+        column->ints[row]++;
+      }
+      column->present[row] = 1;
+      continue;
+    }
+
+    if(column->place_type >= 0) {
+      if(photo->place)
+        string = photo->place->ids[column->place_type];
+    } else if(column->field == PHOTO_FIELD_none)
+      string = photo->id;
+    else {
+      flickcurl_photo_field* field;
+
+      field = flickcurl_photo_get_field(photo, column->field);
+
+      switch(column->type) {
+        case COLUMN_TYPE_INTEGER:
+        case COLUMN_TYPE_DATETIME:
+        case COLUMN_TYPE_BOOLEAN:
+          /* dates that could not be parsed are left as strings */
+          column->present[row] = (field->type == VALUE_TYPE_DATETIME ||
+                                  field->type == VALUE_TYPE_INTEGER ||
+                                  field->type == VALUE_TYPE_BOOLEAN);
+          if(column->present[row])
+            column->ints[column->values_count++] = (int)field->integer;
+          continue;
+
+        case COLUMN_TYPE_DOUBLE:
+          column->present[row] = (field->type != VALUE_TYPE_NONE &&
+                                  field->string);
+          if(column->present[row])
+            column->doubles[column->values_count++] = atof(field->string);
+          continue;
+
+        default:
+          if(field->type != VALUE_TYPE_NONE)
+            string = field->string;
+          break;
+      }
+    }
+
+    column->present[row] = (string != NULL);
+    if(string && flickcurl_columns_add_string(column, string))
+      goto failed;
+  }
+
+  writer->rows_count++;
+  if(writer->rows_count == writer->row_group_size)
+    return flickcurl_columns_flush(writer);
+
+  return 0;
+
+  failed:
+  flickcurl_error(writer->fc, "Out of memory in columnar export");
+  writer->failed = 1;
+  return 1;
+}
+
+
+/**
+ * flickcurl_column_writer_add_photos_list:
+ * @writer: column writer
+ * @photos_list: photos list
+ *
+ * Add all the photos in a photos list as rows of a columnar export
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_column_writer_add_photos_list(flickcurl_column_writer* writer,
+                                        flickcurl_photos_list* photos_list)
+{
+  int i;
+
+  for(i = 0; i < photos_list->photos_count; i++) {
+    if(flickcurl_column_writer_add_photo(writer, photos_list->photos[i]))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * flickcurl_column_writer_finish:
+ * @writer: column writer
+ *
+ * Write the last row group and the footer of a columnar export
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_column_writer_finish(flickcurl_column_writer* writer)
+{
+  flickcurl_binary_buffer footer;
+  unsigned char footer_len[4];
+  int rc = 1;
+  int i;
+
+  if(flickcurl_columns_flush(writer))
+    return 1;
+
+  memset(&footer, '\0', sizeof(footer));
+
+  flickcurl_binary_put_varint(&footer, (unsigned int)writer->columns_count);
+  for(i = 0; i < writer->columns_count; i++) {
+    flickcurl_column* column = &writer->columns[i];
+    size_t len = strlen(column->name);
+
+    flickcurl_columns_put_size(&footer, len);
+    flickcurl_binary_put_bytes(&footer, column->name, len);
+    flickcurl_binary_put_varint(&footer, (unsigned int)column->type);
+    flickcurl_binary_put_varint(&footer, (unsigned int)column->field);
+  }
+
+  flickcurl_binary_put_varint(&footer, (unsigned int)writer->row_groups_count);
+  if(writer->row_groups.len)
+    flickcurl_binary_put_bytes(&footer, writer->row_groups.data,
+                               writer->row_groups.len);
+
+  if(footer.failed)
+    goto tidy;
+
+  flickcurl_binary_set_u32(footer_len, (unsigned int)footer.len);
+  if(flickcurl_columns_write(writer, footer.data, footer.len) ||
+     flickcurl_columns_write(writer, footer_len, 4) ||
+     flickcurl_columns_write(writer, COLUMNS_MAGIC, 4))
+    goto tidy;
+
+  if(fflush(writer->fh)) {
+    flickcurl_error(writer->fc, "Failed to write columnar export - %s",
+                    strerror(errno));
+    goto tidy;
+  }
+
+  rc = 0;
+
+  tidy:
+  if(footer.data)
+    free(footer.data);
+
+  return rc;
+}
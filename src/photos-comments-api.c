@@ -98,6 +98,8 @@ flickcurl_photos_comments_addComment(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     id = NULL;
 
@@ -146,6 +148,7 @@ flickcurl_photos_comments_deleteComment(flickcurl* fc, const char* comment_id)
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -198,6 +201,7 @@ flickcurl_photos_comments_editComment(flickcurl* fc, const char* comment_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -257,6 +261,8 @@ flickcurl_photos_comments_getList(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     comments = NULL;
 
@@ -302,7 +308,7 @@ flickcurl_photos_comments_getRecentForContacts_params(flickcurl* fc,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
   parameters[count][0]  = NULL;
 
   if(flickcurl_prepare(fc, "flickr.photos.comments.getRecentForContacts",
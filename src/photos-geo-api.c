@@ -125,6 +125,7 @@ flickcurl_photos_geo_batchCorrectLocation(flickcurl* fc,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -194,6 +195,8 @@ flickcurl_photos_geo_correctLocation(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = NULL;
 
@@ -251,6 +254,8 @@ flickcurl_photos_geo_getLocation(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     location = NULL;
 
@@ -308,6 +313,8 @@ flickcurl_photos_geo_getPerms(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     perms = NULL;
 
@@ -365,7 +372,7 @@ flickcurl_photos_geo_photosForLocation_params(flickcurl* fc,
   parameters[count++][1]= accuracy_s;
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -471,6 +478,7 @@ flickcurl_photos_geo_removeLocation(flickcurl* fc, const char* photo_id)
     goto tidy;
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return fc->failed;
 }
@@ -537,6 +545,8 @@ flickcurl_photos_geo_setContext(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = NULL;
 
@@ -613,6 +623,7 @@ flickcurl_photos_geo_setLocation(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -678,6 +689,7 @@ flickcurl_photos_geo_setPerms(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -0,0 +1,667 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * photos-json.c - Flickcurl JSON photos list decoding
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * The Flickr JSON format mirrors the XML one: attributes become keys
+ * with scalar values, element content becomes a "_content" key and
+ * child elements become nested objects.  Photo values are mapped back
+ * to the XPaths of the XML decoder so the same field table is used.
+ *
+ * The tokenizer walks the response once with no intermediate tree;
+ * only values that are kept are copied.
+ */
+
+/* Longest key or path kept; longer ones are never photo fields */
+#define JSON_PATH_SIZE 128
+
+/* Deepest nesting of objects and arrays accepted */
+#define JSON_MAX_DEPTH 32
+
+
+typedef struct {
+  flickcurl* fc;
+  const char* p;
+  const char* end;
+  int depth;
+  int failed;
+} flickcurl_json_parser;
+
+
+static void
+flickcurl_json_skip_ws(flickcurl_json_parser* jp)
+{
+  while(jp->p < jp->end &&
+        (*jp->p == ' ' || *jp->p == '\t' || *jp->p == '\n' || *jp->p == '\r'))
+    jp->p++;
+}
+
+
+static int
+flickcurl_json_expect(flickcurl_json_parser* jp, char c)
+{
+  flickcurl_json_skip_ws(jp);
+  if(jp->p < jp->end && *jp->p == c) {
+    jp->p++;
+    return 0;
+  }
+
+  jp->failed = 1;
+  return 1;
+}
+
+
+static int
+flickcurl_json_hex4(const char* p, unsigned long* value_p)
+{
+  unsigned long value = 0;
+  int i;
+
+  for(i = 0; i < 4; i++) {
+    char c = p[i];
+
+    value <<= 4;
+    if(c >= '0' && c <= '9')
+      value |= (unsigned long)(c - '0');
+    else if(c >= 'a' && c <= 'f')
+      value |= (unsigned long)(c - 'a' + 10);
+    else if(c >= 'A' && c <= 'F')
+      value |= (unsigned long)(c - 'A' + 10);
+    else
+      return 1;
+  }
+
+  *value_p = value;
+  return 0;
+}
+
+
+/*
+ * flickcurl_json_parse_string:
+ * @jp: parser at an opening quote
+ * @buffer: buffer to decode into or NULL to skip the string
+ * @buffer_size: size of @buffer; longer strings are truncated
+ * @len_p: pointer to store decoded length (or NULL)
+ *
+ * INTERNAL - read a JSON string
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_json_parse_string(flickcurl_json_parser* jp, char* buffer,
+                            size_t buffer_size, size_t* len_p)
+{
+  size_t len = 0;
+
+  if(flickcurl_json_expect(jp, '"'))
+    return 1;
+
+  while(jp->p < jp->end && *jp->p != '"') {
+    unsigned char utf8[4];
+    size_t utf8_len = 1;
+    char c = *jp->p++;
+
+    utf8[0] = (unsigned char)c;
+    if(c == '\\') {
+      if(jp->p >= jp->end)
+        break;
+      c = *jp->p++;
+      switch(c) {
+        case 'b': utf8[0] = '\b'; break;
+        case 'f': utf8[0] = '\f'; break;
+        case 'n': utf8[0] = '\n'; break;
+        case 'r': utf8[0] = '\r'; break;
+        case 't': utf8[0] = '\t'; break;
+
+        case 'u': {
+          unsigned long cp;
+
+          if(jp->end - jp->p < 4 || flickcurl_json_hex4(jp->p, &cp))
+            goto failed;
+          jp->p += 4;
+
+          /* surrogate pair */
+          if(cp >= 0xD800 && cp <= 0xDBFF) {
+            unsigned long low;
+
+            if(jp->end - jp->p < 6 || jp->p[0] != '\\' || jp->p[1] != 'u' ||
+               flickcurl_json_hex4(jp->p + 2, &low) ||
+               low < 0xDC00 || low > 0xDFFF)
+              goto failed;
+            jp->p += 6;
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          }
+
+          if(cp < 0x80)
+            utf8[0] = (unsigned char)cp;
+          else if(cp < 0x800) {
+            utf8[0] = (unsigned char)(0xC0 | (cp >> 6));
+            utf8[1] = (unsigned char)(0x80 | (cp & 0x3F));
+            utf8_len = 2;
+          } else if(cp < 0x10000) {
+            utf8[0] = (unsigned char)(0xE0 | (cp >> 12));
+            utf8[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+            utf8[2] = (unsigned char)(0x80 | (cp & 0x3F));
+            utf8_len = 3;
+          } else {
+            utf8[0] = (unsigned char)(0xF0 | (cp >> 18));
+            utf8[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+            utf8[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+            utf8[3] = (unsigned char)(0x80 | (cp & 0x3F));
+            utf8_len = 4;
+          }
+          break;
+        }
+
+        default:
+          /* \" \\ \/ */
+          utf8[0] = (unsigned char)c;
+          break;
+      }
+    }
+
+    if(buffer && len + utf8_len < buffer_size)
+      memcpy(buffer + len, utf8, utf8_len);
+    len += utf8_len;
+  }
+
+  if(jp->p >= jp->end)
+    goto failed;
+  jp->p++;
+
+  if(buffer)
+    buffer[len < buffer_size ? len : buffer_size - 1] = '\0';
+  if(len_p)
+    *len_p = len;
+
+  return 0;
+
+  failed:
+  jp->failed = 1;
+  return 1;
+}
+
+
+/*
+ * flickcurl_json_parse_scalar:
+ * @jp: parser at a value that is not an object or array
+ *
+ * INTERNAL - read a string, number or literal as a new string
+ *
+ * true and false become "1" and "0" like the XML attributes.
+ *
+ * Return value: new string or NULL for null or on failure
+ */
+static char*
+flickcurl_json_parse_scalar(flickcurl_json_parser* jp)
+{
+  const char* start;
+  char* value;
+  size_t len;
+
+  flickcurl_json_skip_ws(jp);
+  if(jp->p >= jp->end) {
+    jp->failed = 1;
+    return NULL;
+  }
+
+  if(*jp->p == '"') {
+    flickcurl_json_parser save = *jp;
+
+    /* measure then decode */
+    if(flickcurl_json_parse_string(jp, NULL, 0, &len))
+      return NULL;
+    value = (char*)malloc(len + 1);
+    if(!value) {
+      jp->failed = 1;
+      return NULL;
+    }
+    *jp = save;
+    flickcurl_json_parse_string(jp, value, len + 1, NULL);
+    return value;
+  }
+
+  start = jp->p;
+  while(jp->p < jp->end && *jp->p != ',' && *jp->p != '}' && *jp->p != ']' &&
+        *jp->p != ' ' && *jp->p != '\t' && *jp->p != '\n' && *jp->p != '\r')
+    jp->p++;
+  len = jp->p - start;
+
+  if(!len) {
+    jp->failed = 1;
+    return NULL;
+  }
+
+  if(len == 4 && !strncmp(start, "null", 4))
+    return NULL;
+  if(len == 4 && !strncmp(start, "true", 4)) {
+    start = "1";
+    len = 1;
+  } else if(len == 5 && !strncmp(start, "false", 5)) {
+    start = "0";
+    len = 1;
+  }
+
+  value = (char*)malloc(len + 1);
+  if(!value) {
+    jp->failed = 1;
+    return NULL;
+  }
+  memcpy(value, start, len);
+  value[len] = '\0';
+
+  return value;
+}
+
+
+static void
+flickcurl_json_skip_value(flickcurl_json_parser* jp)
+{
+  flickcurl_json_skip_ws(jp);
+  if(jp->p >= jp->end) {
+    jp->failed = 1;
+    return;
+  }
+
+  if(*jp->p == '{' || *jp->p == '[') {
+    char close = (*jp->p == '{') ? '}' : ']';
+
+    if(++jp->depth > JSON_MAX_DEPTH) {
+      jp->failed = 1;
+      return;
+    }
+    jp->p++;
+    flickcurl_json_skip_ws(jp);
+    if(jp->p < jp->end && *jp->p == close) {
+      jp->p++;
+      jp->depth--;
+      return;
+    }
+    while(!jp->failed) {
+      if(close == '}') {
+        if(flickcurl_json_parse_string(jp, NULL, 0, NULL) ||
+           flickcurl_json_expect(jp, ':'))
+          return;
+      }
+      flickcurl_json_skip_value(jp);
+      flickcurl_json_skip_ws(jp);
+      if(jp->p < jp->end && *jp->p == ',') {
+        jp->p++;
+        continue;
+      }
+      flickcurl_json_expect(jp, close);
+      break;
+    }
+    jp->depth--;
+  } else if(*jp->p == '"')
+    flickcurl_json_parse_string(jp, NULL, 0, NULL);
+  else {
+    while(jp->p < jp->end && *jp->p != ',' && *jp->p != '}' &&
+          *jp->p != ']' && *jp->p != ' ' && *jp->p != '\n' &&
+          *jp->p != '\r' && *jp->p != '\t')
+      jp->p++;
+  }
+}
+
+
+/*
+ * flickcurl_json_parse_photo_object:
+ * @jp: parser at an object
+ * @photo: photo to fill
+ * @path: XPath of the object relative to the photo, "." for the photo
+ * @path_len: length of @path
+ *
+ * INTERNAL - read a photo object or one nested inside it
+ */
+static void
+flickcurl_json_parse_photo_object(flickcurl_json_parser* jp,
+                                  flickcurl_photo* photo,
+                                  char* path, size_t path_len)
+{
+  if(flickcurl_json_expect(jp, '{'))
+    return;
+  if(++jp->depth > JSON_MAX_DEPTH) {
+    jp->failed = 1;
+    return;
+  }
+
+  flickcurl_json_skip_ws(jp);
+  if(jp->p < jp->end && *jp->p == '}') {
+    jp->p++;
+    jp->depth--;
+    return;
+  }
+
+  while(!jp->failed) {
+    char key[JSON_PATH_SIZE];
+    size_t key_len;
+
+    if(flickcurl_json_parse_string(jp, key, sizeof(key), &key_len) ||
+       flickcurl_json_expect(jp, ':'))
+      break;
+
+    flickcurl_json_skip_ws(jp);
+    if(jp->p >= jp->end) {
+      jp->failed = 1;
+      break;
+    }
+
+    if(key_len >= sizeof(key) || path_len + 2 + key_len >= JSON_PATH_SIZE)
+      flickcurl_json_skip_value(jp);
+    else if(*jp->p == '{') {
+      /* child element */
+      path[path_len] = '/';
+      memcpy(path + path_len + 1, key, key_len + 1);
+      flickcurl_json_parse_photo_object(jp, photo, path,
+                                        path_len + 1 + key_len);
+      path[path_len] = '\0';
+    } else if(*jp->p == '[')
+      flickcurl_json_skip_value(jp);
+    else {
+      char* value = flickcurl_json_parse_scalar(jp);
+
+      if(value) {
+        if(!strcmp(key, "_content"))
+          /* element content */
+          flickcurl_photo_set_field_from_path(jp->fc, photo, path, value);
+        else {
+          /* attribute */
+          path[path_len] = '/';
+          path[path_len + 1] = '@';
+          memcpy(path + path_len + 2, key, key_len + 1);
+          flickcurl_photo_set_field_from_path(jp->fc, photo, path, value);
+          path[path_len] = '\0';
+        }
+      }
+    }
+
+    flickcurl_json_skip_ws(jp);
+    if(jp->p < jp->end && *jp->p == ',') {
+      jp->p++;
+      continue;
+    }
+    flickcurl_json_expect(jp, '}');
+    break;
+  }
+
+  jp->depth--;
+}
+
+
+static void
+flickcurl_json_parse_photos(flickcurl_json_parser* jp,
+                            flickcurl_photos_list* photos_list)
+{
+  int size = 0;
+
+  if(flickcurl_json_expect(jp, '['))
+    return;
+
+  flickcurl_json_skip_ws(jp);
+  if(jp->p < jp->end && *jp->p == ']') {
+    jp->p++;
+    return;
+  }
+
+  while(!jp->failed) {
+    flickcurl_photo* photo;
+    char path[JSON_PATH_SIZE];
+    int i;
+
+    if(photos_list->photos_count + 1 >= size) {
+      int new_size = size ? size << 1 : 64;
+      flickcurl_photo** new_photos;
+
+      new_photos = (flickcurl_photo**)realloc(photos_list->photos,
+                                              new_size * sizeof(flickcurl_photo*));
+      if(!new_photos) {
+        jp->failed = 1;
+        break;
+      }
+      photos_list->photos = new_photos;
+      size = new_size;
+    }
+
+    photo = (flickcurl_photo*)calloc(1, sizeof(*photo));
+    if(!photo) {
+      jp->failed = 1;
+      break;
+    }
+    for(i = 0; i <= PHOTO_FIELD_LAST; i++) {
+      photo->fields[i].integer = (flickcurl_photo_field_type)-1;
+      photo->fields[i].type = VALUE_TYPE_NONE;
+    }
+    photos_list->photos[photos_list->photos_count++] = photo;
+    photos_list->photos[photos_list->photos_count] = NULL;
+
+    path[0] = '.';
+    path[1] = '\0';
+    flickcurl_json_parse_photo_object(jp, photo, path, 1);
+
+    if(!photo->media_type) {
+      photo->media_type = (char*)malloc(6);
+      if(photo->media_type)
+        memcpy(photo->media_type, "photo", 6);
+    }
+
+    flickcurl_json_skip_ws(jp);
+    if(jp->p < jp->end && *jp->p == ',') {
+      jp->p++;
+      continue;
+    }
+    flickcurl_json_expect(jp, ']');
+    break;
+  }
+}
+
+
+static void
+flickcurl_json_parse_list(flickcurl_json_parser* jp,
+                          flickcurl_photos_list* photos_list)
+{
+  if(flickcurl_json_expect(jp, '{'))
+    return;
+
+  flickcurl_json_skip_ws(jp);
+  if(jp->p < jp->end && *jp->p == '}') {
+    jp->p++;
+    return;
+  }
+
+  while(!jp->failed) {
+    char key[JSON_PATH_SIZE];
+
+    if(flickcurl_json_parse_string(jp, key, sizeof(key), NULL) ||
+       flickcurl_json_expect(jp, ':'))
+      break;
+
+    if(!strcmp(key, "photo"))
+      flickcurl_json_parse_photos(jp, photos_list);
+    else if(!strcmp(key, "page") || !strcmp(key, "perpage") ||
+            !strcmp(key, "total")) {
+      char* value = flickcurl_json_parse_scalar(jp);
+
+      if(value) {
+        if(key[0] == 'p' && key[1] == 'a')
+          photos_list->page = atoi(value);
+        else if(key[0] == 'p')
+          photos_list->per_page = atoi(value);
+        else
+          photos_list->total_count = atoi(value);
+        free(value);
+      }
+    } else
+      flickcurl_json_skip_value(jp);
+
+    flickcurl_json_skip_ws(jp);
+    if(jp->p < jp->end && *jp->p == ',') {
+      jp->p++;
+      continue;
+    }
+    flickcurl_json_expect(jp, '}');
+    break;
+  }
+}
+
+
+/*
+ * flickcurl_build_photos_list_from_json:
+ * @fc: flickcurl context
+ * @photos_list: photos list to fill
+ * @content: JSON response
+ * @content_length: length of @content
+ * @list_key: key of the list object in the response such as "photos"
+ *
+ * INTERNAL - decode a JSON photos list response
+ *
+ * The response may be wrapped in the jsonFlickrApi() callback.
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_build_photos_list_from_json(flickcurl* fc,
+                                      flickcurl_photos_list* photos_list,
+                                      const char* content,
+                                      size_t content_length,
+                                      const char* list_key)
+{
+  flickcurl_json_parser jp;
+  char* stat = NULL;
+  int error_code = 0;
+  char* error_msg = NULL;
+
+  memset(&jp, 0, sizeof(jp));
+  jp.fc = fc;
+  jp.p = content;
+  jp.end = content + content_length;
+
+  flickcurl_json_skip_ws(&jp);
+  if(jp.end - jp.p > 14 && !strncmp(jp.p, "jsonFlickrApi(", 14))
+    jp.p += 14;
+
+  if(flickcurl_json_expect(&jp, '{'))
+    goto tidy;
+
+  flickcurl_json_skip_ws(&jp);
+  if(jp.p < jp.end && *jp.p == '}')
+    jp.p++;
+  else while(!jp.failed) {
+    char key[JSON_PATH_SIZE];
+
+    if(flickcurl_json_parse_string(&jp, key, sizeof(key), NULL) ||
+       flickcurl_json_expect(&jp, ':'))
+      break;
+
+    if(!strcmp(key, list_key))
+      flickcurl_json_parse_list(&jp, photos_list);
+    else if(!strcmp(key, "stat")) {
+      if(stat)
+        free(stat);
+      stat = flickcurl_json_parse_scalar(&jp);
+    } else if(!strcmp(key, "code")) {
+      char* value = flickcurl_json_parse_scalar(&jp);
+
+      if(value) {
+        error_code = atoi(value);
+        free(value);
+      }
+    } else if(!strcmp(key, "message")) {
+      if(error_msg)
+        free(error_msg);
+      error_msg = flickcurl_json_parse_scalar(&jp);
+    } else
+      flickcurl_json_skip_value(&jp);
+
+    flickcurl_json_skip_ws(&jp);
+    if(jp.p < jp.end && *jp.p == ',') {
+      jp.p++;
+      continue;
+    }
+    flickcurl_json_expect(&jp, '}');
+    break;
+  }
+
+  tidy:
+  if(jp.failed) {
+    flickcurl_error(fc, "Failed to parse JSON response at offset %d",
+                    (int)(jp.p - content));
+    fc->failed = 1;
+  } else if(!stat || strcmp(stat, "ok")) {
+    fc->error_code = error_code;
+    if(fc->error_msg)
+      free(fc->error_msg);
+    fc->error_msg = error_msg;
+    error_msg = NULL;
+    if(fc->method)
+      flickcurl_error(fc, "Method %s failed with error %d - %s",
+                      fc->method, fc->error_code, fc->error_msg);
+    else
+      flickcurl_error(fc, "Call failed with error %d - %s",
+                      fc->error_code, fc->error_msg);
+    fc->failed = 1;
+  }
+
+  if(stat)
+    free(stat);
+  if(error_msg)
+    free(error_msg);
+
+  return fc->failed;
+}
+
+
+/**
+ * flickcurl_set_json_mode:
+ * @fc: flickcurl object
+ * @json_mode: non-0 to request photos lists as JSON
+ *
+ * Set whether photos lists are fetched in the JSON format
+ *
+ * When set, API calls returning a #flickcurl_photos_list that have no
+ * result format given in their #flickcurl_photos_list_params ask for
+ * the JSON format and decode it into the same photo structures
+ * without building a document tree.  The format of the returned list
+ * is "json".
+ */
+void
+flickcurl_set_json_mode(flickcurl* fc, int json_mode)
+{
+  fc->json_mode = json_mode;
+}
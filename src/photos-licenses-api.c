@@ -146,6 +146,8 @@ flickcurl_read_licenses(flickcurl *fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
 }
@@ -250,6 +252,7 @@ flickcurl_photos_licenses_setLicense(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
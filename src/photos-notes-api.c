@@ -122,6 +122,8 @@ flickcurl_photos_notes_add(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     id = NULL;
 
@@ -169,6 +171,7 @@ flickcurl_photos_notes_delete(flickcurl* fc, const char* note_id)
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -243,6 +246,7 @@ flickcurl_photos_notes_edit(flickcurl* fc,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -126,6 +126,8 @@ flickcurl_photos_people_add(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     rc = 1;
 
@@ -190,6 +192,8 @@ flickcurl_photos_people_delete(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = NULL;
 
@@ -255,6 +259,8 @@ flickcurl_photos_people_deleteCoords(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = NULL;
 
@@ -344,6 +350,8 @@ flickcurl_photos_people_editCoords(flickcurl* fc, const char* photo_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     rc = 1;
 
@@ -404,6 +412,8 @@ flickcurl_photos_people_getList(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     people = NULL;
 
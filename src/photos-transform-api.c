@@ -85,6 +85,7 @@ flickcurl_photos_transform_rotate(flickcurl* fc, const char* photo_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -96,6 +96,8 @@ flickcurl_photos_upload_checkTickets(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tickets = NULL;
   if(tickets_ids_string)
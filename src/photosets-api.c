@@ -86,6 +86,7 @@ flickcurl_photosets_addPhoto(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -159,6 +160,8 @@ flickcurl_photosets_create(flickcurl* fc, const char* title,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     photoset_id = NULL;
 
@@ -203,6 +206,7 @@ flickcurl_photosets_delete(flickcurl* fc, const char* photoset_id)
     goto tidy;
 
   tidy:
+  flickcurl_timing_end_build(fc);
 
   return fc->failed;
 }
@@ -257,6 +261,7 @@ flickcurl_photosets_editMeta(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -316,6 +321,7 @@ flickcurl_photosets_editPhotos(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
   if(photo_ids)
@@ -368,6 +374,7 @@ flickcurl_photosets_getContext(flickcurl* fc, const char* photo_id,
   contexts = flickcurl_build_contexts(fc, doc);
 
  tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     contexts = NULL;
 
@@ -424,6 +431,8 @@ flickcurl_photosets_getInfo(flickcurl* fc, const char* photoset_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     photoset = NULL;
 
@@ -480,6 +489,8 @@ flickcurl_photosets_getList(flickcurl* fc, const char* user_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     photoset_list = NULL;
 
@@ -529,7 +540,7 @@ flickcurl_photosets_getPhotos_params(flickcurl* fc, const char* photoset_id,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -537,7 +548,7 @@ flickcurl_photosets_getPhotos_params(flickcurl* fc, const char* photoset_id,
     goto tidy;
 
   photos_list = flickcurl_invoke_photos_list(fc,
-                                           (const xmlChar*)"/rsp/photoset/photo",
+                                           (const xmlChar*)"/rsp/photoset",
                                            format);
 
   tidy:
@@ -637,6 +648,7 @@ flickcurl_photosets_orderSets(flickcurl* fc, const char** photoset_ids_array)
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
   if(photoset_ids)
@@ -690,6 +702,7 @@ flickcurl_photosets_removePhoto(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -743,6 +756,7 @@ flickcurl_photosets_removePhotos(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(photo_ids)
     free(photo_ids);
 
@@ -796,6 +810,7 @@ flickcurl_photosets_reorderPhotos(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(photo_ids)
     free(photo_ids);
 
@@ -851,6 +866,7 @@ flickcurl_photosets_setPrimaryPhoto(flickcurl* fc, const char* photoset_id,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -100,6 +100,8 @@ flickcurl_photosets_comments_addComment(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     id = NULL;
 
@@ -149,6 +151,7 @@ flickcurl_photosets_comments_deleteComment(flickcurl* fc,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -202,6 +205,7 @@ flickcurl_photosets_comments_editComment(flickcurl* fc,
   result = 0;
 
   tidy:
+  flickcurl_timing_end_build(fc);
   if(fc->failed)
     result = 1;
 
@@ -263,6 +267,8 @@ flickcurl_photosets_comments_getList(flickcurl* fc, const char* photoset_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     comments = NULL;
 
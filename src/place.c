@@ -105,21 +105,17 @@ flickcurl_free_place(flickcurl_place *place)
   FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(place, flickcurl_place);
 
   for(i = 0; i <= FLICKCURL_PLACE_LAST; i++) {
-    if(place->names[i])
-      free(place->names[i]);
-    if(place->ids[i])
-      free(place->ids[i]);
-    if(place->urls[i])
-      free(place->urls[i]);
-    if(place->woe_ids[i])
-      free(place->woe_ids[i]);
+    flickcurl_intern_release(place->intern, place->names[i]);
+    flickcurl_intern_release(place->intern, place->ids[i]);
+    flickcurl_intern_release(place->intern, place->urls[i]);
+    flickcurl_intern_release(place->intern, place->woe_ids[i]);
   }
   
   if(place->shape)
     flickcurl_free_shape(place->shape);
 
-  if(place->timezone)
-    free(place->timezone);
+  flickcurl_intern_release(place->intern, place->timezone);
+  flickcurl_intern_table_release(place->intern);
 
   free(place);
 }
@@ -401,6 +397,27 @@ static struct {
 };
 
 
+/*
+ * flickcurl_place_register_xpaths:
+ *
+ * INTERNAL - compile the place field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_place_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; place_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(place_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
 
 /* get shapedata from value */
 flickcurl_place**
@@ -412,9 +429,10 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   int place_count;
   xmlXPathObjectPtr xpathObj = NULL;
   xmlNodeSetPtr nodes;
+  xmlXPathContextPtr xpathNodeCtx = NULL;
   int i;
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -427,10 +445,17 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   nodes_count = xmlXPathNodeSetGetLength(nodes);
   places = (flickcurl_place**)calloc(sizeof(flickcurl_place*), nodes_count+1);
 
+  /* one XPath context is moved to each node in turn */
+  xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
+  if(!xpathNodeCtx) {
+    flickcurl_error(fc, "Failed to create XPath context for document");
+    fc->failed = 1;
+    goto tidy;
+  }
+
   for(i = 0, place_count = 0; i < nodes_count; i++) {
     xmlNodePtr node = nodes->nodeTab[i];
     int expri;
-    xmlXPathContextPtr xpathNodeCtx = NULL;
     flickcurl_place* place;
     
     if(node->type != XML_ELEMENT_NODE) {
@@ -442,8 +467,6 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     place = (flickcurl_place*)calloc(sizeof(flickcurl_place), 1);
     place->type = FLICKCURL_PLACE_LOCATION;
 
-    /* set up a new XPath context relative to the current node */
-    xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
     xpathNodeCtx->node = node;
 
     for(expri = 0; expri <= FLICKCURL_PLACE_LAST; expri++) {
@@ -490,19 +513,19 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
       
       switch(place_field) {
         case PLACE_NAME:
-          place->names[(int)place_type] = value;
+          place->names[(int)place_type] = flickcurl_intern_string(fc, value, &place->intern);
           break;
           
         case PLACE_ID:
-          place->ids[(int)place_type] = value;
+          place->ids[(int)place_type] = flickcurl_intern_string(fc, value, &place->intern);
           break;
 
         case PLACE_WOE_ID:
-          place->woe_ids[(int)place_type] = value;
+          place->woe_ids[(int)place_type] = flickcurl_intern_string(fc, value, &place->intern);
           break;
 
         case PLACE_URL:
-          place->urls[(int)place_type] = value;
+          place->urls[(int)place_type] = flickcurl_intern_string(fc, value, &place->intern);
           break;
 
         case PLACE_TYPE:
@@ -528,7 +551,7 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
           break;
 
         case PLACE_TIMEZONE:
-          place->timezone = value;
+          place->timezone = flickcurl_intern_string(fc, value, &place->intern);
           break;
 
         case PLACE_SHAPE:
@@ -546,8 +569,6 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     } /* end for place fields */
 
    placestidy:
-    if(xpathNodeCtx)
-      xmlXPathFreeContext(xpathNodeCtx);
 
     places[place_count++] = place;
   } /* for places */
@@ -556,6 +577,8 @@ flickcurl_build_places(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     *place_count_p = place_count;
   
  tidy:
+  if(xpathNodeCtx)
+    xmlXPathFreeContext(xpathNodeCtx);
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
   
@@ -102,6 +102,8 @@ flickcurl_places_find(flickcurl* fc, const char* query)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     places = NULL;
 
@@ -180,6 +182,8 @@ flickcurl_places_findByLatLon(flickcurl* fc, double lat, double lon,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     place = NULL;
 
@@ -274,6 +278,8 @@ flickcurl_places_getChildrenWithPhotosPublic2(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     places = NULL;
 
@@ -370,6 +376,8 @@ flickcurl_places_getInfo2(flickcurl* fc, const char* place_id, int woe_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     place = NULL;
 
@@ -431,6 +439,8 @@ flickcurl_places_getInfoByUrl(flickcurl* fc, const char* url)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     place = NULL;
 
@@ -482,6 +492,8 @@ flickcurl_places_getPlaceTypes(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     place_types = NULL;
 
@@ -559,6 +571,8 @@ flickcurl_places_getShapeHistory(flickcurl* fc, const char* place_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     shapes = NULL;
 
@@ -640,6 +654,8 @@ flickcurl_places_getTopPlacesList(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     places = NULL;
 
@@ -727,6 +743,8 @@ flickcurl_places_placesForBoundingBox(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     places = NULL;
 
@@ -860,6 +878,8 @@ flickcurl_places_placesForContacts(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     places = NULL;
 
@@ -978,6 +998,8 @@ flickcurl_places_placesForTags(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     result = NULL;
 
@@ -1036,6 +1058,8 @@ flickcurl_places_resolvePlaceId(flickcurl* fc, const char* place_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     place = NULL;
 
@@ -1093,6 +1117,8 @@ flickcurl_places_resolvePlaceURL(flickcurl* fc, const char* url)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     place = NULL;
 
@@ -1190,6 +1216,8 @@ flickcurl_places_placesForUser(flickcurl* fc,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     places = NULL;
 
@@ -1314,6 +1342,8 @@ flickcurl_places_tagsForPlace(flickcurl* fc, int woe_id, const char* place_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
@@ -85,6 +85,8 @@ flickcurl_prefs_getContentType(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     content_type= -1;
 
@@ -170,6 +172,8 @@ flickcurl_prefs_getHidden(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     hidden= -1;
 
@@ -228,6 +232,8 @@ flickcurl_prefs_getPrivacy(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     privacy_level= -1;
 
@@ -282,6 +288,8 @@ flickcurl_prefs_getSafetyLevel(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     safety_level= -1;
 
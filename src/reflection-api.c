@@ -123,6 +123,8 @@ flickcurl_reflection_getMethods(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
 
@@ -176,6 +178,8 @@ flickcurl_reflection_getMethodInfo(flickcurl* fc, const char* name)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     method = NULL;
 
@@ -0,0 +1,357 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * search-partition.c - Flickcurl search split by date to fetch all results
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#include <time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/* Maximum page size allowed by flickr.photos.search */
+#define SEARCH_PER_PAGE 500
+
+/* Upload dates start when Flickr did */
+#define SEARCH_FIRST_UPLOAD_DATE 1072915200 /* 2004-01-01 */
+
+
+typedef struct {
+  time_t min_date;
+  time_t max_date;
+  /* estimated number of results or -1 if unknown */
+  int estimate;
+} flickcurl_search_slice;
+
+
+/* open addressing hash set of the photo IDs already returned */
+typedef struct {
+  long long* ids;
+  size_t size;
+  size_t count;
+} flickcurl_search_seen;
+
+
+static size_t
+flickcurl_search_seen_hash(long long id, size_t size)
+{
+  unsigned long long h = (unsigned long long)id;
+
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+
+  return (size_t)(h & (size - 1));
+}
+
+
+/*
+ * flickcurl_search_seen_add:
+ * @seen: ID set
+ * @id: photo ID (> 0)
+ *
+ * INTERNAL - add an ID to the set
+ *
+ * Return value: 1 if @id was already present, 0 if added, <0 on failure
+ */
+static int
+flickcurl_search_seen_add(flickcurl_search_seen* seen, long long id)
+{
+  size_t i;
+
+  if((seen->count + 1) * 2 > seen->size) {
+    size_t new_size = seen->size ? seen->size << 1 : 1024;
+    long long* new_ids;
+
+    new_ids = (long long*)calloc(new_size, sizeof(long long));
+    if(!new_ids)
+      return -1;
+    for(i = 0; i < seen->size; i++) {
+      size_t j;
+
+      if(!seen->ids[i])
+        continue;
+      j = flickcurl_search_seen_hash(seen->ids[i], new_size);
+      while(new_ids[j])
+        j = (j + 1) & (new_size - 1);
+      new_ids[j] = seen->ids[i];
+    }
+    if(seen->ids)
+      free(seen->ids);
+    seen->ids = new_ids;
+    seen->size = new_size;
+  }
+
+  i = flickcurl_search_seen_hash(id, seen->size);
+  while(seen->ids[i]) {
+    if(seen->ids[i] == id)
+      return 1;
+    i = (i + 1) & (seen->size - 1);
+  }
+  seen->ids[i] = id;
+  seen->count++;
+
+  return 0;
+}
+
+
+static void
+flickcurl_search_set_dates(flickcurl_search_params* params,
+                           int use_taken_dates, time_t min_date,
+                           time_t max_date, char** min_s_p, char** max_s_p)
+{
+  if(use_taken_dates) {
+    if(*min_s_p)
+      free(*min_s_p);
+    if(*max_s_p)
+      free(*max_s_p);
+    *min_s_p = flickcurl_unixtime_to_sqltimestamp(min_date);
+    *max_s_p = flickcurl_unixtime_to_sqltimestamp(max_date);
+    params->min_taken_date = *min_s_p;
+    params->max_taken_date = *max_s_p;
+  } else {
+    params->min_upload_date = (int)min_date;
+    params->max_upload_date = (int)max_date;
+  }
+}
+
+
+/**
+ * flickcurl_photos_search_all:
+ * @fc: flickcurl context
+ * @params: search parameters
+ * @extras: extra fields to fetch (or NULL)
+ * @use_taken_dates: non-0 to split on the date taken rather than the upload date
+ * @handler: function called with each photo found
+ * @user_data: user data for @handler
+ * @truncated_count_p: pointer to store number of results that could not be fetched (or NULL)
+ *
+ * Fetch every result of a photo search by splitting it into date ranges
+ *
+ * flickr.photos.search returns at most a few thousand results for one
+ * query.  This call probes the result count of the query and bisects
+ * its upload (or taken) date range until every slice fits under that
+ * ceiling, then pages through each slice in date order, streaming the
+ * photos to @handler.  Photos seen at slice boundaries or repeated
+ * when results move between pages are only passed on once.
+ *
+ * The date range of @params is used as the bounds, defaulting to the
+ * start of Flickr (or of 1970 for taken dates) and now.  A one second
+ * slice that is still over the ceiling is fetched up to the ceiling
+ * and the rest is counted in *@truncated_count_p.
+ *
+ * The photo passed to @handler is owned by the search and must not be
+ * freed.  If @handler returns non-0 the search stops.
+ *
+ * Return value: number of photos passed to @handler or <0 on failure
+ **/
+int
+flickcurl_photos_search_all(flickcurl* fc, flickcurl_search_params* params,
+                            const char* extras, int use_taken_dates,
+                            flickcurl_search_handler handler, void* user_data,
+                            int* truncated_count_p)
+{
+  flickcurl_search_params slice_params;
+  flickcurl_photos_list_params list_params;
+  flickcurl_search_slice* stack = NULL;
+  int stack_size = 0;
+  int stack_count = 0;
+  flickcurl_search_seen seen;
+  char* min_s = NULL;
+  char* max_s = NULL;
+  time_t min_date;
+  time_t max_date;
+  int count = 0;
+  int truncated = 0;
+  int stopped = 0;
+
+  memset(&seen, '\0', sizeof(seen));
+  memcpy(&slice_params, params, sizeof(slice_params));
+
+  if(use_taken_dates) {
+    min_date = params->min_taken_date ?
+      flickcurl_parse_datetime(params->min_taken_date) : 0;
+    max_date = params->max_taken_date ?
+      flickcurl_parse_datetime(params->max_taken_date) : time(NULL);
+    if(!slice_params.sort)
+      slice_params.sort = (char*)"date-taken-asc";
+  } else {
+    min_date = params->min_upload_date ? params->min_upload_date :
+      SEARCH_FIRST_UPLOAD_DATE;
+    max_date = params->max_upload_date ? params->max_upload_date : time(NULL);
+    if(!slice_params.sort)
+      slice_params.sort = (char*)"date-posted-asc";
+  }
+
+  if(min_date < 0 || max_date < 0) {
+    flickcurl_error(fc, "Cannot parse search taken date range");
+    return -1;
+  }
+
+  stack_size = 64;
+  stack = (flickcurl_search_slice*)malloc(stack_size * sizeof(*stack));
+  if(!stack)
+    return -1;
+  stack[0].min_date = min_date;
+  stack[0].max_date = max_date;
+  stack[0].estimate = -1;
+  stack_count = 1;
+
+  flickcurl_photos_list_params_init(&list_params);
+  list_params.extras = extras;
+
+  while(stack_count && count >= 0 && !stopped) {
+    flickcurl_search_slice slice = stack[--stack_count];
+    flickcurl_photos_list* photos_list;
+    int page;
+    int pages;
+
+    flickcurl_search_set_dates(&slice_params, use_taken_dates,
+                               slice.min_date, slice.max_date,
+                               &min_s, &max_s);
+
+    /* a slice expected to be well over the ceiling is only counted */
+    list_params.per_page = (slice.estimate > 2 * FLICKCURL_SEARCH_CEILING) ? 1 :
+                           SEARCH_PER_PAGE;
+    list_params.page = 1;
+
+    photos_list = flickcurl_photos_search_params(fc, &slice_params,
+                                                 &list_params);
+    if(!photos_list) {
+      count = -1;
+      break;
+    }
+
+    if(photos_list->total_count > FLICKCURL_SEARCH_CEILING &&
+       slice.max_date > slice.min_date) {
+      time_t mid = slice.min_date + (slice.max_date - slice.min_date) / 2;
+      int half = photos_list->total_count / 2;
+
+      flickcurl_free_photos_list(photos_list);
+
+      if(stack_count + 2 > stack_size) {
+        flickcurl_search_slice* new_stack;
+
+        new_stack = (flickcurl_search_slice*)realloc(stack,
+                                                     2 * stack_size * sizeof(*stack));
+        if(!new_stack) {
+          count = -1;
+          break;
+        }
+        stack = new_stack;
+        stack_size *= 2;
+      }
+
+      /* push the later half first so the earlier one is fetched next */
+      stack[stack_count].min_date = mid + 1;
+      stack[stack_count].max_date = slice.max_date;
+      stack[stack_count++].estimate = half;
+      stack[stack_count].min_date = slice.min_date;
+      stack[stack_count].max_date = mid;
+      stack[stack_count++].estimate = half;
+      continue;
+    }
+
+    if(photos_list->total_count > FLICKCURL_SEARCH_CEILING)
+      truncated += photos_list->total_count - FLICKCURL_SEARCH_CEILING;
+
+    if(photos_list->total_count && list_params.per_page != SEARCH_PER_PAGE) {
+      /* only counted with a one photo page; fetch it properly */
+      flickcurl_free_photos_list(photos_list);
+      list_params.per_page = SEARCH_PER_PAGE;
+      photos_list = flickcurl_photos_search_params(fc, &slice_params,
+                                                   &list_params);
+      if(!photos_list) {
+        count = -1;
+        break;
+      }
+    }
+
+    pages = (photos_list->total_count + SEARCH_PER_PAGE - 1) / SEARCH_PER_PAGE;
+    if(pages > FLICKCURL_SEARCH_CEILING / SEARCH_PER_PAGE)
+      pages = FLICKCURL_SEARCH_CEILING / SEARCH_PER_PAGE;
+
+    for(page = 1; ; page++) {
+      int i;
+
+      for(i = 0; i < photos_list->photos_count; i++) {
+        flickcurl_photo* photo = photos_list->photos[i];
+        long long id = flickcurl_photo_get_id_number(photo);
+        int rc = 0;
+
+        if(id)
+          rc = flickcurl_search_seen_add(&seen, id);
+        if(rc < 0) {
+          count = -1;
+          break;
+        }
+        if(rc)
+          continue;
+
+        if(handler(user_data, photo)) {
+          stopped = 1;
+          break;
+        }
+        count++;
+      }
+
+      flickcurl_free_photos_list(photos_list);
+
+      if(count < 0 || stopped || page >= pages)
+        break;
+
+      list_params.page = page + 1;
+      photos_list = flickcurl_photos_search_params(fc, &slice_params,
+                                                   &list_params);
+      if(!photos_list) {
+        count = -1;
+        break;
+      }
+    }
+  }
+
+  if(truncated_count_p)
+    *truncated_count_p = truncated;
+
+  if(stack)
+    free(stack);
+  if(seen.ids)
+    free(seen.ids);
+  if(min_s)
+    free(min_s);
+  if(max_s)
+    free(max_s);
+
+  return count;
+}
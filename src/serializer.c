@@ -363,9 +363,10 @@ flickcurl_serialize_photo(flickcurl_serializer* fcs, flickcurl_photo* photo)
   /* mark namespaces used in fields */
   for(i = PHOTO_FIELD_FIRST; i <= PHOTO_FIELD_LAST; i++) {
     flickcurl_photo_field_type field = (flickcurl_photo_field_type)i;
-    flickcurl_field_value_type datatype = photo->fields[field].type;
+    flickcurl_field_value_type datatype;
     int f;
 
+    datatype = flickcurl_photo_get_field(photo, field)->type;
     if(datatype == VALUE_TYPE_NONE)
       continue;
 
@@ -465,9 +466,10 @@ flickcurl_serialize_photo(flickcurl_serializer* fcs, flickcurl_photo* photo)
   /* generate triples from fields */
   for(i = PHOTO_FIELD_FIRST; i <= PHOTO_FIELD_LAST; i++) {
     flickcurl_photo_field_type field = (flickcurl_photo_field_type)i;
-    flickcurl_field_value_type datatype = photo->fields[field].type;
+    flickcurl_field_value_type datatype;
     int f;
 
+    datatype = flickcurl_photo_get_field(photo, field)->type;
     if(datatype == VALUE_TYPE_NONE)
       continue;
 
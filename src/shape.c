@@ -166,6 +166,27 @@ static struct {
 };
 
 
+/*
+ * flickcurl_shape_register_xpaths:
+ *
+ * INTERNAL - compile the shape field XPaths into the XPath registry
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_shape_register_xpaths(void)
+{
+  int i;
+
+  for(i = 0; shape_fields_table[i].xpath; i++) {
+    if(flickcurl_xpath_register(shape_fields_table[i].xpath))
+      return 1;
+  }
+
+  return 0;
+}
+
+
 
 /* get shapedata from value */
 flickcurl_shapedata**
@@ -177,9 +198,10 @@ flickcurl_build_shapes(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   int shape_count;
   xmlXPathObjectPtr xpathObj = NULL;
   xmlNodeSetPtr nodes;
+  xmlXPathContextPtr xpathNodeCtx = NULL;
   int i;
   
-  xpathObj = xmlXPathEvalExpression(xpathExpr, xpathCtx);
+  xpathObj = flickcurl_xpath_evaluate(xpathCtx, xpathExpr);
   if(!xpathObj) {
     flickcurl_error(fc, "Unable to evaluate XPath expression \"%s\"", 
                     xpathExpr);
@@ -192,10 +214,17 @@ flickcurl_build_shapes(flickcurl* fc, xmlXPathContextPtr xpathCtx,
   nodes_count = xmlXPathNodeSetGetLength(nodes);
   shapes = (flickcurl_shapedata**)calloc(sizeof(flickcurl_shapedata*), nodes_count+1);
 
+  /* one XPath context is moved to each node in turn */
+  xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
+  if(!xpathNodeCtx) {
+    flickcurl_error(fc, "Failed to create XPath context for document");
+    fc->failed = 1;
+    goto tidy;
+  }
+
   for(i = 0, shape_count = 0; i < nodes_count; i++) {
     xmlNodePtr node = nodes->nodeTab[i];
     int expri;
-    xmlXPathContextPtr xpathNodeCtx = NULL;
     flickcurl_shapedata* shape;
     
     if(node->type != XML_ELEMENT_NODE) {
@@ -206,8 +235,6 @@ flickcurl_build_shapes(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     
     shape = (flickcurl_shapedata*)calloc(sizeof(flickcurl_shapedata), 1);
 
-    /* set up a new XPath context relative to the current node */
-    xpathNodeCtx = xmlXPathNewContext(xpathCtx->doc);
     xpathNodeCtx->node = node;
 
     for(expri = 0; shape_fields_table[expri].xpath; expri++) {
@@ -301,8 +328,6 @@ flickcurl_build_shapes(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     } /* end for shape fields */
 
    shapestidy:
-    if(xpathNodeCtx)
-      xmlXPathFreeContext(xpathNodeCtx);
 
     shapes[shape_count++] = shape;
   } /* for shapes */
@@ -311,6 +336,8 @@ flickcurl_build_shapes(flickcurl* fc, xmlXPathContextPtr xpathCtx,
     *shape_count_p = shape_count;
   
  tidy:
+  if(xpathNodeCtx)
+    xmlXPathFreeContext(xpathNodeCtx);
   if(xpathObj)
     xmlXPathFreeObject(xpathObj);
   
@@ -139,6 +139,8 @@ flickcurl_stats_getCollectionDomains(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -229,6 +231,8 @@ flickcurl_stats_getCollectionReferrers(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -300,6 +304,8 @@ flickcurl_stats_getCollectionStats(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     count = -1;
 
@@ -384,6 +390,8 @@ flickcurl_stats_getPhotoDomains(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -472,6 +480,8 @@ flickcurl_stats_getPhotoReferrers(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -557,6 +567,8 @@ flickcurl_stats_getPhotosetDomains(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -647,6 +659,8 @@ flickcurl_stats_getPhotosetReferrers(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -719,6 +733,8 @@ flickcurl_stats_getPhotosetStats(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     count = -1;
 
@@ -794,6 +810,8 @@ flickcurl_stats_getPhotoStats(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stat1 = NULL;
 
@@ -874,6 +892,8 @@ flickcurl_stats_getPhotostreamDomains(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -958,6 +978,8 @@ flickcurl_stats_getPhotostreamReferrers(flickcurl* fc, const char* date,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     stats = NULL;
 
@@ -1026,6 +1048,8 @@ flickcurl_stats_getPhotostreamStats(flickcurl* fc, const char* date)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     count = -1;
 
@@ -1084,7 +1108,7 @@ flickcurl_stats_getPopularPhotos(flickcurl* fc, const char* date,
   }
 
   /* Photos List parameters */
-  flickcurl_append_photos_list_params(&list_params, parameters, &count, &format);
+  flickcurl_append_photos_list_params(fc, &list_params, parameters, &count, &format);
 
   parameters[count][0]  = NULL;
 
@@ -1205,6 +1229,8 @@ flickcurl_stats_getTotalViews(flickcurl* fc, const char* date)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     views = NULL;
 
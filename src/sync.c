@@ -0,0 +1,428 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * sync.c - Flickcurl incremental photo metadata sync
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/* Maximum page size allowed by flickr.photos.recentlyUpdated */
+#define SYNC_PER_PAGE 500
+
+/* Seconds of clock skew allowed between here and Flickr when moving
+ * the watermark up to the start of a run
+ */
+#define SYNC_CLOCK_SKEW 300
+
+
+static void
+flickcurl_sync_read_state_var(void* user_data, const char* key,
+                              const char* value)
+{
+  flickcurl_sync* sync = (flickcurl_sync*)user_data;
+  int ivalue = atoi(value);
+
+  if(!strcmp(key, "watermark"))
+    sync->watermark = ivalue;
+  else if(!strcmp(key, "run_min_date"))
+    sync->run_min_date = ivalue;
+  else if(!strcmp(key, "run_start"))
+    sync->run_start = ivalue;
+  else if(!strcmp(key, "run_max"))
+    sync->run_max = ivalue;
+  else if(!strcmp(key, "run_page"))
+    sync->run_page = ivalue;
+}
+
+
+/*
+ * flickcurl_sync_copy_other_sections:
+ * @sync: sync object
+ * @fh: file handle of the new state
+ *
+ * INTERNAL - copy the sections of other accounts from the old state file
+ *
+ * Several accounts may keep their state in one file, each in its own
+ * section, so only this account's section is replaced.
+ */
+static void
+flickcurl_sync_copy_other_sections(flickcurl_sync* sync, FILE* fh)
+{
+  FILE* old_fh;
+  char buf[256];
+  size_t account_len = strlen(sync->account);
+  int at_line_start = 1;
+  int skip = 0;
+  int lastch = '\n';
+
+  old_fh = fopen(sync->state_filename, "r");
+  if(!old_fh)
+    return;
+
+  while(fgets(buf, sizeof(buf), old_fh)) {
+    size_t len = strlen(buf);
+
+    if(at_line_start) {
+      char* line = buf;
+      size_t line_len;
+
+      while(*line == ' ' || *line == '\t')
+        line++;
+      line_len = strcspn(line, "\r\n");
+
+      /* a section header starts this account's section or another */
+      if(*line == '[' && line_len >= 2 && line[line_len - 1] == ']')
+        skip = (line_len - 2 == account_len &&
+                !strncmp(line + 1, sync->account, account_len));
+    }
+
+    if(!skip && len) {
+      fputs(buf, fh);
+      lastch = buf[len - 1];
+    }
+
+    at_line_start = (len && buf[len - 1] == '\n');
+  }
+
+  fclose(old_fh);
+
+  if(lastch != '\n')
+    fputc('\n', fh);
+}
+
+
+/*
+ * flickcurl_sync_write_state:
+ * @sync: sync object
+ *
+ * INTERNAL - persist the sync state so a crashed run can resume
+ *
+ * The state is written to a temporary file with the sections of any
+ * other accounts, synced to disk and then renamed over the old state
+ * so it is never seen half written.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_sync_write_state(flickcurl_sync* sync)
+{
+  char* tmp_filename;
+  size_t len = strlen(sync->state_filename);
+  FILE* fh;
+  int rc = 0;
+
+  tmp_filename = (char*)malloc(len + 5);
+  if(!tmp_filename)
+    return 1;
+  memcpy(tmp_filename, sync->state_filename, len);
+  memcpy(tmp_filename + len, ".tmp", 5);
+
+  fh = fopen(tmp_filename, "w");
+  if(!fh) {
+    flickcurl_error(sync->fc, "Failed to write sync state to %s - %s",
+                    tmp_filename, strerror(errno));
+    free(tmp_filename);
+    return 1;
+  }
+
+  flickcurl_sync_copy_other_sections(sync, fh);
+
+  fprintf(fh, "[%s]\n", sync->account);
+  fprintf(fh, "watermark=%d\n", sync->watermark);
+  if(sync->run_min_date) {
+    fprintf(fh, "run_min_date=%d\n", sync->run_min_date);
+    fprintf(fh, "run_start=%d\n", sync->run_start);
+    fprintf(fh, "run_max=%d\n", sync->run_max);
+    fprintf(fh, "run_page=%d\n", sync->run_page);
+  }
+
+  if(fflush(fh) || ferror(fh))
+    rc = 1;
+#ifdef HAVE_FSYNC
+  if(!rc && fsync(fileno(fh)))
+    rc = 1;
+#endif
+  if(fclose(fh))
+    rc = 1;
+
+  if(!rc && rename(tmp_filename, sync->state_filename))
+    rc = 1;
+
+  if(rc)
+    flickcurl_error(sync->fc, "Failed to write sync state to %s - %s",
+                    sync->state_filename, strerror(errno));
+
+  free(tmp_filename);
+  return rc;
+}
+
+
+/**
+ * flickcurl_new_sync:
+ * @fc: flickcurl context authenticated as the account to sync
+ * @account: account name used to label the saved state
+ * @state_filename: file to persist the sync state in
+ *
+ * Create an incremental photo metadata sync for one account.
+ *
+ * Any state from a previous sync of @account saved in
+ * @state_filename is loaded, including a run that did not complete.
+ * Several accounts may share one state file as each is kept in its
+ * own section, but syncs sharing a file must not run at the same time.
+ *
+ * Return value: new sync object or NULL on failure
+ **/
+flickcurl_sync*
+flickcurl_new_sync(flickcurl* fc, const char* account,
+                   const char* state_filename)
+{
+  flickcurl_sync* sync;
+
+  if(!account || !state_filename)
+    return NULL;
+
+  sync = (flickcurl_sync*)calloc(1, sizeof(*sync));
+  if(!sync)
+    return NULL;
+
+  sync->fc = fc;
+  sync->account = strdup(account);
+  sync->state_filename = strdup(state_filename);
+  if(!sync->account || !sync->state_filename) {
+    flickcurl_free_sync(sync);
+    return NULL;
+  }
+
+  /* a missing state file means a first, full, sync */
+  read_ini_config(state_filename, account, sync,
+                  flickcurl_sync_read_state_var);
+
+  return sync;
+}
+
+
+/**
+ * flickcurl_free_sync:
+ * @sync: sync object
+ *
+ * Destructor for sync object
+ */
+void
+flickcurl_free_sync(flickcurl_sync* sync)
+{
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(sync, flickcurl_sync);
+
+  if(sync->account)
+    free(sync->account);
+  if(sync->state_filename)
+    free(sync->state_filename);
+  free(sync);
+}
+
+
+/**
+ * flickcurl_sync_run:
+ * @sync: sync object
+ * @extras: extra fields to fetch in addition to <code>last_update</code> (or NULL)
+ * @handler: function to apply each updated photo to the local store
+ * @user_data: user data for @handler
+ *
+ * Fetch and apply all photo changes since the last sync.
+ *
+ * Pages through flickcurl_photos_recentlyUpdated_params() from the
+ * saved watermark, calling @handler for every photo created or
+ * modified since then.  The state is saved after every page is
+ * applied, so a run that is interrupted resumes at the next page and
+ * the cost of a sync is proportional to the number of changes.
+ *
+ * A page may be applied more than once after a crash so @handler
+ * must be idempotent.  The photo passed to @handler is owned by the
+ * sync and must not be freed.  If @handler returns non-0 the run
+ * stops with the state saved up to the previous page.
+ *
+ * Deleted photos are not reported by the web service.
+ *
+ * A photo field mask set on the session with
+ * flickcurl_set_photo_fields() applies to the photos passed to
+ * @handler except that #PHOTO_FIELD_dates_lastupdate is always built
+ * during the run, since the watermark is taken from it.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_sync_run(flickcurl_sync* sync, const char* extras,
+                   flickcurl_sync_handler handler, void* user_data)
+{
+  flickcurl* fc = sync->fc;
+  flickcurl_photos_list_params list_params;
+  char* sync_extras;
+  size_t extras_len = extras ? strlen(extras) : 0;
+  char lastupdate_wanted;
+  int rc = 0;
+
+  sync_extras = (char*)malloc(12 + extras_len + 1);
+  if(!sync_extras)
+    return 1;
+  memcpy(sync_extras, "last_update", 12);
+  if(extras_len) {
+    sync_extras[11] = ',';
+    memcpy(sync_extras + 12, extras, extras_len + 1);
+  }
+
+  /* the watermark needs the last update time whatever the session
+   * photo field mask says
+   */
+  lastupdate_wanted = fc->photo_fields_mask[PHOTO_FIELD_dates_lastupdate];
+  fc->photo_fields_mask[PHOTO_FIELD_dates_lastupdate] = 1;
+
+  sync->updated_count = 0;
+
+  if(!sync->run_min_date) {
+    /* start a new run; min_date must be > 0 so a first sync uses 1 */
+    sync->run_min_date = sync->watermark > 0 ? sync->watermark : 1;
+    sync->run_start = (int)time(NULL);
+    sync->run_max = sync->watermark;
+    sync->run_page = 1;
+    if(flickcurl_sync_write_state(sync)) {
+      rc = 1;
+      goto tidy;
+    }
+  }
+
+  flickcurl_photos_list_params_init(&list_params);
+  list_params.extras = sync_extras;
+  list_params.per_page = SYNC_PER_PAGE;
+
+  while(1) {
+    flickcurl_photos_list* photos_list;
+    int i;
+
+    list_params.page = sync->run_page;
+    photos_list = flickcurl_photos_recentlyUpdated_params(fc,
+                                                          sync->run_min_date,
+                                                          &list_params);
+    if(!photos_list) {
+      rc = 1;
+      goto tidy;
+    }
+
+    for(i = 0; i < photos_list->photos_count; i++) {
+      flickcurl_photo* photo = photos_list->photos[i];
+      int last_update;
+
+      last_update = flickcurl_photo_get_field(photo,
+                                              PHOTO_FIELD_dates_lastupdate)->integer;
+
+      if(handler(user_data, photo)) {
+        flickcurl_free_photos_list(photos_list);
+        rc = 1;
+        goto tidy;
+      }
+
+      if(last_update > sync->run_max)
+        sync->run_max = last_update;
+      sync->updated_count++;
+    }
+
+    flickcurl_free_photos_list(photos_list);
+
+    if(i < SYNC_PER_PAGE)
+      break;
+
+    sync->run_page++;
+    if(flickcurl_sync_write_state(sync)) {
+      rc = 1;
+      goto tidy;
+    }
+  }
+
+  /* Run is complete.  Updates made while it was paging may have moved
+   * between pages so do not move the watermark past the run start.
+   */
+  if(sync->run_max > sync->run_start - SYNC_CLOCK_SKEW)
+    sync->run_max = sync->run_start - SYNC_CLOCK_SKEW;
+  if(sync->run_max > sync->watermark)
+    sync->watermark = sync->run_max;
+
+  sync->run_min_date = 0;
+  sync->run_start = 0;
+  sync->run_max = 0;
+  sync->run_page = 0;
+  rc = flickcurl_sync_write_state(sync);
+
+  tidy:
+  fc->photo_fields_mask[PHOTO_FIELD_dates_lastupdate] = lastupdate_wanted;
+  free(sync_extras);
+
+  return rc;
+}
+
+
+/**
+ * flickcurl_sync_get_watermark:
+ * @sync: sync object
+ *
+ * Get the last update time up to which all changes have been applied
+ *
+ * Return value: unix time of the watermark or 0 if never synced
+ **/
+int
+flickcurl_sync_get_watermark(flickcurl_sync* sync)
+{
+  return sync->watermark;
+}
+
+
+/**
+ * flickcurl_sync_get_updated_count:
+ * @sync: sync object
+ *
+ * Get the number of photos applied by the last flickcurl_sync_run()
+ *
+ * Return value: number of photos
+ **/
+int
+flickcurl_sync_get_updated_count(flickcurl_sync* sync)
+{
+  return sync->updated_count;
+}
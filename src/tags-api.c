@@ -153,6 +153,8 @@ flickcurl_tags_getClusters(flickcurl* fc, const char* tag)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     clusters = NULL;
 
@@ -223,6 +225,8 @@ flickcurl_tags_getHotList(flickcurl* fc, const char* period, int tag_count)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
@@ -278,6 +282,8 @@ flickcurl_tags_getListPhoto(flickcurl* fc, const char* photo_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
@@ -337,6 +343,8 @@ flickcurl_tags_getListUser(flickcurl* fc, const char* user_id)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
@@ -402,6 +410,8 @@ flickcurl_tags_getListUserPopular(flickcurl* fc, const char* user_id,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
@@ -459,6 +469,8 @@ flickcurl_tags_getListUserRaw(flickcurl* fc, const char* tag)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
@@ -517,6 +529,8 @@ flickcurl_tags_getRelated(flickcurl* fc, const char* tag)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     tags = NULL;
 
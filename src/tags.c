@@ -47,14 +47,11 @@ flickcurl_free_tag(flickcurl_tag *t)
 
   if(t->id)
     free(t->id);
-  if(t->author)
-    free(t->author);
-  if(t->authorname)
-    free(t->authorname);
-  if(t->raw)
-    free(t->raw);
-  if(t->cooked)
-    free(t->cooked);
+  flickcurl_intern_release(t->intern, t->author);
+  flickcurl_intern_release(t->intern, t->authorname);
+  flickcurl_intern_release(t->intern, t->raw);
+  flickcurl_intern_release(t->intern, t->cooked);
+  flickcurl_intern_table_release(t->intern);
   free(t);
 }
 
@@ -111,13 +108,13 @@ flickcurl_build_tags(flickcurl* fc, flickcurl_photo* photo,
       if(!strcmp(attr_name, "id"))
         t->id = attr_value;
       else if(!strcmp(attr_name, "author"))
-        t->author = attr_value;
+        t->author = flickcurl_intern_string(fc, attr_value, &t->intern);
       else if(!strcmp(attr_name, "authorname"))
-        t->authorname = attr_value;
+        t->authorname = flickcurl_intern_string(fc, attr_value, &t->intern);
       else if(!strcmp(attr_name, "raw"))
-        t->raw = attr_value;
+        t->raw = flickcurl_intern_string(fc, attr_value, &t->intern);
       else if(!strcmp(attr_name, "clean")) {
-        t->cooked = attr_value;
+        t->cooked = flickcurl_intern_string(fc, attr_value, &t->intern);
         /* If we see @clean we are expecting
          * <tag clean = "cooked"><raw>raw</raw></tag>
          */
@@ -142,11 +139,13 @@ flickcurl_build_tags(flickcurl* fc, flickcurl_photo* photo,
         if(saw_clean && !strcmp(chnode_name, "raw")) {
           t->raw = (char*)malloc(strlen((const char*)chnode->children->content)+1);
           strcpy(t->raw, (const char*)chnode->children->content);
+          t->raw = flickcurl_intern_string(fc, t->raw, &t->intern);
         }
       } else if(chnode->type == XML_TEXT_NODE) {
         if(!saw_clean) {
           t->cooked = (char*)malloc(strlen((const char*)chnode->content)+1);
           strcpy(t->cooked, (const char*)chnode->content);
+          t->cooked = flickcurl_intern_string(fc, t->cooked, &t->intern);
         }
       }
     }
@@ -175,7 +174,8 @@ flickcurl_build_tags(flickcurl* fc, flickcurl_photo* photo,
 
 flickcurl_tag**
 flickcurl_build_tags_from_string(flickcurl* fc, flickcurl_photo* photo,
-                                 const char *string, int *tag_count_p)
+                                 const char *string, int machine_tag,
+                                 int *tag_count_p)
 {
   flickcurl_tag** tags = NULL;
   int nodes_count;
@@ -184,7 +184,7 @@ flickcurl_build_tags_from_string(flickcurl* fc, flickcurl_photo* photo,
   
   nodes_count = 0;
   for(i = 0; string[i]; i++) {
-    if(string[i] == ' ')
+    if(string[i] != ' ' && (!i || string[i - 1] == ' '))
       nodes_count++;
   }
   
@@ -192,12 +192,17 @@ flickcurl_build_tags_from_string(flickcurl* fc, flickcurl_photo* photo,
   
   for(i = 0, tag_count = 0; i < nodes_count; i++) {
     flickcurl_tag* t;
-    const char *p = string;
+    const char *p;
     size_t len;
     
+    while(*string == ' ')
+      string++;
+
     t = (flickcurl_tag*)calloc(sizeof(flickcurl_tag), 1);
     t->photo = photo;
+    t->machine_tag = machine_tag;
 
+    p = string;
     while(*p && *p != ' ')
       p++;
     
@@ -206,14 +211,14 @@ flickcurl_build_tags_from_string(flickcurl* fc, flickcurl_photo* photo,
     t->cooked = (char*)malloc(len+1);
     strncpy(t->cooked, string, len);
     t->cooked[len] = '\0';
+    t->cooked = flickcurl_intern_string(fc, t->cooked, &t->intern);
     
     if(fc->tag_handler)
       fc->tag_handler(fc->tag_data, t);
     
     tags[tag_count++] = t;
 
-    /* move past space */
-    string = p+1;
+    string = p;
   }
 
   if(tag_count_p)
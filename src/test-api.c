@@ -83,6 +83,7 @@ flickcurl_test_echo(flickcurl* fc, const char* key, const char* value)
   fprintf(stderr, "Flickr echo returned %d bytes\n", fc->total_bytes);
   
   tidy:
+  flickcurl_timing_end_build(fc);
   
   return rc;
 }
@@ -131,6 +132,8 @@ flickcurl_test_login(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     username = NULL;
 
@@ -177,6 +180,8 @@ flickcurl_test_null(flickcurl* fc)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   return fc->failed;
 }
 
@@ -0,0 +1,209 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * timing.c - Flickcurl request phase timing
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#include <sys/time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * flickcurl_timing_elapsed:
+ * @start: start time
+ *
+ * INTERNAL - get the time since @start
+ *
+ * Return value: elapsed time in usec
+ */
+long
+flickcurl_timing_elapsed(struct timeval* start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) * 1000000L +
+         (now.tv_usec - start->tv_usec);
+}
+
+
+static long
+flickcurl_timing_get_curl_usec(CURL* handle, CURLINFO info)
+{
+  double seconds = 0.0;
+
+  if(curl_easy_getinfo(handle, info, &seconds) != CURLE_OK)
+    return 0;
+
+  return (long)(seconds * 1000000.0);
+}
+
+
+/*
+ * flickcurl_timing_set_transfer:
+ * @fc: flickcurl context after a request was performed
+ * @handle: curl handle of the request
+ *
+ * INTERNAL - set the network phases of the request timing from curl
+ *
+ * Each phase is the time since the end of the previous one so that
+ * the phases add up to the curl total time.
+ */
+void
+flickcurl_timing_set_transfer(flickcurl* fc, CURL* handle)
+{
+  flickcurl_request_timing* timing = &fc->timing;
+  long dns;
+  long connect;
+  long tls = 0;
+  long start_transfer;
+  long total;
+
+  dns = flickcurl_timing_get_curl_usec(handle, CURLINFO_NAMELOOKUP_TIME);
+  connect = flickcurl_timing_get_curl_usec(handle, CURLINFO_CONNECT_TIME);
+#if LIBCURL_VERSION_NUM >= 0x071300
+  tls = flickcurl_timing_get_curl_usec(handle, CURLINFO_APPCONNECT_TIME);
+#endif
+  start_transfer = flickcurl_timing_get_curl_usec(handle,
+                                                  CURLINFO_STARTTRANSFER_TIME);
+  total = flickcurl_timing_get_curl_usec(handle, CURLINFO_TOTAL_TIME);
+
+  /* reused connections report 0 for the phases they skipped */
+  if(connect < dns)
+    connect = dns;
+  if(tls < connect)
+    tls = connect;
+  if(start_transfer < tls)
+    start_transfer = tls;
+  if(total < start_transfer)
+    total = start_transfer;
+
+  timing->dns_usec = dns;
+  timing->connect_usec = connect - dns;
+  timing->tls_usec = tls - connect;
+  timing->ttfb_usec = start_transfer - tls;
+  timing->transfer_usec = total - start_transfer;
+}
+
+
+/*
+ * flickcurl_timing_end_build:
+ * @fc: flickcurl context
+ *
+ * INTERNAL - end the build phase of the last request timing
+ *
+ * Called by each API call once the result of its request has been
+ * turned into objects.  The timing handler is called here.
+ */
+void
+flickcurl_timing_end_build(flickcurl* fc)
+{
+  if(!fc->timing_pending)
+    return;
+
+  fc->timing_pending = 0;
+  fc->timing.build_usec = flickcurl_timing_elapsed(&fc->timing_build_start);
+  fc->timing.total_usec += fc->timing.build_usec;
+
+  if(fc->timing_handler)
+    fc->timing_handler(fc->timing_handler_data, &fc->timing);
+}
+
+
+/*
+ * flickcurl_timing_flush:
+ * @fc: flickcurl context
+ *
+ * INTERNAL - report a request timing whose build phase was never ended
+ *
+ * Called when the timing is read, the next request is prepared or
+ * @fc is freed.  Only a request made by code that does not call
+ * flickcurl_timing_end_build() gets here with the build phase
+ * running; the time since is not known to be building so the build
+ * is reported as -1.
+ */
+void
+flickcurl_timing_flush(flickcurl* fc)
+{
+  if(!fc->timing_pending)
+    return;
+
+  fc->timing_pending = 0;
+  fc->timing.build_usec = -1;
+
+  if(fc->timing_handler)
+    fc->timing_handler(fc->timing_handler_data, &fc->timing);
+}
+
+
+/**
+ * flickcurl_get_request_timing:
+ * @fc: flickcurl object
+ *
+ * Get the phase timing of the last web service request
+ *
+ * The record is owned by @fc and is overwritten by the next request.
+ * All values are in microseconds; see #flickcurl_request_timing.
+ *
+ * Return value: timing of the last request
+ **/
+const flickcurl_request_timing*
+flickcurl_get_request_timing(flickcurl* fc)
+{
+  flickcurl_timing_flush(fc);
+
+  return &fc->timing;
+}
+
+
+/**
+ * flickcurl_set_timing_handler:
+ * @fc: flickcurl object
+ * @timing_handler: timing handler function (or NULL)
+ * @timing_data: timing handler data
+ *
+ * Set the function called with the phase timing of each request
+ *
+ * The handler is called when an API call has decoded the response of
+ * its request, before the call returns.
+ */
+void
+flickcurl_set_timing_handler(flickcurl* fc,
+                             flickcurl_timing_handler timing_handler,
+                             void *timing_data)
+{
+  fc->timing_handler = timing_handler;
+  fc->timing_handler_data = timing_data;
+}
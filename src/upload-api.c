@@ -153,6 +153,8 @@ flickcurl_photos_upload_params(flickcurl* fc, flickcurl_upload_params* params)
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     status = NULL;
 
@@ -279,6 +281,8 @@ flickcurl_photos_replace(flickcurl* fc, const char* photo_file,
   if(xpathCtx)
     xmlXPathFreeContext(xpathCtx);
 
+  flickcurl_timing_end_build(fc);
+
   if(fc->failed)
     status = NULL;
 
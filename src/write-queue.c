@@ -0,0 +1,1024 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * write-queue.c - Flickcurl journaled write-behind queue of API calls
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <time.h>
+#include <sys/time.h>
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * The journal is a text file of lines appended as the queue changes:
+ *   + SEQ METHOD NAME=VALUE&NAME=VALUE...
+ *   - SEQ
+ * adding a call and removing it once it succeeded or was abandoned.
+ * Names and values are %-escaped.  A final line without a newline was
+ * torn by a crash and is ignored.  The journal is rewritten with just
+ * the pending calls when the queue is opened.
+ */
+
+/* Default number of attempts before a retryable call is abandoned */
+#define WRITE_QUEUE_MAX_ATTEMPTS 10
+
+/* Retry backoff in seconds: doubles from the first up to the last */
+#define WRITE_QUEUE_RETRY_MIN 2
+#define WRITE_QUEUE_RETRY_MAX 3600
+
+/* Flickr error codes for temporary failures: service currently
+ * unavailable and write operation failed
+ */
+#define FLICKR_ERROR_SERVICE_UNAVAILABLE 105
+#define FLICKR_ERROR_WRITE_FAILED 106
+
+
+static void
+flickcurl_write_queue_free_entry(flickcurl_write_queue_entry* entry)
+{
+  int i;
+
+  for(i = 0; i < entry->count; i++) {
+    free(entry->parameters[i][0]);
+    free(entry->parameters[i][1]);
+  }
+  if(entry->parameters)
+    free(entry->parameters);
+  if(entry->method)
+    free(entry->method);
+  free(entry);
+}
+
+
+static void
+flickcurl_write_queue_escape(FILE* fh, const char* string)
+{
+  const unsigned char* p;
+
+  for(p = (const unsigned char*)string; *p; p++) {
+    if(*p <= ' ' || *p == '%' || *p == '&' || *p == '=' || *p == 0x7f)
+      fprintf(fh, "%%%02X", *p);
+    else
+      fputc(*p, fh);
+  }
+}
+
+
+/* unescape @len bytes of @string into a new string */
+static char*
+flickcurl_write_queue_unescape(const char* string, size_t len)
+{
+  char* result = (char*)malloc(len + 1);
+  char* p = result;
+  size_t i;
+
+  if(!result)
+    return NULL;
+
+  for(i = 0; i < len; i++) {
+    if(string[i] == '%' && i + 2 < len) {
+      char hex[3];
+
+      hex[0] = string[i + 1];
+      hex[1] = string[i + 2];
+      hex[2] = '\0';
+      *p++ = (char)strtol(hex, NULL, 16);
+      i += 2;
+    } else
+      *p++ = string[i];
+  }
+  *p = '\0';
+
+  return result;
+}
+
+
+static void
+flickcurl_write_queue_write_entry(FILE* fh, flickcurl_write_queue_entry* entry)
+{
+  int i;
+
+  fprintf(fh, "+ %d %s ", entry->seq, entry->method);
+  for(i = 0; i < entry->count; i++) {
+    if(i)
+      fputc('&', fh);
+    flickcurl_write_queue_escape(fh, entry->parameters[i][0]);
+    fputc('=', fh);
+    flickcurl_write_queue_escape(fh, entry->parameters[i][1]);
+  }
+  fputc('\n', fh);
+}
+
+
+/*
+ * flickcurl_write_queue_sync:
+ * @queue: write queue
+ *
+ * INTERNAL - make journal appends durable
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_write_queue_sync(flickcurl_write_queue* queue)
+{
+  int rc = 0;
+
+  if(fflush(queue->journal) || ferror(queue->journal))
+    rc = 1;
+#ifdef HAVE_FSYNC
+  if(!rc && fsync(fileno(queue->journal)))
+    rc = 1;
+#endif
+
+  if(rc) {
+    flickcurl_error(queue->fc, "Failed to write write queue journal %s - %s",
+                    queue->journal_filename, strerror(errno));
+    queue->fc->failed = 1;
+  }
+
+  return rc;
+}
+
+
+/*
+ * flickcurl_write_queue_parse_entry:
+ * @line: journal line after the "+ "
+ *
+ * INTERNAL - parse a journaled call
+ *
+ * Return value: new entry or NULL if the line is malformed
+ */
+static flickcurl_write_queue_entry*
+flickcurl_write_queue_parse_entry(const char* line)
+{
+  flickcurl_write_queue_entry* entry;
+  const char* method;
+  const char* p;
+  int size;
+
+  entry = (flickcurl_write_queue_entry*)calloc(1, sizeof(*entry));
+  if(!entry)
+    return NULL;
+
+  entry->seq = atoi(line);
+  method = strchr(line, ' ');
+  if(!method)
+    goto failed;
+  method++;
+  p = strchr(method, ' ');
+  if(!p || p == method)
+    goto failed;
+  entry->method = flickcurl_write_queue_unescape(method, p - method);
+  if(!entry->method)
+    goto failed;
+  p++;
+
+  for(size = 1, method = p; *method; method++) {
+    if(*method == '&')
+      size++;
+  }
+  entry->parameters = (char*(*)[2])calloc(size, sizeof(char*[2]));
+  if(!entry->parameters)
+    goto failed;
+
+  while(*p) {
+    const char* eq = strchr(p, '=');
+    const char* end = strchr(p, '&');
+
+    if(!end)
+      end = p + strlen(p);
+    if(!eq || eq > end)
+      goto failed;
+
+    entry->parameters[entry->count][0] = flickcurl_write_queue_unescape(p, eq - p);
+    entry->parameters[entry->count][1] = flickcurl_write_queue_unescape(eq + 1, end - eq - 1);
+    entry->count++;
+    if(!entry->parameters[entry->count - 1][0] ||
+       !entry->parameters[entry->count - 1][1])
+      goto failed;
+
+    p = *end ? end + 1 : end;
+  }
+
+  return entry;
+
+  failed:
+  flickcurl_write_queue_free_entry(entry);
+  return NULL;
+}
+
+
+static void
+flickcurl_write_queue_append(flickcurl_write_queue* queue,
+                             flickcurl_write_queue_entry* entry)
+{
+  if(queue->tail)
+    queue->tail->next = entry;
+  else
+    queue->head = entry;
+  queue->tail = entry;
+  queue->depth++;
+}
+
+
+/*
+ * flickcurl_write_queue_replay:
+ * @queue: write queue
+ *
+ * INTERNAL - load the pending calls from an existing journal
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_write_queue_replay(flickcurl_write_queue* queue)
+{
+  FILE* fh;
+  char* line = NULL;
+  size_t line_size = 0;
+  size_t len;
+  int rc = 0;
+
+  fh = fopen(queue->journal_filename, "r");
+  if(!fh)
+    return 0;
+
+  while(1) {
+    int c = EOF;
+
+    /* read a whole line of any length */
+    len = 0;
+    while(1) {
+      if(len + 1 >= line_size) {
+        size_t new_size = line_size ? line_size << 1 : 256;
+        char* new_line = (char*)realloc(line, new_size);
+
+        if(!new_line) {
+          rc = 1;
+          goto tidy;
+        }
+        line = new_line;
+        line_size = new_size;
+      }
+      c = fgetc(fh);
+      if(c == EOF || c == '\n')
+        break;
+      line[len++] = (char)c;
+    }
+    line[len] = '\0';
+
+    /* a torn final line was never acknowledged to the caller */
+    if(c == EOF)
+      break;
+
+    if(len > 2 && line[0] == '+' && line[1] == ' ') {
+      flickcurl_write_queue_entry* entry;
+
+      entry = flickcurl_write_queue_parse_entry(line + 2);
+      if(!entry) {
+        flickcurl_error(queue->fc, "Ignoring bad write queue journal line in %s",
+                        queue->journal_filename);
+        continue;
+      }
+      flickcurl_write_queue_append(queue, entry);
+      if(entry->seq >= queue->next_seq)
+        queue->next_seq = entry->seq + 1;
+    } else if(len > 2 && line[0] == '-' && line[1] == ' ') {
+      int seq = atoi(line + 2);
+      flickcurl_write_queue_entry* entry;
+      flickcurl_write_queue_entry* prev = NULL;
+
+      for(entry = queue->head; entry; prev = entry, entry = entry->next) {
+        if(entry->seq != seq)
+          continue;
+        if(prev)
+          prev->next = entry->next;
+        else
+          queue->head = entry->next;
+        if(queue->tail == entry)
+          queue->tail = prev;
+        queue->depth--;
+        flickcurl_write_queue_free_entry(entry);
+        break;
+      }
+    }
+  }
+
+  tidy:
+  if(line)
+    free(line);
+  fclose(fh);
+
+  return rc;
+}
+
+
+/*
+ * flickcurl_write_queue_compact:
+ * @queue: write queue
+ *
+ * INTERNAL - rewrite the journal with only the pending calls and open
+ * it for appending
+ *
+ * The new journal is written to a temporary file that is renamed
+ * over the old one so a crash leaves one or the other.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_write_queue_compact(flickcurl_write_queue* queue)
+{
+  flickcurl_write_queue_entry* entry;
+  char* tmp_filename;
+  size_t len = strlen(queue->journal_filename);
+  FILE* fh;
+  int rc = 0;
+
+  if(queue->journal) {
+    fclose(queue->journal);
+    queue->journal = NULL;
+  }
+
+  tmp_filename = (char*)malloc(len + 5);
+  if(!tmp_filename)
+    return 1;
+  memcpy(tmp_filename, queue->journal_filename, len);
+  memcpy(tmp_filename + len, ".tmp", 5);
+
+  fh = fopen(tmp_filename, "w");
+  if(!fh) {
+    rc = 1;
+    goto tidy;
+  }
+
+  for(entry = queue->head; entry; entry = entry->next)
+    flickcurl_write_queue_write_entry(fh, entry);
+
+  if(fflush(fh) || ferror(fh))
+    rc = 1;
+#ifdef HAVE_FSYNC
+  if(!rc && fsync(fileno(fh)))
+    rc = 1;
+#endif
+  if(fclose(fh))
+    rc = 1;
+
+  if(!rc && rename(tmp_filename, queue->journal_filename))
+    rc = 1;
+
+  if(!rc) {
+    queue->journal = fopen(queue->journal_filename, "a");
+    if(!queue->journal)
+      rc = 1;
+  }
+
+  tidy:
+  if(rc)
+    flickcurl_error(queue->fc, "Failed to write write queue journal %s - %s",
+                    queue->journal_filename, strerror(errno));
+
+  free(tmp_filename);
+  return rc;
+}
+
+
+/**
+ * flickcurl_new_write_queue:
+ * @fc: flickcurl context used to send the calls
+ * @journal_filename: file to journal queued calls in
+ *
+ * Create a durable write-behind queue of mutating API calls.
+ *
+ * Calls are accepted immediately by flickcurl_write_queue_add() or
+ * the wrappers such as flickcurl_write_queue_photos_setTags() and
+ * journaled to @journal_filename before returning.  They are sent
+ * later by flickcurl_write_queue_drain() which is paced by the
+ * request delay of @fc.  Calls still pending in an existing journal
+ * are loaded so they survive a restart.
+ *
+ * Return value: new write queue or NULL on failure
+ **/
+flickcurl_write_queue*
+flickcurl_new_write_queue(flickcurl* fc, const char* journal_filename)
+{
+  flickcurl_write_queue* queue;
+  size_t len;
+
+  if(!journal_filename)
+    return NULL;
+
+  queue = (flickcurl_write_queue*)calloc(1, sizeof(*queue));
+  if(!queue)
+    return NULL;
+
+  queue->fc = fc;
+  queue->max_attempts = WRITE_QUEUE_MAX_ATTEMPTS;
+  queue->next_seq = 1;
+
+  len = strlen(journal_filename);
+  queue->journal_filename = (char*)malloc(len + 1);
+  if(!queue->journal_filename)
+    goto failed;
+  memcpy(queue->journal_filename, journal_filename, len + 1);
+
+  if(flickcurl_write_queue_replay(queue))
+    goto failed;
+
+  if(flickcurl_write_queue_compact(queue))
+    goto failed;
+
+  return queue;
+
+  failed:
+  flickcurl_free_write_queue(queue);
+  return NULL;
+}
+
+
+/**
+ * flickcurl_free_write_queue:
+ * @queue: write queue
+ *
+ * Destructor for write queue
+ *
+ * Pending calls stay in the journal for the next queue opened on it.
+ */
+void
+flickcurl_free_write_queue(flickcurl_write_queue* queue)
+{
+  FLICKCURL_ASSERT_OBJECT_POINTER_RETURN(queue, flickcurl_write_queue);
+
+  while(queue->head) {
+    flickcurl_write_queue_entry* next = queue->head->next;
+
+    flickcurl_write_queue_free_entry(queue->head);
+    queue->head = next;
+  }
+
+  if(queue->journal)
+    fclose(queue->journal);
+  if(queue->journal_filename)
+    free(queue->journal_filename);
+
+  free(queue);
+}
+
+
+/**
+ * flickcurl_write_queue_set_max_attempts:
+ * @queue: write queue
+ * @max_attempts: attempts before a call failing temporarily is abandoned
+ *
+ * Set the number of attempts made for calls that keep failing with
+ * temporary errors (default 10).
+ */
+void
+flickcurl_write_queue_set_max_attempts(flickcurl_write_queue* queue,
+                                       int max_attempts)
+{
+  if(max_attempts > 0)
+    queue->max_attempts = max_attempts;
+}
+
+
+/**
+ * flickcurl_write_queue_add:
+ * @queue: write queue
+ * @method: Flickr API method name such as "flickr.photos.setTags"
+ * @parameters: method parameter name/value pairs
+ * @count: number of parameters
+ *
+ * Queue a mutating (POST) API call
+ *
+ * The call is journaled before this returns.  Calls with the same
+ * method and first parameter value (usually the photo ID) are sent
+ * in the order they were queued.
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_write_queue_add(flickcurl_write_queue* queue, const char* method,
+                          const char* parameters[][2], int count)
+{
+  flickcurl_write_queue_entry* entry;
+  int i;
+
+  if(!method || !queue->journal)
+    return 1;
+
+  entry = (flickcurl_write_queue_entry*)calloc(1, sizeof(*entry));
+  if(!entry)
+    return 1;
+
+  entry->method = (char*)malloc(strlen(method) + 1);
+  if(!entry->method)
+    goto failed;
+  strcpy(entry->method, method);
+
+  if(count) {
+    entry->parameters = (char*(*)[2])calloc(count, sizeof(char*[2]));
+    if(!entry->parameters)
+      goto failed;
+  }
+  for(i = 0; i < count; i++) {
+    entry->parameters[i][0] = (char*)malloc(strlen(parameters[i][0]) + 1);
+    entry->parameters[i][1] = (char*)malloc(strlen(parameters[i][1]) + 1);
+    entry->count++;
+    if(!entry->parameters[i][0] || !entry->parameters[i][1])
+      goto failed;
+    strcpy(entry->parameters[i][0], parameters[i][0]);
+    strcpy(entry->parameters[i][1], parameters[i][1]);
+  }
+
+  entry->seq = queue->next_seq++;
+
+  flickcurl_write_queue_write_entry(queue->journal, entry);
+  if(flickcurl_write_queue_sync(queue))
+    goto failed;
+
+  /* stay behind an earlier call for the same key that is backing off */
+  if(count) {
+    flickcurl_write_queue_entry* e;
+
+    for(e = queue->head; e; e = e->next) {
+      if(e->count && !strcmp(e->method, method) &&
+         !strcmp(e->parameters[0][1], parameters[0][1]) &&
+         e->next_attempt > entry->next_attempt)
+        entry->next_attempt = e->next_attempt;
+    }
+  }
+
+  flickcurl_write_queue_append(queue, entry);
+
+  return 0;
+
+  failed:
+  flickcurl_write_queue_free_entry(entry);
+  return 1;
+}
+
+
+/*
+ * flickcurl_write_queue_is_retryable:
+ * @fc: flickcurl context after a failed call
+ *
+ * INTERNAL - classify a failed call
+ *
+ * Transport failures, HTTP 429 and 5xx and the Flickr temporary
+ * errors are retried; other Flickr errors such as bad parameters or
+ * permissions never succeed.
+ *
+ * Return value: non-0 if the call should be retried
+ */
+static int
+flickcurl_write_queue_is_retryable(flickcurl* fc)
+{
+  if(fc->status_code == 429 || fc->status_code >= 500)
+    return 1;
+
+  if(fc->error_code == FLICKR_ERROR_SERVICE_UNAVAILABLE ||
+     fc->error_code == FLICKR_ERROR_WRITE_FAILED)
+    return 1;
+
+  if(fc->error_code)
+    return 0;
+
+  if(fc->status_code >= 400)
+    return 0;
+
+  /* no HTTP response or a response that could not be read */
+  return 1;
+}
+
+
+/*
+ * flickcurl_write_queue_send:
+ * @queue: write queue
+ * @entry: queued call
+ *
+ * INTERNAL - send one queued call
+ *
+ * Return value: non-0 on failure
+ */
+static int
+flickcurl_write_queue_send(flickcurl_write_queue* queue,
+                           flickcurl_write_queue_entry* entry)
+{
+  flickcurl* fc = queue->fc;
+  const char** parameters;
+  int i;
+  int rc = 1;
+
+  /* room for the parameters flickcurl_prepare() adds */
+  parameters = (const char**)calloc(2 * (entry->count + 6), sizeof(char*));
+  if(!parameters)
+    return 1;
+
+  for(i = 0; i < entry->count; i++) {
+    parameters[2 * i] = entry->parameters[i][0];
+    parameters[2 * i + 1] = entry->parameters[i][1];
+  }
+  parameters[2 * i] = NULL;
+
+  if(flickcurl_prepare(fc, entry->method,
+                       (const char* (*)[2])parameters, entry->count))
+    goto tidy;
+
+  flickcurl_set_write(fc, 1);
+  flickcurl_set_data(fc, (void*)"", 0);
+
+  if(flickcurl_invoke(fc))
+    rc = 0;
+
+  tidy:
+  flickcurl_timing_end_build(fc);
+  free(parameters);
+  if(fc->failed)
+    rc = 1;
+
+  return rc;
+}
+
+
+/**
+ * flickcurl_write_queue_drain:
+ * @queue: write queue
+ * @max_calls: maximum number of calls to send (or <=0 for no limit)
+ *
+ * Send queued calls that are due, oldest first
+ *
+ * Calls that fail with a temporary error are retried by later drains
+ * with exponential backoff, up to the maximum attempts.  Calls that
+ * fail permanently or run out of attempts are abandoned and counted
+ * by flickcurl_write_queue_get_failed_count().  Each call waits for
+ * the request delay of the flickcurl context so @max_calls bounds
+ * how long a drain takes.
+ *
+ * Return value: number of calls sent or <0 on failure
+ **/
+int
+flickcurl_write_queue_drain(flickcurl_write_queue* queue, int max_calls)
+{
+  flickcurl_write_queue_entry* entry;
+  flickcurl_write_queue_entry* prev = NULL;
+  struct timeval start;
+  struct timeval end;
+  time_t now = time(NULL);
+  int calls = 0;
+
+  if(!queue->journal)
+    return -1;
+
+  gettimeofday(&start, NULL);
+
+  entry = queue->head;
+  while(entry && (max_calls <= 0 || calls < max_calls)) {
+    flickcurl_write_queue_entry* next = entry->next;
+
+    if(entry->next_attempt > now) {
+      prev = entry;
+      entry = next;
+      continue;
+    }
+
+    calls++;
+    entry->attempts++;
+
+    if(flickcurl_write_queue_send(queue, entry)) {
+      if(flickcurl_write_queue_is_retryable(queue->fc) &&
+         entry->attempts < queue->max_attempts) {
+        int delay = WRITE_QUEUE_RETRY_MIN;
+        int i;
+        flickcurl_write_queue_entry* e;
+
+        for(i = 1; i < entry->attempts && delay < WRITE_QUEUE_RETRY_MAX; i++)
+          delay <<= 1;
+        if(delay > WRITE_QUEUE_RETRY_MAX)
+          delay = WRITE_QUEUE_RETRY_MAX;
+        entry->next_attempt = time(NULL) + delay;
+
+        /* keep later calls for the same key behind this one */
+        for(e = next; e && entry->count; e = e->next) {
+          if(e->count && !strcmp(e->method, entry->method) &&
+             !strcmp(e->parameters[0][1], entry->parameters[0][1]) &&
+             e->next_attempt < entry->next_attempt)
+            e->next_attempt = entry->next_attempt;
+        }
+
+        queue->retried_count++;
+        prev = entry;
+        entry = next;
+        continue;
+      }
+
+      queue->failed_count++;
+    } else
+      queue->completed_count++;
+
+    /* done with this call */
+    fprintf(queue->journal, "- %d\n", entry->seq);
+    if(flickcurl_write_queue_sync(queue))
+      return -1;
+
+    if(prev)
+      prev->next = next;
+    else
+      queue->head = next;
+    if(queue->tail == entry)
+      queue->tail = prev;
+    queue->depth--;
+    flickcurl_write_queue_free_entry(entry);
+
+    entry = next;
+  }
+
+  /* start a fresh journal once everything has been sent */
+  if(!queue->depth && calls && flickcurl_write_queue_compact(queue))
+    return -1;
+
+  gettimeofday(&end, NULL);
+  queue->drain_seconds += (double)(end.tv_sec - start.tv_sec) +
+    (double)(end.tv_usec - start.tv_usec) / 1000000.0;
+
+  return calls;
+}
+
+
+/**
+ * flickcurl_write_queue_get_depth:
+ * @queue: write queue
+ *
+ * Get the number of calls waiting to be sent
+ *
+ * Return value: queue depth
+ **/
+int
+flickcurl_write_queue_get_depth(flickcurl_write_queue* queue)
+{
+  return queue->depth;
+}
+
+
+/**
+ * flickcurl_write_queue_get_drain_rate:
+ * @queue: write queue
+ *
+ * Get the rate calls have completed while draining
+ *
+ * This is the number of calls completed divided by the time spent in
+ * flickcurl_write_queue_drain() since the queue was created.
+ *
+ * Return value: completed calls per second or 0.0 if none yet
+ **/
+double
+flickcurl_write_queue_get_drain_rate(flickcurl_write_queue* queue)
+{
+  if(queue->drain_seconds <= 0.0)
+    return 0.0;
+
+  return (double)queue->completed_count / queue->drain_seconds;
+}
+
+
+/**
+ * flickcurl_write_queue_get_failed_count:
+ * @queue: write queue
+ *
+ * Get the number of calls abandoned since the queue was created
+ *
+ * Return value: number of abandoned calls
+ **/
+int
+flickcurl_write_queue_get_failed_count(flickcurl_write_queue* queue)
+{
+  return queue->failed_count;
+}
+
+
+/**
+ * flickcurl_write_queue_get_retried_count:
+ * @queue: write queue
+ *
+ * Get the number of temporary failures that were scheduled for retry
+ * since the queue was created
+ *
+ * Return value: number of retries
+ **/
+int
+flickcurl_write_queue_get_retried_count(flickcurl_write_queue* queue)
+{
+  return queue->retried_count;
+}
+
+
+/**
+ * flickcurl_write_queue_photos_setMeta:
+ * @queue: write queue
+ * @photo_id: The id of the photo to set information for.
+ * @title: The title for the photo.
+ * @description: The description for the photo.
+ *
+ * Queue flickcurl_photos_setMeta()
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_write_queue_photos_setMeta(flickcurl_write_queue* queue,
+                                     const char* photo_id,
+                                     const char* title,
+                                     const char* description)
+{
+  const char* parameters[3][2];
+  int count = 0;
+
+  if(!photo_id || !title || !description)
+    return 1;
+
+  parameters[count][0]  = "photo_id";
+  parameters[count++][1]= photo_id;
+  parameters[count][0]  = "title";
+  parameters[count++][1]= title;
+  parameters[count][0]  = "description";
+  parameters[count++][1]= description;
+
+  return flickcurl_write_queue_add(queue, "flickr.photos.setMeta",
+                                   parameters, count);
+}
+
+
+/**
+ * flickcurl_write_queue_photos_setPerms:
+ * @queue: write queue
+ * @photo_id: The id of the photo to set permissions for.
+ * @perms: The #flickcurl_perms photo permissions
+ *
+ * Queue flickcurl_photos_setPerms()
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_write_queue_photos_setPerms(flickcurl_write_queue* queue,
+                                      const char* photo_id,
+                                      flickcurl_perms* perms)
+{
+  const char* parameters[6][2];
+  int count = 0;
+  char is_public_str[2];
+  char is_friend_str[2];
+  char is_family_str[2];
+  char perm_comment_str[2];
+  char perm_addmeta_str[2];
+
+  if(!photo_id || !perms)
+    return 1;
+
+  if(perms->perm_comment <0 || perms->perm_comment >3)
+    return 1;
+
+  if(perms->perm_addmeta <0 || perms->perm_addmeta >3)
+    return 1;
+
+  parameters[count][0]  = "photo_id";
+  parameters[count++][1]= photo_id;
+  parameters[count][0]  = "is_public";
+  sprintf(is_public_str, "%d", (perms->is_public ? 1 : 0));
+  parameters[count++][1]= is_public_str;
+  parameters[count][0]  = "is_friend";
+  sprintf(is_friend_str, "%d", (perms->is_friend ? 1 : 0));
+  parameters[count++][1]= is_friend_str;
+  parameters[count][0]  = "is_family";
+  sprintf(is_family_str, "%d", (perms->is_family ? 1 : 0));
+  parameters[count++][1]= is_family_str;
+  parameters[count][0]  = "perm_comment";
+  sprintf(perm_comment_str, "%d", perms->perm_comment);
+  parameters[count++][1]= perm_comment_str;
+  parameters[count][0]  = "perm_addmeta";
+  sprintf(perm_addmeta_str, "%d", perms->perm_addmeta);
+  parameters[count++][1]= perm_addmeta_str;
+
+  return flickcurl_write_queue_add(queue, "flickr.photos.setPerms",
+                                   parameters, count);
+}
+
+
+/**
+ * flickcurl_write_queue_photos_geo_setLocation:
+ * @queue: write queue
+ * @photo_id: The id of the photo to set location data for.
+ * @location: The location
+ *
+ * Queue flickcurl_photos_geo_setLocation()
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_write_queue_photos_geo_setLocation(flickcurl_write_queue* queue,
+                                             const char* photo_id,
+                                             flickcurl_location* location)
+{
+  const char* parameters[4][2];
+  int count = 0;
+  char latitude_s[50];
+  char longitude_s[50];
+  char accuracy_s[50];
+  double latitude;
+  double longitude;
+
+  if(!photo_id || !location)
+    return 1;
+
+  latitude = location->latitude;
+  if(latitude < -90.0)
+    latitude= -90.0;
+  if(latitude > 90.0)
+    latitude= 90.0;
+  longitude = location->longitude;
+  if(longitude < -180.0)
+    longitude= -180.0;
+  if(longitude > 180.0)
+    longitude= 180.0;
+
+  parameters[count][0]  = "photo_id";
+  parameters[count++][1]= photo_id;
+  parameters[count][0]  = "lat";
+  sprintf(latitude_s, "%f", latitude);
+  parameters[count++][1]= latitude_s;
+  parameters[count][0]  = "lon";
+  sprintf(longitude_s, "%f", longitude);
+  parameters[count++][1]= longitude_s;
+  if(location->accuracy >= 1 && location->accuracy <= 16) {
+    parameters[count][0]  = "accuracy";
+    sprintf(accuracy_s, "%d", location->accuracy);
+    parameters[count++][1]= accuracy_s;
+  }
+
+  return flickcurl_write_queue_add(queue, "flickr.photos.geo.setLocation",
+                                   parameters, count);
+}
+
+
+/**
+ * flickcurl_write_queue_photos_setTags:
+ * @queue: write queue
+ * @photo_id: The id of the photo to set tags for.
+ * @tags: All tags for the photo (as a single space-delimited string).
+ *
+ * Queue flickcurl_photos_setTags()
+ *
+ * Return value: non-0 on failure
+ **/
+int
+flickcurl_write_queue_photos_setTags(flickcurl_write_queue* queue,
+                                     const char* photo_id, const char* tags)
+{
+  const char* parameters[2][2];
+  int count = 0;
+
+  if(!photo_id || !tags)
+    return 1;
+
+  parameters[count][0]  = "photo_id";
+  parameters[count++][1]= photo_id;
+  parameters[count][0]  = "tags";
+  parameters[count++][1]= tags;
+
+  return flickcurl_write_queue_add(queue, "flickr.photos.setTags",
+                                   parameters, count);
+}
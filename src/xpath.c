@@ -0,0 +1,197 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * xpath.c - Flickcurl precompiled XPath expressions
+ *
+ * Copyright (C) 2010, David Beckett http://www.dajobe.org/
+ *
+ * This file is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef WIN32
+#include <win32_flickcurl_config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#undef HAVE_STDLIB_H
+#endif
+
+#include <flickcurl.h>
+#include <flickcurl_internal.h>
+
+
+/*
+ * The field tables of the object builders are compiled once by
+ * flickcurl_init() into a registry keyed by the address of the static
+ * expression string.  The registry is only written during
+ * initialisation so it can be read by any number of threads, each
+ * evaluating with its own XPath context.  Expressions that were not
+ * registered, such as those built at run time, are compiled on every
+ * call as before.
+ */
+
+/* Size of the registry hash; must be a power of 2 and more than twice
+ * the number of table expressions
+ */
+#define XPATH_REGISTRY_SIZE 1024
+
+typedef struct {
+  const xmlChar* expr;
+  xmlXPathCompExprPtr comp;
+} flickcurl_xpath_entry;
+
+static flickcurl_xpath_entry* xpath_registry = NULL;
+static int xpath_registry_count = 0;
+
+
+static unsigned int
+flickcurl_xpath_hash(const xmlChar* expr)
+{
+  unsigned long h = (unsigned long)expr;
+
+  h ^= h >> 16;
+  h *= 0x45d9f3bUL;
+  h ^= h >> 16;
+
+  return (unsigned int)(h & (XPATH_REGISTRY_SIZE - 1));
+}
+
+
+/*
+ * flickcurl_xpath_register:
+ * @xpathExpr: static XPath expression string
+ *
+ * INTERNAL - compile an XPath expression into the registry
+ *
+ * Registering the same string twice is allowed.
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_xpath_register(const xmlChar* xpathExpr)
+{
+  unsigned int i;
+
+  if(!xpath_registry)
+    return 1;
+
+  i = flickcurl_xpath_hash(xpathExpr);
+  while(xpath_registry[i].expr) {
+    if(xpath_registry[i].expr == xpathExpr)
+      return 0;
+    i = (i + 1) & (XPATH_REGISTRY_SIZE - 1);
+  }
+
+  if((xpath_registry_count + 1) * 2 > XPATH_REGISTRY_SIZE)
+    return 1;
+
+  xpath_registry[i].comp = xmlXPathCompile(xpathExpr);
+  if(!xpath_registry[i].comp)
+    return 1;
+  xpath_registry[i].expr = xpathExpr;
+  xpath_registry_count++;
+
+  return 0;
+}
+
+
+/*
+ * flickcurl_xpath_init:
+ *
+ * INTERNAL - compile the XPath expressions of all the builder tables
+ *
+ * Return value: non-0 on failure
+ */
+int
+flickcurl_xpath_init(void)
+{
+  int rc = 0;
+
+  if(xpath_registry)
+    return 0;
+
+  xpath_registry = (flickcurl_xpath_entry*)calloc(XPATH_REGISTRY_SIZE,
+                                                  sizeof(flickcurl_xpath_entry));
+  if(!xpath_registry)
+    return 1;
+
+  rc += flickcurl_collection_register_xpaths();
+  rc += flickcurl_institution_register_xpaths();
+  rc += flickcurl_method_register_xpaths();
+  rc += flickcurl_person_register_xpaths();
+  rc += flickcurl_photo_register_xpaths();
+  rc += flickcurl_place_register_xpaths();
+  rc += flickcurl_shape_register_xpaths();
+
+  return rc;
+}
+
+
+/*
+ * flickcurl_xpath_terminate:
+ *
+ * INTERNAL - free the compiled XPath expressions
+ */
+void
+flickcurl_xpath_terminate(void)
+{
+  int i;
+
+  if(!xpath_registry)
+    return;
+
+  for(i = 0; i < XPATH_REGISTRY_SIZE; i++) {
+    if(xpath_registry[i].comp)
+      xmlXPathFreeCompExpr(xpath_registry[i].comp);
+  }
+
+  free(xpath_registry);
+  xpath_registry = NULL;
+  xpath_registry_count = 0;
+}
+
+
+/*
+ * flickcurl_xpath_evaluate:
+ * @xpathCtx: XPath context
+ * @xpathExpr: XPath expression
+ *
+ * INTERNAL - evaluate an XPath expression using the compiled form if registered
+ *
+ * Return value: XPath object result or NULL on failure
+ */
+xmlXPathObjectPtr
+flickcurl_xpath_evaluate(xmlXPathContextPtr xpathCtx,
+                         const xmlChar* xpathExpr)
+{
+  if(xpath_registry) {
+    unsigned int i = flickcurl_xpath_hash(xpathExpr);
+
+    while(xpath_registry[i].expr) {
+      if(xpath_registry[i].expr == xpathExpr)
+        return xmlXPathCompiledEval(xpath_registry[i].comp, xpathCtx);
+      i = (i + 1) & (XPATH_REGISTRY_SIZE - 1);
+    }
+  }
+
+  return xmlXPathEvalExpression(xpathExpr, xpathCtx);
+}
@@ -47,6 +47,7 @@
 #endif
 
 #include <flickcurl.h>
+#include <libxml/parser.h>
 
 
 
@@ -127,6 +128,279 @@ static const char* config_filename = ".flickcurl.conf";
 static const char* config_section = "flickr";
 
 
+static int
+compare_arg_names(const void *a, const void *b)
+{
+  return strcmp((*(flickcurl_arg**)a)->name, (*(flickcurl_arg**)b)->name);
+}
+
+
+/* Most element or attribute names handled in one response element */
+#define MAX_EXAMPLE_NAMES 64
+
+/* Deepest response element a decoder is generated for below <rsp> */
+#define MAX_EXAMPLE_DEPTH 3
+
+
+/*
+ * Parse the response example of a method.  The example is wrapped in
+ * <rsp> as in a real response since some have several top level
+ * elements and many are not well formed.
+ */
+static xmlDocPtr
+codegen_parse_response(const char* response)
+{
+  size_t len;
+  char* buffer;
+  xmlDocPtr doc;
+
+  if(!response || !*response)
+    return NULL;
+
+  len = strlen(response);
+  buffer = (char*)malloc(len + 12);
+  if(!buffer)
+    return NULL;
+  strcpy(buffer, "<rsp>");
+  strcpy(buffer + 5, response);
+  strcpy(buffer + 5 + len, "</rsp>");
+
+  doc = xmlReadMemory(buffer, (int)(len + 11), NULL, NULL,
+                      XML_PARSE_RECOVER | XML_PARSE_NOERROR |
+                      XML_PARSE_NOWARNING | XML_PARSE_NONET);
+  free(buffer);
+
+  if(doc && (!xmlDocGetRootElement(doc) ||
+             !xmlDocGetRootElement(doc)->children)) {
+    xmlFreeDoc(doc);
+    doc = NULL;
+  }
+
+  return doc;
+}
+
+
+/* add @name to the @names_count names in @names if not already there */
+static int
+codegen_add_name(const xmlChar** names, int names_count, const xmlChar* name)
+{
+  int i;
+
+  for(i = 0; i < names_count; i++) {
+    if(!strcmp((const char*)names[i], (const char*)name))
+      return names_count;
+  }
+  if(names_count < MAX_EXAMPLE_NAMES)
+    names[names_count++] = name;
+
+  return names_count;
+}
+
+
+/* find how deep the example goes and whether it has any attributes */
+static void
+codegen_example_info(xmlNodePtr node, int depth, int* max_depth_p,
+                     int* has_attributes_p)
+{
+  if(depth > *max_depth_p)
+    *max_depth_p = depth;
+  if(node->properties)
+    *has_attributes_p = 1;
+
+  if(depth == MAX_EXAMPLE_DEPTH)
+    return;
+
+  for(node = node->children; node; node = node->next) {
+    if(node->type == XML_ELEMENT_NODE)
+      codegen_example_info(node, depth + 1, max_depth_p, has_attributes_p);
+  }
+}
+
+
+/*
+ * Write the decoder code for the response elements named like @example
+ * found at node@depth; @example and its siblings of the same name give
+ * the attributes and child elements to test for.
+ *
+ * Return value: non-0 if any code was written
+ */
+static int
+codegen_decode_element(xmlNodePtr example, int depth, int indent)
+{
+  const xmlChar* names[MAX_EXAMPLE_NAMES];
+  int names_count = 0;
+  int has_text = 0;
+  int written = 0;
+  xmlNodePtr sibling;
+  int i;
+
+  /* attributes */
+  for(sibling = example; sibling; sibling = sibling->next) {
+    xmlAttr* attr;
+
+    if(sibling->type != XML_ELEMENT_NODE ||
+       strcmp((const char*)sibling->name, (const char*)example->name))
+      continue;
+    for(attr = sibling->properties; attr; attr = attr->next)
+      names_count = codegen_add_name(names, names_count, attr->name);
+  }
+
+  if(names_count) {
+    fprintf(stdout,
+"%*sfor(attr = node%d->properties; attr; attr = attr->next) {\n"
+"%*s  const char* attr_name = (const char*)attr->name;\n"
+"%*s  const char* attr_value = attr->children ?\n"
+"%*s    (const char*)attr->children->content : \"\";\n"
+"\n",
+            indent, "", depth, indent, "", indent, "", indent, "");
+    for(i = 0; i < names_count; i++)
+      fprintf(stdout,
+"%*s  %sif(!strcmp(attr_name, \"%s\")) {\n"
+"%*s    /* your code here */\n",
+              indent, "", (i ? "} else " : ""), (const char*)names[i],
+              indent, "");
+    fprintf(stdout,
+"%*s  }\n"
+"%*s}\n",
+            indent, "", indent, "");
+    written = 1;
+  }
+
+  /* text content */
+  for(sibling = example; sibling && !has_text; sibling = sibling->next) {
+    xmlNodePtr child;
+
+    if(sibling->type != XML_ELEMENT_NODE ||
+       strcmp((const char*)sibling->name, (const char*)example->name))
+      continue;
+    for(child = sibling->children; child; child = child->next) {
+      if(child->type == XML_TEXT_NODE && !xmlIsBlankNode(child))
+        has_text = 1;
+    }
+  }
+
+  if(has_text) {
+    fprintf(stdout,
+"%*sif(node%d->children && node%d->children->type == XML_TEXT_NODE) {\n"
+"%*s  /* your code here with node%d->children->content */\n"
+"%*s}\n",
+            indent, "", depth, depth, indent, "", depth, indent, "");
+    written = 1;
+  }
+
+  if(depth == MAX_EXAMPLE_DEPTH)
+    return written;
+
+  /* child elements */
+  names_count = 0;
+  for(sibling = example; sibling; sibling = sibling->next) {
+    xmlNodePtr child;
+
+    if(sibling->type != XML_ELEMENT_NODE ||
+       strcmp((const char*)sibling->name, (const char*)example->name))
+      continue;
+    for(child = sibling->children; child; child = child->next) {
+      if(child->type == XML_ELEMENT_NODE)
+        names_count = codegen_add_name(names, names_count, child->name);
+    }
+  }
+
+  if(!names_count)
+    return written;
+
+  fprintf(stdout,
+"%*sfor(node%d = node%d->children; node%d; node%d = node%d->next) {\n"
+"%*s  if(node%d->type != XML_ELEMENT_NODE)\n"
+"%*s    continue;\n"
+"\n",
+          indent, "", depth + 1, depth, depth + 1, depth + 1, depth + 1,
+          indent, "", depth + 1, indent, "");
+
+  for(i = 0; i < names_count; i++) {
+    xmlNodePtr child = NULL;
+
+    /* first example element with this name */
+    for(sibling = example; sibling && !child; sibling = sibling->next) {
+      if(sibling->type != XML_ELEMENT_NODE ||
+         strcmp((const char*)sibling->name, (const char*)example->name))
+        continue;
+      for(child = sibling->children; child; child = child->next) {
+        if(child->type == XML_ELEMENT_NODE &&
+           !strcmp((const char*)child->name, (const char*)names[i]))
+          break;
+      }
+    }
+
+    fprintf(stdout,
+"%*s  %sif(!strcmp((const char*)node%d->name, \"%s\")) {\n",
+            indent, "", (i ? "} else " : ""), depth + 1, (const char*)names[i]);
+    if(!codegen_decode_element(child, depth + 1, indent + 4))
+      fprintf(stdout, "%*s    /* your code here */\n", indent, "");
+  }
+  fprintf(stdout,
+"%*s  }\n"
+"%*s}\n",
+          indent, "", indent, "");
+
+  return 1;
+}
+
+
+/*
+ * Write a decoder for the response of a method that walks the DOM
+ * directly to the elements and attributes of the response example
+ * rather than evaluating XPaths on them.
+ */
+static void
+codegen_decoder(const char* function_name, flickcurl_method* method,
+                xmlDocPtr example_doc)
+{
+  xmlNodePtr root = xmlDocGetRootElement(example_doc);
+  int max_depth = 0;
+  int has_attributes = 0;
+  int i;
+
+  codegen_example_info(root, 0, &max_depth, &has_attributes);
+
+  fprintf(stdout,
+"/*\n"
+" * %s_decode:\n"
+" * @fc: flickcurl context\n"
+" * @doc: %s response document\n"
+" *\n"
+" * INTERNAL - decode a %s response\n"
+" *\n"
+" * Return value: result or NULL on failure\n"
+" */\n"
+"static void*\n"
+"%s_decode(flickcurl* fc, xmlDocPtr doc)\n"
+"{\n",
+          function_name, method->name, method->name, function_name);
+  for(i = 0; i <= max_depth; i++)
+    fprintf(stdout, "  xmlNodePtr node%d;\n", i);
+  if(has_attributes)
+    fputs("  xmlAttr* attr;\n", stdout);
+  fputs(
+"  void* result = NULL;\n"
+"\n"
+"  node0 = xmlDocGetRootElement(doc);\n"
+"  if(!node0)\n"
+"    return NULL;\n"
+"\n",
+        stdout);
+
+  codegen_decode_element(root, 0, 2);
+
+  fputs(
+"\n"
+"  return result;\n"
+"}\n"
+"\n"
+"\n",
+        stdout);
+}
+
+
 int
 main(int argc, char *argv[]) 
 {
@@ -336,6 +610,9 @@ main(int argc, char *argv[])
     char function_name[100];
     int c, j;
     int is_write = 0;
+    flickcurl_arg** sorted_args = NULL;
+    int sorted_args_count = 0;
+    xmlDocPtr example_doc;
     
     if(strncmp(methods[i], section, section_len))
       continue;
@@ -367,6 +644,10 @@ main(int argc, char *argv[])
     }
     function_name[j+10] = '\0';
 
+    example_doc = codegen_parse_response(method->response);
+    if(example_doc)
+      codegen_decoder(function_name, method, example_doc);
+
     fprintf(stdout, "/**\n * %s:\n", function_name);
 
     /* fixed arguments */
@@ -422,10 +703,15 @@ main(int argc, char *argv[])
     fprintf(stdout,
 "  const char* parameters[%d][2];\n"
 "  int count = 0;\n"
-"  xmlDocPtr doc = NULL;\n"
-"  xmlXPathContextPtr xpathCtx = NULL; \n"
-"  void* result = NULL;\n",
+"  xmlDocPtr doc = NULL;\n",
   6+method->args_count);
+    if(!example_doc)
+      fputs(
+"  xmlXPathContextPtr xpathCtx = NULL; \n",
+            stdout);
+    fputs(
+"  void* result = NULL;\n",
+          stdout);
     if(method->args_count) {
       int argi;
       for(argi = 0; method->args[argi]; argi++) {
@@ -468,10 +754,29 @@ main(int argc, char *argv[])
     }
 
 
+    /* Add the parameters in name order so that signing the request
+     * only has to merge in the ones added by flickcurl_prepare()
+     */
     if(method->args_count) {
+      sorted_args = (flickcurl_arg**)malloc((method->args_count + 1) *
+                                            sizeof(flickcurl_arg*));
+      if(!sorted_args) {
+        if(example_doc)
+          xmlFreeDoc(example_doc);
+        flickcurl_free_method(method);
+        rc = 1;
+        break;
+      }
+      for(j = 0; j < method->args_count && method->args[j]; j++)
+        sorted_args[sorted_args_count++] = method->args[j];
+      qsort(sorted_args, sorted_args_count, sizeof(flickcurl_arg*),
+            compare_arg_names);
+    }
+
+    if(sorted_args_count) {
       int argi;
-      for(argi = 0; method->args[argi]; argi++) {
-        flickcurl_arg* arg = method->args[argi];
+      for(argi = 0; argi < sorted_args_count; argi++) {
+        flickcurl_arg* arg = sorted_args[argi];
         if(!strcmp(arg->name, "api_key"))
           continue;
         
@@ -524,7 +829,27 @@ main(int argc, char *argv[])
 "\n"
 );
 
-    fprintf(stdout,
+    if(example_doc)
+      fprintf(stdout,
+"  doc = flickcurl_invoke(fc);\n"
+"  if(!doc)\n"
+"    goto tidy;\n"
+"\n"
+"  result = %s_decode(fc, doc);\n"
+"\n"
+"  tidy:\n"
+"  flickcurl_timing_end_build(fc);\n"
+"\n"
+"  if(fc->failed)\n"
+"    result = NULL;\n"
+"\n"
+"  return (result == NULL);\n"
+"}\n"
+"\n"
+"\n",
+              function_name);
+    else
+      fprintf(stdout,
 "  doc = flickcurl_invoke(fc);\n"
 "  if(!doc)\n"
 "    goto tidy;\n"
@@ -543,6 +868,8 @@ main(int argc, char *argv[])
 "  if(xpathCtx)\n"
 "    xmlXPathFreeContext(xpathCtx);\n"
 "\n"
+"  flickcurl_timing_end_build(fc);\n"
+"\n"
 "  if(fc->failed)\n"
 "    result = NULL;\n"
 "\n"
@@ -551,6 +878,10 @@ main(int argc, char *argv[])
 "\n"
 "\n");
 
+    if(sorted_args)
+      free(sorted_args);
+    if(example_doc)
+      xmlFreeDoc(example_doc);
     flickcurl_free_method(method);
   }
 